@@ -10,6 +10,10 @@
 #include <QTextStream>
 #include <QDebug>
 #include <QStringList>
+#include <QHash>
+
+#include <sys/types.h>
+#include <pwd.h>
 
 #include "pcdm-backend.h"
 #include "pcdm-config.h"
@@ -19,6 +23,9 @@ QStringList displaynameList,usernameList,homedirList,usershellList,instXNameList
 QString logFile;
 QString saveX,saveUsername, lastUser, lastDE;
 bool Over1K = true;
+bool usersLoaded = false; //local users read into the lists (directory users are added later)
+QHash<QString,int> usernameIndex, displaynameIndex; //name -> position in the user lists
+QHash<QString,bool> shellExists; //cached QFile::exists() results for login shells
 
 QStringList Backend::getAvailableDesktops(){  
   if(instXNameList.isEmpty()){ loadXSessionsData(); }
@@ -56,17 +63,19 @@ QString Backend::getDesktopBinary(QString xName){
 }
 
 void Backend::allowUidUnder1K(bool allow, QStringList excludes){
+  if(usersLoaded && Over1K == !allow && excludedUsers == excludes){ return; } //nothing changed
   Over1K = !allow;
   excludedUsers = excludes;
-  //Make sure to re-load the user list if necessary
+  //The filters changed - re-load the user list with the new ones
+  usernameList.clear(); displaynameList.clear(); homedirList.clear(); usershellList.clear();
+  usernameIndex.clear(); displaynameIndex.clear();
+  usersLoaded = false;
   readSystemUsers();
 }
 
 
 QStringList Backend::getSystemUsers(bool realnames){
-  if(usernameList.isEmpty()){
-    readSystemUsers();
-  }
+  readSystemUsers();
   if(realnames){
     return displaynameList;
   }else{
@@ -78,17 +87,13 @@ QString Backend::getALUsername(){
   //Make sure the requested user is valid
   readSystemUsers(); //first read the available users on this system
   QString ruser = Config::autoLoginUsername();
-  int index = usernameList.indexOf(ruser);
-  if(index == -1){ //invalid username
-    //Check if a display name was given instead
-    index = displaynameList.indexOf(ruser);
-    if(index == -1){ //invalid display name
-      log("Invalid Auto-Login user requested - skipping....");
-      ruser.clear();
-    }else{
-      //use the valid username for the given display name
-      ruser = usernameList[index]; 
-    }
+  int index = findUser(ruser); //also checks display names
+  if(index == -1){ //invalid username/display name
+    log("Invalid Auto-Login user requested - skipping....");
+    ruser.clear();
+  }else{
+    //use the valid username for the given display name
+    ruser = usernameList[index]; 
   }
   return ruser;
 }
@@ -100,17 +105,14 @@ QString Backend::getALPassword(){
 
 QString Backend::getUsernameFromDisplayname(QString dspname){
   if(dspname.isEmpty()){return "";}
-  int i = displaynameList.indexOf(dspname);
-  if(i == -1){ i = usernameList.indexOf(dspname); }
-  
+  int i = findUser(dspname);
   if(i == -1){ return ""; }
   else{ return usernameList[i]; }
 }
 
 QString Backend::getDisplayNameFromUsername(QString username){
   if(username.isEmpty()){return "";}
-  int i = usernameList.indexOf(username);
-  if(i==-1){ i = displaynameList.indexOf(username); } //make sure it was not a display name passed in
+  int i = findUser(username);
   if(i==-1){ return ""; }
   else{
     return displaynameList[i];  
@@ -119,16 +121,14 @@ QString Backend::getDisplayNameFromUsername(QString username){
 
 QString Backend::getUserHomeDir(QString username){
   if(username.isEmpty()){ return ""; }
-  int i = usernameList.indexOf(username);
-  if( i == -1 ){ i = displaynameList.indexOf(username); }
+  int i = findUser(username);
   if( i < 0){ return ""; }
   return homedirList[i];
 }
 
 QString Backend::getUserShell(QString username){
   if(username.isEmpty()){ return ""; }
-  int i = usernameList.indexOf(username);
-  if( i == -1 ){ i = displaynameList.indexOf(username); }
+  int i = findUser(username);
   if( i < 0){ return ""; }
   return usershellList[i];	
 }
@@ -305,6 +305,7 @@ QString Backend::getLastDE(QString user){
 void Backend::saveLoginInfo(QString user, QString desktop){
   writeSystemLastLogin(user,desktop); //save the system file (DBDIR/lastlogin)
   writeUserLastDesktop(user,desktop); //save the user file (~/.lastlogin)
+  writeRecentUser(user); //save the system file (DBDIR/recentusers)
 }
 
 void Backend::readDefaultSysEnvironment(QString &lang, QString &keymodel, QString &keylayout, QString &keyvariant){
@@ -541,60 +542,58 @@ QStringList Backend::readXSessionsFile(QString filePath, QString locale){
 
 }
 
-void Backend::readSystemUsers(bool directfile){
-  //make sure the lists are empty
-  usernameList.clear(); displaynameList.clear(); homedirList.clear();
-  QStringList uList;	
-    if(directfile){
-      //This is a general fallback for reading the file directly in case something goes wrong with the getent case below
-      QFile file("/etc/passwd");
-      if(file.open(QIODevice::ReadOnly | QIODevice::Text)){
-        QTextStream in(&file);
-        while (!in.atEnd()){ uList << in.readLine().simplified(); }
-        file.close();
-      }
-    }else{
-      //Use "getent" to get all possible users (detects LDAP/AD users - preferred)
-      QProcess p;
-      p.setProcessChannelMode(QProcess::MergedChannels);
-        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-        //Make sure to set all the possible UTF-8 flags before reading users
-        env.insert("LANG", "en_US.UTF-8");
-        env.insert("LC_ALL", "en_US.UTF-8");
-        env.insert("MM_CHARSET","UTF-8");
-      p.setProcessEnvironment(env);
-      p.start("getent passwd");
-      while(p.state()==QProcess::Starting || p.state() == QProcess::Running){
-        p.waitForFinished(200);
-        QCoreApplication::processEvents();
-      }
-      uList = QString::fromUtf8( p.readAllStandardOutput() ).split("\n");
-    }
-    
-    //Remove all users that have:
-   QStringList filter; filter << "server" << "daemon" << "database" << "system"<< "account"<<"pseudo";
+void Backend::readSystemUsers(){
+  //Only read once - the lists might already contain directory users from the UserLoader
+  if(usersLoaded){ return; }
+  usersLoaded = true;
+  //Only the local database is read here (always quick), directory (LDAP/AD) users
+  //  are streamed in afterwards by the UserLoader running "getent passwd"
+  QFile file("/etc/passwd");
+  if(file.open(QIODevice::ReadOnly | QIODevice::Text)){
+    QTextStream in(&file);
+    while (!in.atEnd()){ addSystemUser( in.readLine().simplified() ); }
+    file.close();
+  }
+  //Now make sure any recently used (possibly directory) accounts are listed right away
+  QStringList recent = readRecentUsers();
+  for(int i=0; i<recent.length(); i++){
+    if(!usernameIndex.contains(recent[i])){ lookupSystemUser(recent[i]); }
+  }
+}
+
+bool Backend::addSystemUser(QString entry){
+   //Remove all users that have:
+   static QStringList filter = QStringList() << "server" << "daemon" << "database" << "system"<< "account"<<"pseudo";
    //List any shells which are still valid - if not installed fall back on csh
-   QStringList validShells; validShells << "/usr/local/bin/zsh" << "/usr/local/bin/fish" << "/usr/local/bin/bash";
-   for(int i=0; i<uList.length(); i++){
+   static QStringList validShells = QStringList() << "/usr/local/bin/zsh" << "/usr/local/bin/fish" << "/usr/local/bin/bash";
+    QString username = entry.section(":",0,0).simplified();
+    if(username.isEmpty() || usernameIndex.contains(username)){ return false; } //already listed
     bool bad = false;
     bool fixshell = false;
-    QString dispcheck = uList[i].section(":",4,4).toLower();
-    QString shell = uList[i].section(":",6,6);
+    QString dispcheck = entry.section(":",4,4).toLower();
+    QString shell = entry.section(":",6,6);
+    QString home = entry.section(":",5,5);
+    int uid = entry.section(":",2,2).toInt();
+    bool shellOK = false;
+    if(!shell.isEmpty()){
+      if(!shellExists.contains(shell)){ shellExists.insert(shell, QFile::exists(shell)); }
+      shellOK = shellExists.value(shell);
+    }
     //First see if the listed shell is broken, but valid
-    if(!QFile::exists(shell) && validShells.contains(shell)){ fixshell = true; }
+    if(!shellOK && validShells.contains(shell)){ fixshell = true; }
     // Shell Checks
     if(shell.contains("nologin") || shell.isEmpty() ){bad=true;}
-    else if( !QFile::exists(shell) && !fixshell ){ bad = true; }
+    else if( !shellOK && !fixshell ){ bad = true; }
     // User Home Dir
-    else if(uList[i].section(":",5,5).contains("nonexistent") || uList[i].section(":",5,5).contains("/empty") || uList[i].section(":",5,5).isEmpty() ){bad=true;}
+    else if(home.contains("nonexistent") || home.contains("/empty") || home.isEmpty() ){bad=true;}
     // uid > 0
-    else if(uList[i].section(":",2,2).toInt() < 1){bad=true;} //don't show the root user
+    else if(uid < 1){bad=true;} //don't show the root user
     //Check that the name/description does not contain "server"
-    else if(uList[i].section(":",2,2).toInt() < 1000){
+    else if(uid < 1000){
 	if(Over1K){ bad = true;} //ignore anything under UID 1000
 	else{
 	  //Apply the special <1000 filters
-	  if(excludedUsers.contains(uList[i].section(":",0,0))){ bad = true; }
+	  if(excludedUsers.contains(username)){ bad = true; }
 	  for(int f=0;f<filter.length() && !bad; f++){
 	    if(dispcheck.contains(filter[f])){ bad = true; }
           }
@@ -602,20 +601,59 @@ void Backend::readSystemUsers(bool directfile){
     }
     
     //See if it failed any checks
-    if(bad){ uList.removeAt(i); i--; }
-    else{
-      //Add this user to the lists if it is good
-      usernameList << uList[i].section(":",0,0).simplified();
-      displaynameList << uList[i].section(":",4,4).simplified();
-      homedirList << uList[i].section(":",5,5).simplified();
-      if(fixshell){ usershellList << "/bin/csh"; }
-      else{ usershellList << uList[i].section(":",6,6).simplified(); }
+    if(bad){ return false; }
+    //Add this user to the lists if it is good
+    QString dispname = entry.section(":",4,4).simplified();
+    usernameIndex.insert(username, usernameList.length());
+    if(!displaynameIndex.contains(dispname)){ displaynameIndex.insert(dispname, displaynameList.length()); }
+    usernameList << username;
+    displaynameList << dispname;
+    homedirList << home.simplified();
+    if(fixshell){ usershellList << "/bin/csh"; }
+    else{ usershellList << shell.simplified(); }
+    return true;
+}
+
+int Backend::findUser(QString name){
+  if(name.isEmpty()){ return -1; }
+  if(usernameIndex.contains(name)){ return usernameIndex.value(name); }
+  if(displaynameIndex.contains(name)){ return displaynameIndex.value(name); }
+  //Not listed (yet) - could be a directory user which is not loaded or over the listing limit
+  if(lookupSystemUser(name)){ return usernameIndex.value(name); }
+  return -1;
+}
+
+bool Backend::lookupSystemUser(QString username){
+  //Single-account lookup through the system (nsswitch) database
+  struct passwd *pw = getpwnam(username.toUtf8().constData());
+  if(pw == NULL){ return false; }
+  QStringList entry;
+  entry << QString::fromUtf8(pw->pw_name) << "*" << QString::number(pw->pw_uid) << QString::number(pw->pw_gid) \
+	<< QString::fromUtf8(pw->pw_gecos) << QString::fromUtf8(pw->pw_dir) << QString::fromUtf8(pw->pw_shell);
+  return addSystemUser( entry.join(":") );
+}
+
+QStringList Backend::readRecentUsers(){
+  QStringList users;
+  QFile file(DBDIR+"recentusers");
+  if(file.open(QIODevice::ReadOnly | QIODevice::Text)){
+    QTextStream in(&file);
+    while(!in.atEnd()){
+      QString user = in.readLine().simplified();
+      if(!user.isEmpty()){ users << user; }
     }
-   } //end loop over uList
-  if(usernameList.isEmpty() && !directfile){
-    //We need to find a valid user somewhere - try to directly read the file instead
-    qWarning() << "No users found with \"getent passwd\", reading the database directly...";
-    readSystemUsers(true);
+    file.close();
+  }
+  return users;
+}
+
+void Backend::writeRecentUser(QString user){
+  QStringList users = readRecentUsers();
+  users.removeAll(user);
+  users.prepend(user); //most recent first
+  while(users.length() > MAXRECENTUSERS){ users.removeLast(); }
+  if( !writeFile(DBDIR+"recentusers", users) ){
+    Backend::log("PCDM: Unable to save recent user list to system directory");
   }
 }
 
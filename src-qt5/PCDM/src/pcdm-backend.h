@@ -21,6 +21,7 @@
 
 #define PCSYSINSTALL    QString("/usr/sbin/pc-sysinstall")
 #define DBDIR QString("/var/db/pcdm/")
+#define MAXRECENTUSERS 10
 
 class Process : public QProcess {
 public:
@@ -39,6 +40,7 @@ public:
     static QString getDesktopBinary(QString);
     static void allowUidUnder1K(bool allow, QStringList excludes = QStringList() );
     static QStringList getSystemUsers(bool realnames = true);
+    static bool addSystemUser(QString entry); //passwd(5) line, returns true if it was a new valid user
     static QString getUsernameFromDisplayname(QString);
     static QString getDisplayNameFromUsername(QString);
     static QStringList keyModels();
@@ -75,7 +77,11 @@ public:
 private:	
     static void loadXSessionsData();
     static QStringList readXSessionsFile(QString, QString);
-    static void readSystemUsers(bool directfile = false);
+    static void readSystemUsers();
+    static int findUser(QString name);
+    static bool lookupSystemUser(QString username);
+    static QStringList readRecentUsers();
+    static void writeRecentUser(QString user);
     static void readSystemLastLogin();
     static void writeSystemLastLogin(QString, QString);
     static QString readUserLastDesktop(QString);
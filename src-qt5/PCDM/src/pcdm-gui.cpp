@@ -23,6 +23,15 @@ PCDMgui::PCDMgui() : QMainWindow()
     this->setWindowFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnBottomHint);
     this->setCentralWidget(new QWidget(this));
     QApplication::setActiveWindow(this);
+    //Setup the background user loading (local users are always available right away)
+    usedUidFallback = false;
+    userLoader = new UserLoader(this);
+    userTimer = new QTimer(this);
+	userTimer->setSingleShot(true);
+	userTimer->setInterval(500);
+	connect(userTimer, SIGNAL(timeout()), this, SLOT(LoadAvailableUsers()) );
+	connect(userLoader, SIGNAL(usersAdded(int)), this, SLOT(slotUsersAdded()) );
+	connect(userLoader, SIGNAL(finished()), this, SLOT(LoadAvailableUsers()) );
     //Load the Theme
     loadTheme();
     //Create the base widgets for the window and make sure they cover one screen at a time
@@ -36,6 +45,8 @@ PCDMgui::PCDMgui() : QMainWindow()
 	pcTimer->setInterval(15000); //every 15 seconds
 	connect(pcTimer, SIGNAL(timeout()), this, SLOT(LoadAvailableUsers()) );
     if(!pcAvail.isEmpty()){ pcTimer->start(); } //LoadAvailableUsers was already run once
+    //Now start streaming in any directory (LDAP/AD) users
+    if(Config::allowUserSelection()){ userLoader->start(); }
 
 }
 
@@ -526,10 +537,12 @@ void PCDMgui::LoadAvailableUsers(){
   pcAvail = Backend::getRegisteredPersonaCryptUsers();
   //qDebug() << "Loading Users:" << pcAvail << sysAvail << pcCurrent;
   QStringList userlist = Backend::getSystemUsers(false);
-  if(userlist.isEmpty()){ 
+  if(userlist.isEmpty() && !userLoader->isRunning() && !usedUidFallback){ 
     //Fallback method in case no valid system users could be found
+    usedUidFallback = true;
     Backend::allowUidUnder1K(true); 
     userlist = Backend::getSystemUsers(false);
+    if(Config::allowUserSelection()){ userLoader->start(); } //directory users need to be re-read too
   }
   //qDebug() << " - System:" << userlist;
   QString lastUser;
@@ -567,9 +580,13 @@ void PCDMgui::LoadAvailableUsers(){
   if(DEBUG_MODE){ qDebug() << "UserList (names):" << userlist << sysAvail; }
   //Add the usernames to the login widget (if different)
   if(userlist != sysAvail || sysAvail.isEmpty() ){
+    //Users streamed in after the first load should not move the current selection
+    QString current;
+    if(!sysAvail.isEmpty()){ current = loginW->currentUsername(); }
     loginW->setUsernames(userlist); //add in the detected users
     sysAvail = userlist; //save for later
     //Whenever we reset the internal list, also need to reset which user has focus
+    if(lastUser.isEmpty() && !current.isEmpty()){ loginW->setCurrentUser(current); return; }
     if(lastUser.isEmpty()){ lastUser = Backend::getLastUser(); }
     if(!lastUser.isEmpty()){ //set the previously used user
     	loginW->setCurrentUser(Backend::getDisplayNameFromUsername(lastUser)); 
@@ -578,6 +595,11 @@ void PCDMgui::LoadAvailableUsers(){
   
 }
 
+void PCDMgui::slotUsersAdded(){
+  //Wait for a couple pages of users before rebuilding the user list
+  if(!userTimer->isActive()){ userTimer->start(); }
+}
+
 void PCDMgui::slotChangeKeyboardLayout(){
   //Fill a couple global variables
   QStringList kModels = Backend::keyModels();
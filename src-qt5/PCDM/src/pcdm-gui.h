@@ -26,6 +26,7 @@
 #include <QTimer>
 
 #include "pcdm-backend.h"
+#include "pcdm-userloader.h"
 #include "themeStruct.h"
 #include "fancySwitcher.h"
 #include "dialogKeyboard.h"
@@ -59,6 +60,7 @@ private slots:
     void slotPushVirtKeyboard();    // Start xvkbd
     void slotLocaleChanged(QString);
     void LoadAvailableUsers();
+    void slotUsersAdded();
 
 private:
     //Objects
@@ -75,6 +77,10 @@ private:
     //PersonaCrypt variables
     QTimer *pcTimer; //refresh timer
     QStringList pcAvail, pcCurrent, sysAvail;
+    //Directory user loading
+    UserLoader *userLoader;
+    QTimer *userTimer; //coalesces list updates while users are streamed in
+    bool usedUidFallback;
     QSize defIconSize;
     
     QProcess* vkbd;
@@ -0,0 +1,112 @@
+/* PCDM Login Manager:
+*  Copyright(c) 2016 by the PC-BSD Project
+*  Available under the 3-clause BSD license
+*/
+
+#include <QProcessEnvironment>
+#include <QTimer>
+#include <QDebug>
+
+#include "pcdm-userloader.h"
+#include "pcdm-backend.h"
+
+UserLoader::UserLoader(QObject *parent) : QObject(parent){
+  proc = new QProcess(this);
+    proc->setReadChannel(QProcess::StandardOutput);
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    //Make sure to set all the possible UTF-8 flags before reading users
+    env.insert("LANG", "en_US.UTF-8");
+    env.insert("LC_ALL", "en_US.UTF-8");
+    env.insert("MM_CHARSET","UTF-8");
+    proc->setProcessEnvironment(env);
+  connect(proc, SIGNAL(readyReadStandardOutput()), this, SLOT(readOutput()) );
+  connect(proc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(procFinished()) );
+  pageTimer = new QTimer(this);
+    pageTimer->setSingleShot(true);
+    pageTimer->setInterval(0);
+  connect(pageTimer, SIGNAL(timeout()), this, SLOT(processPage()) );
+  added = 0;
+  procDone = true;
+}
+
+UserLoader::~UserLoader(){
+  stop();
+}
+
+void UserLoader::start(){
+  stop();
+  pending.clear();
+  added = 0;
+  procDone = false;
+  //Use "getent" to get all possible users (detects LDAP/AD users)
+  proc->start("getent", QStringList() << "passwd");
+}
+
+void UserLoader::stop(){
+  //Mark it done first - nothing should be parsed or emitted while stopping
+  procDone = true;
+  pending.clear();
+  pageTimer->stop();
+  if(proc->state() != QProcess::NotRunning){
+    proc->blockSignals(true);
+    proc->kill();
+    proc->waitForFinished(500);
+    proc->blockSignals(false);
+  }
+}
+
+bool UserLoader::isRunning(){
+  return (!procDone || !pending.isEmpty());
+}
+
+//=========
+//  PRIVATE
+//=========
+void UserLoader::finish(){
+  pending.clear();
+  procDone = true;
+  emit finished();
+}
+
+void UserLoader::readOutput(){
+  pending.append( proc->readAllStandardOutput() );
+  if(!pageTimer->isActive()){ processPage(); } //otherwise the queued page will pick it up
+}
+
+void UserLoader::processPage(){
+  int count = 0;
+  int newusers = 0;
+  while(count < USERPAGESIZE){
+    int end = pending.indexOf('\n');
+    if(end < 0){
+      //Incomplete line - wait for more output unless the process is already done
+      if(procDone && !pending.isEmpty()){ end = pending.length(); }
+      else{ break; }
+    }
+    QString line = QString::fromUtf8(pending.constData(), end).simplified();
+    pending.remove(0, end+1);
+    count++;
+    if( Backend::addSystemUser(line) ){ newusers++; added++; }
+    if(added >= MAXDIRECTORYUSERS){
+      Backend::log("PCDM: Directory user limit reached - not listing any more users");
+      proc->kill();
+      if(newusers>0){ emit usersAdded(newusers); }
+      finish();
+      return;
+    }
+  }
+  if(newusers>0){ emit usersAdded(newusers); }
+  if(pending.contains('\n') || (procDone && !pending.isEmpty()) ){
+    //Let the event loop run before parsing the next page
+    pageTimer->start();
+  }else if(procDone){
+    finish();
+  }
+}
+
+void UserLoader::procFinished(){
+  if(procDone){ return; } //killed on purpose
+  procDone = true;
+  pending.append( proc->readAllStandardOutput() );
+  if(!pageTimer->isActive()){ processPage(); }
+}
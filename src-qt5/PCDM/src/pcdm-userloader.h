@@ -0,0 +1,52 @@
+/* PCDM Login Manager:
+*  Copyright(c) 2016 by the PC-BSD Project
+*  Available under the 3-clause BSD license
+*/
+
+/*
+ Background loader for directory (LDAP/AD) users from "getent passwd"
+*/
+
+#ifndef PCDM_USERLOADER_H
+#define PCDM_USERLOADER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QByteArray>
+#include <QTimer>
+
+#define USERPAGESIZE 250	//number of passwd entries parsed per event loop pass
+#define MAXDIRECTORYUSERS 2000	//stop listing directory users after this many
+
+class UserLoader : public QObject
+{
+	Q_OBJECT
+
+  public:
+	UserLoader(QObject *parent = 0);
+	~UserLoader();
+
+	void start(); //(re)start reading the users (Backend lists should already contain the local users)
+	void stop();
+	bool isRunning();
+
+  private:
+	QProcess *proc;
+	QByteArray pending; //unparsed output
+	int added;
+	bool procDone;
+	QTimer *pageTimer; //queues up the next page of parsing
+
+	void finish();
+
+  private slots:
+	void readOutput();
+	void processPage();
+	void procFinished();
+
+  signals:
+	void usersAdded(int); //number of new users put into the Backend lists
+	void finished();
+};
+
+#endif
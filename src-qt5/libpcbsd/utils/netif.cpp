@@ -31,11 +31,13 @@
 #include <net/if.h>
 #include <net/if_dl.h>
 #include <net/if_media.h>
+#include <net/route.h>
 
 #include <ifaddrs.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <stdlib.h>
+#include <errno.h>
 
 #include <qregexp.h>
 #include <QDebug>
@@ -46,9 +48,80 @@
 
 #include "pcbsd-netif.h"
 #include "pcbsd-utils.h"
+#include "pcbsd-conffile.h"
 
 using namespace pcbsd;
 
+// Fetch the NET_RT_IFLIST routing table dump into "buf" (grown as needed, never
+//  shrunk) and return the number of valid bytes, or -1 on error.
+//  ifindex = 0 returns the records for every interface
+static long fetchIfList(int ifindex, QByteArray &buf)
+{
+   int mib[6];
+   size_t len;
+
+   mib[0] = CTL_NET;
+   mib[1] = AF_ROUTE;
+   mib[2] = 0;
+   mib[3] = AF_LINK;
+   mib[4] = NET_RT_IFLIST;
+   mib[5] = ifindex;
+
+   //The table can grow between the size probe and the read, so retry a couple times
+   for (int tries = 0; tries < 3; tries++)
+   {
+      if ( sysctl(mib, 6, NULL, &len, NULL, 0) < 0 )
+         return -1;
+      if ( (size_t) buf.size() < len )
+         buf.resize( len + len / 4 ); //some headroom for new addresses/interfaces
+      len = buf.size();
+      if ( sysctl(mib, 6, buf.data(), &len, NULL, 0) == 0 )
+         return (long) len;
+      if ( errno != ENOMEM )
+         return -1;
+   }
+   return -1;
+}
+
+// Pull the interface counters out of the RTM_IFINFO records of a NET_RT_IFLIST dump
+static QList<NetworkInterfaceStats> parseIfList(const char *buf, long len)
+{
+   QList<NetworkInterfaceStats> result;
+   const char *end = buf + len;
+   const char *next = buf;
+
+   while ( next + (long) sizeof(struct if_msghdr) <= end )
+   {
+      const struct if_msghdr *ifm = (const struct if_msghdr *) next;
+      if ( ifm->ifm_msglen == 0 )
+         break;
+      next += ifm->ifm_msglen;
+      if ( ifm->ifm_type != RTM_IFINFO )
+         continue; //RTM_NEWADDR records for the addresses of the interface
+
+      const struct sockaddr_dl *sdl = (const struct sockaddr_dl *)(ifm + 1);
+      if ( sdl->sdl_family != AF_LINK )
+         continue;
+
+      NetworkInterfaceStats st;
+      st.name = QString::fromLocal8Bit(sdl->sdl_data, sdl->sdl_nlen);
+      st.packetsRx = ifm->ifm_data.ifi_ipackets;
+      st.packetsTx = ifm->ifm_data.ifi_opackets;
+      st.errorsRx = ifm->ifm_data.ifi_ierrors;
+      st.errorsTx = ifm->ifm_data.ifi_oerrors;
+      st.bytesRx = ifm->ifm_data.ifi_ibytes;
+      st.bytesTx = ifm->ifm_data.ifi_obytes;
+      result << st;
+   }
+   return result;
+}
+
+// Change in a counter, treating a smaller value as a counter reset
+static quint64 counterDelta(quint64 now, quint64 before)
+{
+   return (now >= before) ? (now - before) : now;
+}
+
 QStringList NetworkInterface::getInterfaces()
 {
    QStringList result;
@@ -129,7 +202,8 @@ QString NetworkInterface::macAsString()
       mac += QString::number(*(ptr+i), 16).right(2).rightJustified(2, '0');
       if (i<5) mac += ":";
    }
-   
+   free(buf);
+
    return mac;
 }
 
@@ -203,98 +277,30 @@ bool NetworkInterface::isUp()
 
 long NetworkInterface::packetsRx()
 {
-   int mib[6];
-   size_t len;
-   char *buf;
-   struct if_msghdr *ifm;
-
-   mib[0] = CTL_NET;
-   mib[1] = AF_ROUTE;
-   mib[2] = 0;
-   mib[3] = AF_LINK;
-   mib[4] = NET_RT_IFLIST;
-   mib[5] = if_nametoindex(name.toLocal8Bit());
-
-   //First find the size of the return, so we can adjust buf accordingly
-   sysctl(mib, 6, NULL, &len, NULL, 0);
-   buf = (char *) malloc(len);
-   sysctl(mib, 6, buf, &len, NULL, 0);
-
-   ifm = (if_msghdr *) buf;
-
-   return ifm->ifm_data.ifi_ipackets;
+   NetworkInterfaceStats st;
+   NetworkStatistics::readCounters(name, &st);
+   return st.packetsRx;
 }
 
 long NetworkInterface::packetsTx()
 {
-   int mib[6];
-   size_t len;
-   char *buf;
-   struct if_msghdr *ifm;
-
-   mib[0] = CTL_NET;
-   mib[1] = AF_ROUTE;
-   mib[2] = 0;
-   mib[3] = AF_LINK;
-   mib[4] = NET_RT_IFLIST;
-   mib[5] = if_nametoindex(name.toLocal8Bit());
-
-   //First find the size of the return, so we can adjust buf accordingly
-   sysctl(mib, 6, NULL, &len, NULL, 0);
-   buf = (char *) malloc(len);
-   sysctl(mib, 6, buf, &len, NULL, 0);
-
-   ifm = (if_msghdr *) buf;
-
-   return ifm->ifm_data.ifi_opackets;
+   NetworkInterfaceStats st;
+   NetworkStatistics::readCounters(name, &st);
+   return st.packetsTx;
 }
 
 long NetworkInterface::errorsRx()
 {
-   int mib[6];
-   size_t len;
-   char *buf;
-   struct if_msghdr *ifm;
-
-   mib[0] = CTL_NET;
-   mib[1] = AF_ROUTE;
-   mib[2] = 0;
-   mib[3] = AF_LINK;
-   mib[4] = NET_RT_IFLIST;
-   mib[5] = if_nametoindex(name.toLocal8Bit());
-
-   //First find the size of the return, so we can adjust buf accordingly
-   sysctl(mib, 6, NULL, &len, NULL, 0);
-   buf = (char *) malloc(len);
-   sysctl(mib, 6, buf, &len, NULL, 0);
-
-   ifm = (if_msghdr *) buf;
-
-   return ifm->ifm_data.ifi_ierrors;
+   NetworkInterfaceStats st;
+   NetworkStatistics::readCounters(name, &st);
+   return st.errorsRx;
 }
 
 long NetworkInterface::errorsTx()
 {
-   int mib[6];
-   size_t len;
-   char *buf;
-   struct if_msghdr *ifm;
-
-   mib[0] = CTL_NET;
-   mib[1] = AF_ROUTE;
-   mib[2] = 0;
-   mib[3] = AF_LINK;
-   mib[4] = NET_RT_IFLIST;
-   mib[5] = if_nametoindex(name.toLocal8Bit());
-
-   //First find the size of the return, so we can adjust buf accordingly
-   sysctl(mib, 6, NULL, &len, NULL, 0);
-   buf = (char *) malloc(len);
-   sysctl(mib, 6, buf, &len, NULL, 0);
-
-   ifm = (if_msghdr *) buf;
-
-   return ifm->ifm_data.ifi_oerrors;
+   NetworkInterfaceStats st;
+   NetworkStatistics::readCounters(name, &st);
+   return st.errorsTx;
 }
 
 uint NetworkInterface::devNum()
@@ -597,10 +603,13 @@ void NetworkInterface::enableLagg(QString dev)
      return;
   }
 
+  // All the rc.conf changes are written out together at the end
+  ConfFileBatch rcconf("/etc/rc.conf");
+
   // Setup the ethernet mac address cloning for this device
-  Utils::setConfFileValue( "/etc/rc.conf", wiredDev + "_ether", wiredDev + "_ether=\"`ifconfig " + wiredDev + " ether | grep ether | awk '{print $2}'`\"", 1);
-  Utils::setConfFileValue( "/etc/rc.conf", "ifconfig_" + wifiParent, "ifconfig_" + wifiParent + "=\"ether ${" + wiredDev + "_ether}\"", 2);
-  Utils::setConfFileValue( "/etc/rc.conf", "wlans_" + wifiParent, "wlans_" + wifiParent + "=\"" + dev + "\"", -1);
+  rcconf.setValue( wiredDev + "_ether", wiredDev + "_ether=\"`ifconfig " + wiredDev + " ether | grep ether | awk '{print $2}'`\"", 1);
+  rcconf.setValue( "ifconfig_" + wifiParent, "ifconfig_" + wifiParent + "=\"ether ${" + wiredDev + "_ether}\"", 2);
+  rcconf.setValue( "wlans_" + wifiParent, "wlans_" + wifiParent + "=\"" + dev + "\"", -1);
 
   wifiConf = wifiConf.simplified();
 
@@ -625,15 +634,16 @@ void NetworkInterface::enableLagg(QString dev)
 
   // Save the new wifi config line
   newWifiConf = newWifiConf.simplified();
-  Utils::setConfFileValue( "/etc/rc.conf", "ifconfig_" + dev, "ifconfig_" + dev + "=\"" + newWifiConf + "\"", -1);
+  rcconf.setValue( "ifconfig_" + dev, "ifconfig_" + dev + "=\"" + newWifiConf + "\"", -1);
 
   // Set the wired device to UP
-  Utils::setConfFileValue( "/etc/rc.conf", "ifconfig_" + wiredDev, "ifconfig_" + wiredDev + "=\"up\"", -1);
+  rcconf.setValue( "ifconfig_" + wiredDev, "ifconfig_" + wiredDev + "=\"up\"", -1);
 
   // Enable the lagg0 interface
   wifiConf = wifiConf.simplified();
-  Utils::setConfFileValue( "/etc/rc.conf", "cloned_interfaces", "cloned_interfaces=\"lagg0\"", -1);
-  Utils::setConfFileValue( "/etc/rc.conf", "ifconfig_lagg0", "ifconfig_lagg0=\"laggproto failover laggport " + wiredDev + " laggport " + dev + " " + wifiConf + "\"", -1);
+  rcconf.setValue( "cloned_interfaces", "cloned_interfaces=\"lagg0\"", -1);
+  rcconf.setValue( "ifconfig_lagg0", "ifconfig_lagg0=\"laggproto failover laggport " + wiredDev + " laggport " + dev + " " + wifiConf + "\"", -1);
+  rcconf.commit();
 
 }
 
@@ -712,3 +722,112 @@ void NetworkInterface::disableWirelessAccessPoint(QString wdev){
   Utils::setConfFileValue("/etc/rc.conf", "hostapd_enable", "hostapd_enable=\"NO\"", -1);
   Utils::runShellCommand("ifconfig wlan0 destroy");
 }
+
+/* Interface statistics snapshots */
+
+NetworkStatistics::NetworkStatistics()
+{
+   lastMsecs = 0;
+   hasPrevious = false;
+   clock.start();
+}
+
+bool NetworkStatistics::update()
+{
+   long len = fetchIfList(0, buffer);
+   if ( len < 0 )
+      return false;
+   update( parseIfList(buffer.constData(), len), clock.elapsed() );
+   return true;
+}
+
+void NetworkStatistics::update(const QList<NetworkInterfaceStats> &counters, qint64 msecs)
+{
+   QHash<QString, NetworkInterfaceStats> previous = current;
+   double secs = (msecs - lastMsecs) / 1000.0;
+   current.clear();
+   order.clear();
+
+   for (int i = 0; i < counters.length(); i++)
+   {
+      NetworkInterfaceStats st;
+      st.name = counters[i].name;
+      st.packetsRx = counters[i].packetsRx;
+      st.packetsTx = counters[i].packetsTx;
+      st.errorsRx = counters[i].errorsRx;
+      st.errorsTx = counters[i].errorsTx;
+      st.bytesRx = counters[i].bytesRx;
+      st.bytesTx = counters[i].bytesTx;
+
+      //Interfaces which just appeared have no deltas/rates yet
+      if ( hasPrevious && previous.contains(st.name) )
+      {
+         const NetworkInterfaceStats &old = previous[st.name];
+         st.packetsRxDelta = counterDelta(st.packetsRx, old.packetsRx);
+         st.packetsTxDelta = counterDelta(st.packetsTx, old.packetsTx);
+         st.errorsRxDelta = counterDelta(st.errorsRx, old.errorsRx);
+         st.errorsTxDelta = counterDelta(st.errorsTx, old.errorsTx);
+         st.bytesRxDelta = counterDelta(st.bytesRx, old.bytesRx);
+         st.bytesTxDelta = counterDelta(st.bytesTx, old.bytesTx);
+         if ( secs > 0 )
+         {
+            st.packetsRxRate = st.packetsRxDelta / secs;
+            st.packetsTxRate = st.packetsTxDelta / secs;
+            st.bytesRxRate = st.bytesRxDelta / secs;
+            st.bytesTxRate = st.bytesTxDelta / secs;
+         }
+      }
+      if ( !current.contains(st.name) )
+         order << st.name;
+      current.insert(st.name, st);
+   }
+
+   lastMsecs = msecs;
+   hasPrevious = true;
+}
+
+QStringList NetworkStatistics::interfaces() const
+{
+   return order;
+}
+
+bool NetworkStatistics::contains(QString ifname) const
+{
+   return current.contains(ifname);
+}
+
+const NetworkInterfaceStats NetworkStatistics::stats(QString ifname) const
+{
+   return current.value(ifname);
+}
+
+QList<NetworkInterfaceStats> NetworkStatistics::allStats() const
+{
+   QList<NetworkInterfaceStats> result;
+   for (int i = 0; i < order.length(); i++)
+      result << current.value(order[i]);
+   return result;
+}
+
+bool NetworkStatistics::readCounters(QString ifname, NetworkInterfaceStats *out)
+{
+   int index = if_nametoindex(ifname.toLocal8Bit());
+   if ( index == 0 )
+      return false;
+
+   QByteArray buf;
+   long len = fetchIfList(index, buf);
+   if ( len < 0 )
+      return false;
+
+   QList<NetworkInterfaceStats> list = parseIfList(buf.constData(), len);
+   for (int i = 0; i < list.length(); i++)
+   {
+      if ( list[i].name == ifname )
+      {
+         *out = list[i];
+         return true;
+      }
+   }
+   return false;
+}
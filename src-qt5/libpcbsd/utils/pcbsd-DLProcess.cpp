@@ -1,5 +1,8 @@
 #include "pcbsd-DLProcess.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 DLProcess::DLProcess(QObject* parent) : QProcess(parent){
   //Setup the process environment for downloads
   this->setProcessChannelMode(QProcess::MergedChannels);
@@ -43,8 +46,10 @@ void DLProcess::setDLType(QString type){
     DLTYPE = 1; 
     //For this type, need to run an additional process to watch an event-pipe
     if(pipeFile.isEmpty()){ setWardenDir(""); } //generate the pipe file on base system
-    //Setup the pipe file on the system
-    system("mkfifo "+pipeFile.toUtf8()+" ; sleep 1");
+    //Setup the pipe file on the system (mkfifo(2) is done when it returns - no need to wait on it)
+    if( mkfifo(QFile::encodeName(pipeFile).constData(), 0666) != 0 ){
+      qDebug() << "Could not create the event pipe:" << pipeFile;
+    }
     watcher = new QProcess(this);
 	  watcher->start("cat", QStringList() << "-u" << pipeFile );
           connect(watcher, SIGNAL(readyRead()), this, SLOT(newPipeMessage()) );
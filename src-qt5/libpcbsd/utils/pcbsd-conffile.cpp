@@ -0,0 +1,177 @@
+#include "pcbsd-conffile.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QTextStream>
+
+using namespace pcbsd;
+
+namespace{
+
+struct ConfFileEntry{
+  QDateTime mtime;
+  qint64 size;
+  QStringList raw; //lines as they are in the file
+  QStringList stripped; //comments removed and whitespace trimmed
+  QHash<QString, QList<int> > index; //leading token -> line numbers (in file order)
+};
+
+typedef QSharedPointer<const ConfFileEntry> ConfFileEntryPtr;
+
+QHash<QString, ConfFileEntryPtr> CACHE;
+QMutex CACHELOCK;
+
+//The leading run of [A-Za-z0-9_] characters ("ifconfig_em0" for "ifconfig_em0=DHCP")
+QString leadingToken(const QString &str){
+  int i=0;
+  while( i<str.length() && (str[i].isLetterOrNumber() || str[i]==QChar('_')) ){ i++; }
+  return str.left(i);
+}
+
+ConfFileEntryPtr loadEntry(QString file, const QFileInfo &info){
+  QFile fileobj(file);
+  if( !fileobj.open(QIODevice::ReadOnly) ){ return ConfFileEntryPtr(); }
+  ConfFileEntry *entry = new ConfFileEntry;
+  entry->mtime = info.lastModified();
+  entry->size = info.size();
+  QTextStream stream(&fileobj);
+  stream.setCodec("UTF-8");
+  while( !stream.atEnd() ){
+    QString line = stream.readLine();
+    QString strip = line.section("#",0,0).trimmed();
+    entry->index[leadingToken(strip)] << entry->stripped.length();
+    entry->raw << line;
+    entry->stripped << strip;
+  }
+  fileobj.close();
+  return ConfFileEntryPtr(entry);
+}
+
+//Returns the current parsed copy of the file (null if it cannot be read)
+ConfFileEntryPtr entryFor(QString file){
+  QFileInfo info(file);
+  if( !info.exists() ){ ConfFileCache::invalidate(file); return ConfFileEntryPtr(); }
+  QMutexLocker lock(&CACHELOCK);
+  ConfFileEntryPtr entry = CACHE.value(file);
+  if( !entry.isNull() && entry->mtime == info.lastModified() && entry->size == info.size() ){ return entry; }
+  entry = loadEntry(file, info);
+  if(entry.isNull()){ CACHE.remove(file); }
+  else{ CACHE.insert(file, entry); }
+  return entry;
+}
+
+//One pass of the original Utils::setConfFileValue() algorithm over the lines of a file
+QStringList applyEdit(const QStringList &in, QString oldKey, QString newKey, int occur){
+  QStringList out;
+  int found = 1;
+  for(int i=0; i<in.length(); i++){
+    const QString &line = in[i];
+    // Key is not found at all
+    if( line.indexOf(oldKey, 0) == -1 ){ out << line; continue; }
+    // Found the key, but it is commented out, so don't worry about this line
+    if( line.trimmed().indexOf("#", 0) == 0 ){ out << line; continue; }
+    // If the KEY is found, and we are just on wrong occurance, save it and continue to search
+    if( occur != -1 && found != occur ){ out << line; found++; continue; }
+    // If the KEY is found in the line and this matches the occurance that must be processed
+    if( !newKey.isEmpty() && found == occur ){ out << newKey; newKey.clear(); found++; continue; }
+    // If the KEY is found and we just want one occurance of the key
+    if( occur == -1 && !newKey.isEmpty() ){ out << newKey; newKey.clear(); found++; continue; }
+    //Anything else is a line to be removed
+  }
+  // Didn't find the key? Write it!
+  if( !newKey.isEmpty() ){ out << newKey; }
+  return out;
+}
+
+} //end of anonymous namespace
+
+//=============
+//  ConfFileCache
+//=============
+QStringList ConfFileCache::lines(QString file){
+  ConfFileEntryPtr entry = entryFor(file);
+  if(entry.isNull()){ return QStringList(); }
+  return entry->raw;
+}
+
+QString ConfFileCache::value(QString file, QString key, int occur){
+  ConfFileEntryPtr entry = entryFor(file);
+  if(entry.isNull()){ return QString(); }
+  //If the key ends in a delimiter ("name=" or "name: ") only lines with the same
+  //  leading token can match, otherwise it is a plain prefix and all lines need checking
+  QString token = leadingToken(key);
+  bool useIndex = !token.isEmpty() && token.length() < key.length();
+  QList<int> candidates;
+  if(useIndex){
+    candidates = entry->index.value(token);
+  }else{
+    for(int i=0; i<entry->stripped.length(); i++){ candidates << i; }
+  }
+  int found = 1;
+  for(int i=0; i<candidates.length(); i++){
+    QString line = entry->stripped[ candidates[i] ];
+    if( line.isEmpty() || !line.startsWith(key) ){ continue; }
+    if(found != occur){ found++; continue; }
+    line.remove(0, key.length());
+    // Remove any quotes
+    if( line.indexOf('"') == 0 ){ line = line.remove(0, 1); }
+    if( line.indexOf('"') != -1 ){ line.truncate(line.indexOf('"')); }
+    return line;
+  }
+  return QString();
+}
+
+void ConfFileCache::invalidate(QString file){
+  QMutexLocker lock(&CACHELOCK);
+  CACHE.remove(file);
+}
+
+void ConfFileCache::clear(){
+  QMutexLocker lock(&CACHELOCK);
+  CACHE.clear();
+}
+
+//=============
+//  ConfFileBatch
+//=============
+ConfFileBatch::ConfFileBatch(QString file){
+  filepath = file;
+}
+
+void ConfFileBatch::setValue(QString oldKey, QString newKey, int occur){
+  Edit edit;
+  edit.oldKey = oldKey;
+  edit.newKey = newKey;
+  edit.occur = occur;
+  edits << edit;
+}
+
+bool ConfFileBatch::isEmpty(){
+  return edits.isEmpty();
+}
+
+bool ConfFileBatch::commit(){
+  ConfFileEntryPtr entry = entryFor(filepath);
+  if(entry.isNull()){ return false; }
+  QStringList contents = entry->raw;
+  for(int i=0; i<edits.length(); i++){
+    contents = applyEdit(contents, edits[i].oldKey, edits[i].newKey, edits[i].occur);
+  }
+  //QSaveFile writes to a temporary file in the same dir and renames it over the original
+  QSaveFile fileout(filepath);
+  if( !fileout.open(QIODevice::WriteOnly) ){ return false; }
+  QTextStream streamout(&fileout);
+  streamout.setCodec("UTF-8");
+  for(int i=0; i<contents.length(); i++){ streamout << contents[i] << "\n"; }
+  streamout.flush();
+  bool ok = fileout.commit();
+  ConfFileCache::invalidate(filepath);
+  if(ok){ edits.clear(); }
+  return ok;
+}
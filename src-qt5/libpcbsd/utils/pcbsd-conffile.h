@@ -0,0 +1,52 @@
+#ifndef _PCBSD_CONFFILE_H_
+#define _PCBSD_CONFFILE_H_
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+namespace pcbsd
+{
+
+// Shared, parsed copies of the config files read through Utils::getConfFileValue()
+//  A file is only read again once its modification time or size changes
+class ConfFileCache
+{
+public:
+   //Lines of the file as they are on disk (empty if it cannot be read)
+   static QStringList lines(QString file);
+
+   //Same lookup as Utils::getConfFileValue(): returns the value of the "occur"th
+   //  (starting at 1) non-comment line which starts with "key"
+   static QString value(QString file, QString key, int occur = 1);
+
+   //Drop the cached copy of a file (or of every file)
+   static void invalidate(QString file);
+   static void clear();
+};
+
+// Group of edits to a single config file, applied with one rewrite of the file
+//  The new contents are written to a temporary file which is then renamed over
+//  the original, so readers never see a partially written file
+class ConfFileBatch
+{
+public:
+   ConfFileBatch(QString file);
+
+   //Same arguments/behavior as Utils::setConfFileValue(), edits are applied in order
+   void setValue(QString oldKey, QString newKey, int occur = -1);
+   bool isEmpty();
+   bool commit();
+
+private:
+   struct Edit{
+     QString oldKey, newKey;
+     int occur;
+   };
+   QString filepath;
+   QList<Edit> edits;
+};
+
+} //namespace
+
+#endif
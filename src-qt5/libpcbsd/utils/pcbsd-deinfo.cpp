@@ -0,0 +1,158 @@
+#include "pcbsd-deinfo.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QRegExp>
+#include <QStandardPaths>
+#include <QTextStream>
+
+using namespace pcbsd;
+
+namespace{
+
+const char* const PROFILES_DIR = "/usr/local/share/pcbsd/de-profiles";
+// Installing/removing a desktop adds/removes its session entry here
+const char* const XSESSIONS_DIR = "/usr/local/share/xsessions";
+
+QVector<DesktopEnvironmentInfo> DESKTOPS;
+bool DESKTOPSVALID = false;
+QString DESKTOPSSTAMP; //modification times of the dirs above when DESKTOPS was loaded
+QMutex DESKTOPSLOCK;
+
+QString dirStamp(){
+  return QFileInfo(PROFILES_DIR).lastModified().toString(Qt::ISODate) + "|"
+       + QFileInfo(XSESSIONS_DIR).lastModified().toString(Qt::ISODate);
+}
+
+// Read the variable assignments of one de-info profile
+//  Returns false if the profile uses anything more than plain KEY="value" lines (shell
+//  functions, command substitution, variables) since only the script can evaluate those
+bool readProfile(QString path, QHash<QString,QString> &vars){
+  QFile file(path);
+  if( !file.open(QIODevice::ReadOnly | QIODevice::Text) ){ return false; }
+  QTextStream in(&file);
+  QRegExp assign("^([A-Z_]+)=(\"[^\"$`]*\"|[^\\s\"$`]*)$");
+  bool ok = true;
+  while( !in.atEnd() ){
+    QString line = in.readLine().trimmed();
+    if( line.isEmpty() || line.startsWith("#") ){ continue; }
+    if( !assign.exactMatch(line) ){ ok = false; break; }
+    QString val = assign.cap(2);
+    if(val.startsWith("\"")){ val = val.mid(1, val.length()-2); }
+    vars.insert(assign.cap(1), val);
+  }
+  file.close();
+  return ok;
+}
+
+// Same as "which <file>": is the executable in the current $PATH
+bool haveExecutable(QString files){
+  QStringList list = files.split(" ", QString::SkipEmptyParts);
+  for(int i=0; i<list.length(); i++){
+    if( !QStandardPaths::findExecutable(list[i]).isEmpty() ){ return true; }
+  }
+  return false;
+}
+
+DesktopEnvironmentInfo profileToInfo(const QHash<QString,QString> &vars, QString session){
+  //defaults from the de-info script
+  DesktopEnvironmentInfo info;
+  info.Name = vars.value("DE_NAME");
+  info.isXDG = (vars.value("XDG").toLower()=="yes" || vars.value("XDG")=="1");
+  info.ConfigurationApplication = vars.value("DE_CONFIG_APP");
+  info.SudoCommand = vars.value("DE_SU", "pc-su %s");
+  info.FileManager = vars.value("DE_FILEMAN");
+  info.TerminalCommand = vars.value("DE_TERMINAL", "xterm");
+  info.TerminalTitleKey = vars.value("DE_TERMINAL_TITLE", "-T");
+  info.TerminalCommandKey = vars.value("DE_TERMINAL_COMMAND", "-e");
+  info.isTerminalNeedParamsSplit = (vars.value("DE_TERMINAL_SEPARATE_ARGS", "NO").toLower()=="yes");
+  info.isActive = ( !session.isEmpty() && vars.value("DE_SESSION_NAME") == session );
+  info.isInstalled = info.isActive || haveExecutable(vars.value("DE_INSTALL_FILE"));
+  return info;
+}
+
+// Fallback for profiles which need a shell: run the de-info script (once per cache refresh)
+QVector<DesktopEnvironmentInfo> scriptDesktops(){
+  QVector<DesktopEnvironmentInfo> out;
+  QProcess deinfo;
+  deinfo.setProcessChannelMode(QProcess::MergedChannels);
+  deinfo.start(QString("/usr/local/bin/de-info"), QStringList() << "-a");
+  deinfo.waitForFinished(-1);
+  DesktopEnvironmentInfo entry;
+  while( deinfo.canReadLine() ){
+    QString str = QString(deinfo.readLine()).simplified();
+    QString val = str.section(":",1,-1).trimmed();
+    if(str.startsWith("DE name:")){
+      if(!entry.Name.isEmpty()){ out.push_back(entry); entry = DesktopEnvironmentInfo(); }
+      entry.Name = val;
+    }
+    else if(str.startsWith("Current DE:")){ entry.isActive = (val.toLower()=="yes"); }
+    else if(str.startsWith("Installed:")){ entry.isInstalled = (val.toLower()=="yes"); }
+    else if(str.startsWith("XDG compatible:")){ entry.isXDG = (val.toLower()=="yes"); }
+    else if(str.startsWith("Sudo command:")){ entry.SudoCommand = val; }
+    else if(str.startsWith("File manager:")){ entry.FileManager = val; }
+    else if(str.startsWith("Terminal:")){ entry.TerminalCommand = val; }
+    else if(str.startsWith("Terminal title switch:")){ entry.TerminalTitleKey = val; }
+    else if(str.startsWith("Terminal command switch:")){ entry.TerminalCommandKey = val; }
+    else if(str.startsWith("Terminal command separate args:")){ entry.isTerminalNeedParamsSplit = (val.toLower()=="yes"); }
+    else if(str.startsWith("Configuration app:")){ entry.ConfigurationApplication = val; }
+  }
+  if(!entry.Name.isEmpty()){ out.push_back(entry); }
+  return out;
+}
+
+QVector<DesktopEnvironmentInfo> loadDesktops(){
+  QVector<DesktopEnvironmentInfo> out;
+  QString session = QString::fromLocal8Bit(qgetenv("PCDM_SESSION"));
+  QDir dir(PROFILES_DIR);
+  QStringList profiles = dir.entryList(QStringList() << "*.profile", QDir::Files, QDir::Name);
+  for(int i=0; i<profiles.length(); i++){
+    QHash<QString,QString> vars;
+    if( !readProfile(dir.absoluteFilePath(profiles[i]), vars) ){ return scriptDesktops(); }
+    out.push_back( profileToInfo(vars, session) );
+  }
+  return out;
+}
+
+} //end of anonymous namespace
+
+QVector<DesktopEnvironmentInfo> DEInfoCache::all(){
+  QString stamp = dirStamp();
+  QMutexLocker lock(&DESKTOPSLOCK);
+  //Also reload if a desktop entry was added/removed since the last load
+  if( !DESKTOPSVALID || stamp != DESKTOPSSTAMP ){
+    DESKTOPS = loadDesktops();
+    DESKTOPSSTAMP = stamp;
+    DESKTOPSVALID = true;
+  }
+  return DESKTOPS;
+}
+
+QVector<DesktopEnvironmentInfo> DEInfoCache::installed(){
+  QVector<DesktopEnvironmentInfo> list = all();
+  QVector<DesktopEnvironmentInfo> out;
+  for(int i=0; i<list.size(); i++){
+    if(list[i].isInstalled || list[i].isActive){ out.push_back(list[i]); }
+  }
+  return out;
+}
+
+DesktopEnvironmentInfo DEInfoCache::current(){
+  QVector<DesktopEnvironmentInfo> list = all();
+  for(int i=0; i<list.size(); i++){
+    if(list[i].isActive){ return list[i]; }
+  }
+  return DesktopEnvironmentInfo();
+}
+
+void DEInfoCache::invalidate(){
+  QMutexLocker lock(&DESKTOPSLOCK);
+  DESKTOPS.clear();
+  DESKTOPSVALID = false;
+}
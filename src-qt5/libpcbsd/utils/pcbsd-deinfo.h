@@ -0,0 +1,32 @@
+#ifndef _PCBSD_DEINFO_H_
+#define _PCBSD_DEINFO_H_
+
+#include <QString>
+#include <QVector>
+
+#include "pcbsd-utils.h"
+
+namespace pcbsd
+{
+
+// Desktop environment detection used by Utils::currentDesktop()/installedDesktops()
+//  The de-info profiles (/usr/local/share/pcbsd/de-profiles) are read directly and the
+//  active session is taken from $PCDM_SESSION, the results are kept until invalidate() or
+//  until the profiles or the installed desktop session entries (xsessions) change
+class DEInfoCache
+{
+public:
+   //Every known desktop environment, in de-info profile order
+   static QVector<DesktopEnvironmentInfo> all();
+   //Same output as "de-info -i" (installed or active environments)
+   static QVector<DesktopEnvironmentInfo> installed();
+   //Same output as "de-info" (empty Name if no known environment is active)
+   static DesktopEnvironmentInfo current();
+
+   //Drop the cached results (after installing/removing a desktop for instance)
+   static void invalidate();
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,111 @@
+#include "pcbsd-logfollower.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+LogFollower::LogFollower(QString file, QString previous, QObject *parent) : QObject(parent){
+  logfile = file;
+  prevfile = previous;
+  offset = 0;
+  inode = 0;
+  maxbytes = 1024*1024;
+  watcher = new QFileSystemWatcher(this);
+  connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged()) );
+  connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(fileChanged()) );
+  delay = new QTimer(this);
+    delay->setSingleShot(true);
+    delay->setInterval(250);
+  connect(delay, SIGNAL(timeout()), this, SLOT(check()) );
+}
+
+LogFollower::~LogFollower(){
+  stop();
+}
+
+void LogFollower::setDelay(int ms){
+  delay->setInterval(ms);
+}
+
+void LogFollower::setMaxBytes(qint64 bytes){
+  maxbytes = bytes;
+}
+
+QString LogFollower::currentFile(){
+  return shown;
+}
+
+//=============
+//  PUBLIC SLOTS
+//=============
+void LogFollower::start(){
+  shown.clear();
+  offset = 0;
+  inode = 0;
+  //Watch the directory too: the file itself drops out of the watcher when it is removed or renamed
+  watcher->addPath(QFileInfo(logfile).absolutePath());
+  if(QFile::exists(logfile)){ watcher->addPath(logfile); }
+  check();
+}
+
+void LogFollower::stop(){
+  delay->stop();
+  if(!watcher->files().isEmpty()){ watcher->removePaths(watcher->files()); }
+  if(!watcher->directories().isEmpty()){ watcher->removePaths(watcher->directories()); }
+}
+
+void LogFollower::check(){
+  delay->stop();
+  //Use the current log unless it is missing or empty
+  QString file = logfile;
+  struct stat info;
+  if( 0!=stat(logfile.toLocal8Bit(), &info) || info.st_size==0 ){
+    file = prevfile;
+    if( file.isEmpty() || 0!=stat(file.toLocal8Bit(), &info) ){
+      if(!shown.isEmpty() || inode==0){ shown.clear(); offset = 0; inode = 1; emit reset(""); }
+      return;
+    }
+  }
+  qint64 size = info.st_size;
+  if(file != shown || (quint64) info.st_ino != inode || size < offset || size - offset > maxbytes){
+    //Different file, or it was truncated/replaced (or too much was added to bother appending)
+    shown = file;
+    inode = info.st_ino;
+    qint64 start = qMax((qint64) 0, size - maxbytes);
+    offset = start;
+    QString text = readFrom(file, start, size, start > 0);
+    emit reset(text);
+  }else if(size > offset){
+    QString text = readFrom(file, offset, size, false);
+    if(!text.isNull()){ emit appended(text); }
+  }
+  //Re-add the file if it was dropped from the watcher (rotated or created since the last check)
+  if(QFile::exists(logfile) && !watcher->files().contains(logfile)){ watcher->addPath(logfile); }
+}
+
+//==========
+//    PRIVATE
+//==========
+//Read the complete lines between pos and size, moving "offset" past them
+// (a line still being written is left for the next read)
+QString LogFollower::readFrom(QString file, qint64 pos, qint64 size, bool skipPartial){
+  QFile fileobj(file);
+  if( !fileobj.open(QIODevice::ReadOnly) || !fileobj.seek(pos) ){ return QString(); }
+  QByteArray data = fileobj.read(size - pos);
+  fileobj.close();
+  int start = 0;
+  if(skipPartial){
+    //Started in the middle of the file: drop the first (partial) line
+    start = data.indexOf('\n') + 1;
+  }
+  int end = data.lastIndexOf('\n');
+  if(end < start){ return QString(); } //no complete line yet
+  offset = pos + end + 1;
+  return QString::fromUtf8(data.mid(start, end - start));
+}
+
+void LogFollower::fileChanged(){
+  if(!delay->isActive()){ delay->start(); }
+}
@@ -0,0 +1,47 @@
+#ifndef _PCBSD_LOG_FOLLOWER_H
+#define _PCBSD_LOG_FOLLOWER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QString>
+#include <QTimer>
+
+// Follows a log file the way "tail -F" does: only the bytes added since the last
+// check are read, and the file is read again from the start (keeping at most
+// maxBytes of the end) if it was truncated or replaced. If the log does not exist
+// (or is still empty) the previous log file is shown instead.
+// File notifications are merged so bursts of writes cause at most one read per delay
+class LogFollower : public QObject{
+	Q_OBJECT
+public:
+	LogFollower(QString file, QString previous = "", QObject *parent = 0);
+	~LogFollower();
+
+	void setDelay(int ms); //minimum time between reads (default 250 ms)
+	void setMaxBytes(qint64 bytes); //largest amount of text passed to reset() (default 1MB)
+
+	QString currentFile(); //file being shown at the moment (empty if neither exists)
+
+public slots:
+	void start(); //emits reset() with the current contents and starts following the file
+	void stop();
+	void check(); //read any new data right now
+
+private:
+	QFileSystemWatcher *watcher;
+	QTimer *delay;
+	QString logfile, prevfile, shown;
+	qint64 offset, maxbytes;
+	quint64 inode;
+
+	QString readFrom(QString file, qint64 pos, qint64 size, bool skipPartial);
+
+private slots:
+	void fileChanged();
+
+signals:
+	void reset(QString); //the contents were replaced (new file, truncation or rotation)
+	void appended(QString); //complete new lines (without the final newline)
+};
+
+#endif
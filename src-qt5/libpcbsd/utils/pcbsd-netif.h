@@ -27,6 +27,56 @@
 
 #include <qstringlist.h>
 #include <qstring.h>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+// Counters for one interface as seen by a NetworkStatistics snapshot, plus
+// the change (and per-second rate) since the snapshot before it.
+struct NetworkInterfaceStats
+{
+   NetworkInterfaceStats() : packetsRx(0), packetsTx(0), errorsRx(0), errorsTx(0), bytesRx(0), bytesTx(0),
+      packetsRxDelta(0), packetsTxDelta(0), errorsRxDelta(0), errorsTxDelta(0), bytesRxDelta(0), bytesTxDelta(0),
+      packetsRxRate(0), packetsTxRate(0), bytesRxRate(0), bytesTxRate(0)
+   {;}
+
+   QString name;
+   quint64 packetsRx, packetsTx, errorsRx, errorsTx, bytesRx, bytesTx;
+   quint64 packetsRxDelta, packetsTxDelta, errorsRxDelta, errorsTxDelta, bytesRxDelta, bytesTxDelta;
+   double packetsRxRate, packetsTxRate, bytesRxRate, bytesTxRate; //per second
+};
+
+// Counter snapshot for every interface, fetched with a single sysctl into a
+// buffer which is kept around and reused between calls to update()
+class NetworkStatistics
+{
+public:
+   NetworkStatistics();
+
+   //Take a new snapshot of all interfaces (returns false if the sysctl failed)
+   bool update();
+   //Take a new snapshot from already gathered raw counters (only the name and
+   //  absolute counter fields are used), "msecs" is the time the counters were read
+   void update(const QList<NetworkInterfaceStats> &counters, qint64 msecs);
+
+   QStringList interfaces() const;
+   bool contains(QString ifname) const;
+   //Returns a copy of the current entry (all zero if the interface is unknown)
+   const NetworkInterfaceStats stats(QString ifname) const;
+   QList<NetworkInterfaceStats> allStats() const;
+
+   //Read the absolute counters for a single interface without keeping a snapshot
+   static bool readCounters(QString ifname, NetworkInterfaceStats *out);
+
+private:
+   QByteArray buffer;
+   QHash<QString, NetworkInterfaceStats> current;
+   QStringList order;
+   qint64 lastMsecs;
+   bool hasPrevious;
+   QElapsedTimer clock;
+};
 
 class NetworkInterface
 {
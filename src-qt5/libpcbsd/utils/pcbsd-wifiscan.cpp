@@ -0,0 +1,158 @@
+#include "pcbsd-wifiscan.h"
+#include "pcbsd-netif.h"
+
+#include <QSet>
+
+namespace{
+
+// Readings kept per access point, and how long an access point stays cached after it was last seen
+const int HISTORY_SIZE = 10;
+const int EXPIRE_SECS = 120;
+// A scan which takes longer than this is stuck (driver/device trouble) and gets killed
+const int SCAN_TIMEOUT_MSEC = 30000;
+
+QHash<QString, WifiScanner*> SCANNERS;
+
+bool strongerThan(const WifiAccessPoint &a, const WifiAccessPoint &b){
+  return a.strength > b.strength;
+}
+
+} //end of anonymous namespace
+
+WifiScanner* WifiScanner::forDevice(QString device){
+  if( !SCANNERS.contains(device) ){ SCANNERS.insert(device, new WifiScanner(device)); }
+  return SCANNERS.value(device);
+}
+
+WifiScanner::WifiScanner(QString device, QObject *parent) : QObject(parent){
+  dev = device;
+  proc = new QProcess(this);
+  proc->setProcessChannelMode(QProcess::SeparateChannels);
+  connect(proc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(procFinished()) );
+  connect(proc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(procError(QProcess::ProcessError)) );
+  timeout = new QTimer(this);
+  timeout->setSingleShot(true);
+  timeout->setInterval(SCAN_TIMEOUT_MSEC);
+  connect(timeout, SIGNAL(timeout()), this, SLOT(scanTimeout()) );
+}
+
+WifiScanner::~WifiScanner(){
+  if(proc->state() != QProcess::NotRunning){
+    proc->kill();
+    proc->waitForFinished(1000);
+  }
+  if(SCANNERS.value(dev) == this){ SCANNERS.remove(dev); }
+}
+
+//=========
+//    PUBLIC
+//=========
+QString WifiScanner::device() const{
+  return dev;
+}
+
+QList<WifiAccessPoint> WifiScanner::accessPoints(bool unique) const{
+  QList<WifiAccessPoint> out = aps.values();
+  qStableSort(out.begin(), out.end(), strongerThan);
+  if(!unique){ return out; }
+  QSet<QString> ssids;
+  for(int i=0; i<out.length(); i++){
+    if(ssids.contains(out[i].ssid)){ out.removeAt(i); i--; }
+    else{ ssids.insert(out[i].ssid); }
+  }
+  return out;
+}
+
+bool WifiScanner::accessPoint(QString ssid, WifiAccessPoint *out) const{
+  bool found = false;
+  QHash<QString, WifiAccessPoint>::const_iterator it;
+  for(it = aps.constBegin(); it != aps.constEnd(); ++it){
+    if(it.value().ssid != ssid){ continue; }
+    if(!found || it.value().strength > out->strength){ *out = it.value(); }
+    found = true;
+  }
+  return found;
+}
+
+QDateTime WifiScanner::lastScan() const{
+  return last;
+}
+
+bool WifiScanner::isScanning() const{
+  return (proc->state() != QProcess::NotRunning);
+}
+
+QList<WifiAccessPoint> WifiScanner::parseScan(QStringList lines, bool verbose){
+  QList<WifiAccessPoint> out;
+  for(int i=1; i<lines.length(); i++){ //skip the header line
+    if(lines[i].trimmed().isEmpty()){ continue; }
+    QStringList info = NetworkInterface::parseWifiScanLine(lines[i], verbose);
+    WifiAccessPoint ap;
+    ap.ssid = info[0];
+    ap.bssid = info[1];
+    ap.channel = info[2];
+    ap.rate = info[3];
+    ap.strength = info[4].section("%",0,0).toInt();
+    ap.security = info[6];
+    if(ap.bssid.isEmpty()){ continue; }
+    out << ap;
+  }
+  return out;
+}
+
+//=============
+//  PUBLIC SLOTS
+//=============
+void WifiScanner::scan(bool bringUp){
+  if(isScanning()){ return; } //the running scan will report to everyone
+  QStringList args;
+  args << "-v" << dev;
+  if(bringUp){ args << "up"; }
+  args << "list" << "scan";
+  timeout->start();
+  proc->start("/sbin/ifconfig", args);
+}
+
+//==========
+//    PRIVATE
+//==========
+void WifiScanner::procFinished(){
+  timeout->stop();
+  if(proc->exitStatus() != QProcess::NormalExit){ emit scanFinished(false); return; } //killed - keep the cached results
+  QStringList lines = QString(proc->readAllStandardOutput()).split("\n");
+  QList<WifiAccessPoint> found = parseScan(lines, true);
+  QDateTime now = QDateTime::currentDateTime();
+  bool changed = false;
+  for(int i=0; i<found.length(); i++){
+    WifiAccessPoint ap = found[i];
+    ap.lastSeen = now;
+    if(aps.contains(ap.bssid)){
+      const WifiAccessPoint &old = aps[ap.bssid];
+      if(old.ssid != ap.ssid || old.security != ap.security || old.strength != ap.strength || old.rate != ap.rate){ changed = true; }
+      ap.history = old.history;
+      ap.history << old.strength;
+      while(ap.history.length() > HISTORY_SIZE){ ap.history.removeFirst(); }
+    }else{
+      changed = true;
+    }
+    aps.insert(ap.bssid, ap);
+  }
+  //Drop the access points which have not been seen for a while
+  QHash<QString, WifiAccessPoint>::iterator it = aps.begin();
+  while(it != aps.end()){
+    if(it.value().lastSeen.secsTo(now) > EXPIRE_SECS){ it = aps.erase(it); changed = true; }
+    else{ ++it; }
+  }
+  last = now;
+  emit scanFinished(changed);
+}
+
+void WifiScanner::procError(QProcess::ProcessError err){
+  //finished() is never emitted if ifconfig could not be started, report an empty (unchanged) scan instead
+  if(err == QProcess::FailedToStart){ timeout->stop(); emit scanFinished(false); }
+}
+
+void WifiScanner::scanTimeout(){
+  //finished() follows the kill and reports the failed scan
+  if(isScanning()){ proc->kill(); }
+}
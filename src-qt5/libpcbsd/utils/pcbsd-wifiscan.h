@@ -0,0 +1,70 @@
+#ifndef _PCBSD_WIFISCAN_H_
+#define _PCBSD_WIFISCAN_H_
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+// One access point seen in the output of "ifconfig -v <dev> list scan"
+struct WifiAccessPoint
+{
+   WifiAccessPoint() : strength(0) {;}
+
+   QString ssid, bssid, channel, rate, security;
+   int strength; //signal strength in percent
+   QList<int> history; //earlier strength readings, oldest first
+   QDateTime lastSeen;
+};
+
+// Runs the wifi scan for a device in the background and keeps the access points
+// it has seen (by BSSID), so the last results can be shown right away while a
+// new scan is running
+class WifiScanner : public QObject
+{
+   Q_OBJECT
+
+public:
+   //Scanner shared by everything in this process which uses the device
+   static WifiScanner* forDevice(QString device);
+
+   WifiScanner(QString device, QObject *parent = 0);
+   ~WifiScanner();
+
+   QString device() const;
+   //Cached access points, strongest first (only the strongest BSSID of each SSID if "unique")
+   QList<WifiAccessPoint> accessPoints(bool unique = false) const;
+   //Strongest access point for the SSID (returns false if it has not been seen)
+   bool accessPoint(QString ssid, WifiAccessPoint *out) const;
+   QDateTime lastScan() const;
+   bool isScanning() const;
+
+   //Parse the output of "ifconfig [-v] <dev> list scan" (including the header line)
+   static QList<WifiAccessPoint> parseScan(QStringList lines, bool verbose);
+
+public slots:
+   //Start a new scan unless one is already running ("bringUp" also marks the device up first)
+   void scan(bool bringUp = false);
+
+private:
+   QString dev;
+   QProcess *proc;
+   QTimer *timeout; //kills a scan which hangs
+   QHash<QString, WifiAccessPoint> aps; //BSSID -> access point
+   QDateTime last;
+
+private slots:
+   void procFinished();
+   void procError(QProcess::ProcessError);
+   void scanTimeout();
+
+signals:
+   //A scan completed, "changed" is false if the cached results are identical to before
+   void scanFinished(bool changed);
+};
+
+#endif
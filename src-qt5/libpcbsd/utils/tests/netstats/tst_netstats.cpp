@@ -0,0 +1,120 @@
+#include <QtTest>
+#include <QFile>
+#include <QMap>
+#include <QTextStream>
+
+#include "pcbsd-netif.h"
+
+// Replays recorded interface counters through NetworkStatistics::update()
+class tst_NetStats : public QObject
+{
+   Q_OBJECT
+
+private:
+   //Recorded samples: <msecs, counters read at that time>
+   QMap<qint64, QList<NetworkInterfaceStats> > samples;
+
+private slots:
+   void initTestCase();
+   void firstSample();
+   void deltasAndRates();
+   void counterReset();
+};
+
+void tst_NetStats::initTestCase()
+{
+   QFile file(QFINDTESTDATA("netstat-ibn.txt"));
+   QVERIFY( file.open(QIODevice::ReadOnly | QIODevice::Text) );
+   QTextStream in(&file);
+   while ( !in.atEnd() )
+   {
+      QString line = in.readLine().simplified();
+      if ( line.isEmpty() || line.startsWith("#") )
+         continue;
+      QStringList cols = line.split(" ");
+      QCOMPARE( cols.length(), 8 );
+      NetworkInterfaceStats st;
+      st.name = cols[1];
+      st.packetsRx = cols[2].toULongLong();
+      st.errorsRx = cols[3].toULongLong();
+      st.bytesRx = cols[4].toULongLong();
+      st.packetsTx = cols[5].toULongLong();
+      st.errorsTx = cols[6].toULongLong();
+      st.bytesTx = cols[7].toULongLong();
+      samples[cols[0].toLongLong()] << st;
+   }
+   QCOMPARE( samples.count(), 3 );
+}
+
+void tst_NetStats::firstSample()
+{
+   NetworkStatistics stats;
+   stats.update(samples[0], 0);
+   QCOMPARE( stats.interfaces(), QStringList() << "em0" << "lo0" );
+   NetworkInterfaceStats em0 = stats.stats("em0");
+   QCOMPARE( em0.packetsRx, quint64(1000) );
+   QCOMPARE( em0.bytesTx, quint64(120000) );
+   //Nothing to compare against yet
+   QCOMPARE( em0.packetsRxDelta, quint64(0) );
+   QCOMPARE( em0.bytesRxRate, 0.0 );
+   QVERIFY( !stats.contains("wlan0") );
+}
+
+void tst_NetStats::deltasAndRates()
+{
+   NetworkStatistics stats;
+   stats.update(samples[0], 0);
+   stats.update(samples[2000], 2000);
+   QCOMPARE( stats.interfaces(), QStringList() << "em0" << "lo0" << "wlan0" );
+
+   NetworkInterfaceStats em0 = stats.stats("em0");
+   QCOMPARE( em0.packetsRxDelta, quint64(400) );
+   QCOMPARE( em0.packetsTxDelta, quint64(200) );
+   QCOMPARE( em0.errorsRxDelta, quint64(1) );
+   QCOMPARE( em0.errorsTxDelta, quint64(0) );
+   QCOMPARE( em0.bytesRxDelta, quint64(600000) );
+   QCOMPARE( em0.bytesTxDelta, quint64(30000) );
+   QCOMPARE( em0.packetsRxRate, 200.0 );
+   QCOMPARE( em0.packetsTxRate, 100.0 );
+   QCOMPARE( em0.bytesRxRate, 300000.0 );
+   QCOMPARE( em0.bytesTxRate, 15000.0 );
+
+   NetworkInterfaceStats lo0 = stats.stats("lo0");
+   QCOMPARE( lo0.packetsRxDelta, quint64(0) );
+   QCOMPARE( lo0.bytesRxRate, 0.0 );
+
+   //Appeared in this sample: counters but no deltas
+   NetworkInterfaceStats wlan0 = stats.stats("wlan0");
+   QCOMPARE( wlan0.packetsRx, quint64(10) );
+   QCOMPARE( wlan0.packetsRxDelta, quint64(0) );
+   QCOMPARE( wlan0.bytesRxRate, 0.0 );
+}
+
+void tst_NetStats::counterReset()
+{
+   NetworkStatistics stats;
+   stats.update(samples[0], 0);
+   stats.update(samples[2000], 2000);
+   stats.update(samples[4000], 4000);
+   QCOMPARE( stats.interfaces(), QStringList() << "em0" << "wlan0" );
+   QVERIFY( !stats.contains("lo0") );
+   QCOMPARE( stats.stats("lo0").packetsRx, quint64(0) );
+
+   //em0 went back to zero in between, the new value is the traffic since then
+   NetworkInterfaceStats em0 = stats.stats("em0");
+   QCOMPARE( em0.packetsRxDelta, quint64(200) );
+   QCOMPARE( em0.bytesRxDelta, quint64(300000) );
+   QCOMPARE( em0.bytesRxRate, 150000.0 );
+
+   NetworkInterfaceStats wlan0 = stats.stats("wlan0");
+   QCOMPARE( wlan0.packetsRxDelta, quint64(20) );
+   QCOMPARE( wlan0.packetsTxDelta, quint64(20) );
+   QCOMPARE( wlan0.packetsRxRate, 10.0 );
+   QCOMPARE( wlan0.bytesTxRate, 1000.0 );
+
+   QCOMPARE( stats.allStats().length(), 2 );
+   QCOMPARE( stats.allStats()[0].name, QString("em0") );
+}
+
+QTEST_MAIN(tst_NetStats)
+#include "tst_netstats.moc"
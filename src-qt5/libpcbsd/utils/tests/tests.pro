@@ -0,0 +1,5 @@
+# Unit tests for libpcbsd-utils (run with "qmake && make check" after building the library)
+TEMPLATE = subdirs
+
+SUBDIRS += netstats \
+	wifiscan
@@ -0,0 +1,76 @@
+#include <QtTest>
+#include <QFile>
+
+#include "pcbsd-wifiscan.h"
+
+// Feeds recorded "ifconfig -v wlan0 list scan" output to WifiScanner::parseScan()
+class tst_WifiScan : public QObject
+{
+   Q_OBJECT
+
+private slots:
+   void parseRecorded();
+   void parseEmpty();
+};
+
+void tst_WifiScan::parseRecorded()
+{
+   QFile file(QFINDTESTDATA("ifconfig-list-scan.txt"));
+   QVERIFY( file.open(QIODevice::ReadOnly | QIODevice::Text) );
+   QStringList lines = QString(file.readAll()).split("\n");
+   QList<WifiAccessPoint> aps = WifiScanner::parseScan(lines, true);
+   //Header and blank lines are skipped, everything else is kept in order
+   QCOMPARE( aps.length(), 6 );
+
+   QCOMPARE( aps[0].ssid, QString("HomeNet") );
+   QCOMPARE( aps[0].bssid, QString("00:11:22:33:44:55") );
+   QCOMPARE( aps[0].channel, QString("6") );
+   QCOMPARE( aps[0].rate, QString("54M") );
+   QCOMPARE( aps[0].strength, 60 );
+   QCOMPARE( aps[0].security, QString("WPA2") );
+
+   //SSIDs with spaces stay in one piece
+   QCOMPARE( aps[1].ssid, QString("Coffee Shop Guest") );
+   QCOMPARE( aps[1].channel, QString("11") );
+   QCOMPARE( aps[1].strength, 40 );
+   QCOMPARE( aps[1].security, QString("None") );
+
+   QCOMPARE( aps[2].ssid, QString("OldRouter") );
+   QCOMPARE( aps[2].rate, QString("11M") );
+   QCOMPARE( aps[2].strength, 20 );
+   QCOMPARE( aps[2].security, QString("WEP") );
+
+   //Only fits in the wide (verbose) SSID column
+   QCOMPARE( aps[3].ssid, QString("A Very Long Network Name Of 32Ch") );
+   QCOMPARE( aps[3].bssid, QString("00:24:a5:10:20:30") );
+   QCOMPARE( aps[3].strength, 84 );
+   QCOMPARE( aps[3].security, QString("WPA") );
+
+   //Hidden network
+   QCOMPARE( aps[4].ssid, QString() );
+   QCOMPARE( aps[4].bssid, QString("11:22:33:44:55:66") );
+   QCOMPARE( aps[4].strength, 52 );
+
+   //Second BSSID of the same network, strength is capped at 100%
+   QCOMPARE( aps[5].ssid, QString("HomeNet") );
+   QCOMPARE( aps[5].bssid, QString("00:11:22:33:44:77") );
+   QCOMPARE( aps[5].channel, QString("44") );
+   QCOMPARE( aps[5].strength, 100 );
+
+   for (int i = 0; i < aps.length(); i++)
+   {
+      QVERIFY( aps[i].history.isEmpty() );
+      QVERIFY( !aps[i].lastSeen.isValid() );
+   }
+}
+
+void tst_WifiScan::parseEmpty()
+{
+   //Nothing in range, or ifconfig printed nothing at all
+   QCOMPARE( WifiScanner::parseScan(QStringList() << "SSID/MESH ID                      BSSID              CHAN RATE    S:N     INT CAPS" << "", true).length(), 0 );
+   QCOMPARE( WifiScanner::parseScan(QStringList(), true).length(), 0 );
+   QCOMPARE( WifiScanner::parseScan(QStringList() << "", true).length(), 0 );
+}
+
+QTEST_MAIN(tst_WifiScan)
+#include "tst_wifiscan.moc"
@@ -0,0 +1,15 @@
+QT       += core testlib
+QT       -= gui
+CONFIG   += testcase console
+
+TARGET = tst_wifiscan
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+LIBS += -L$$_PRO_FILE_PWD_/../../.. -L/usr/local/lib -lpcbsd-utils
+QMAKE_RPATHDIR += $$_PRO_FILE_PWD_/../../..
+QMAKE_LIBDIR = /usr/local/lib/qt5 /usr/local/lib
+
+SOURCES += tst_wifiscan.cpp
+
+OTHER_FILES += ifconfig-list-scan.txt
@@ -39,6 +39,8 @@
 
 #include "pcbsd-netif.h"
 #include "pcbsd-utils.h"
+#include "pcbsd-conffile.h"
+#include "pcbsd-deinfo.h"
 
 
 #include "../../config.h"
@@ -114,20 +116,11 @@ QString Utils::getValFromPCBSDConf(QString key) {
 QString Utils::getValFromPCConf(QString conf, QString key) {
   
   // Load from conf the requested key
-  QFile confFile(conf);
-  if ( confFile.open( QIODevice::ReadOnly ) ) {
-        QTextStream stream( &confFile );
-        stream.setCodec("UTF-8");
-        QString line;
-        while ( !stream.atEnd() ) {
-            line = stream.readLine().simplified();
-	    if ( line.indexOf(key + ": ") == 0 ) {
-   		confFile.close();
-		return line.replace(key + ": ", "");
-	    }
-
-        }
-   confFile.close();
+  QStringList lines = ConfFileCache::lines(conf);
+  for ( int i = 0; i < lines.length(); i++ ) {
+      QString line = lines[i].simplified();
+      if ( line.indexOf(key + ": ") == 0 )
+	return line.replace(key + ": ", "");
   }
 
   return QString();
@@ -405,64 +398,21 @@ QString Utils::getConfFileValue( QString oFile, QString Key )
 
 QString Utils::getConfFileValue( QString oFile, QString Key, int occur )
 {
-	int found = 1;
-    
-    	QFile file( oFile );
-    	if ( ! file.open( QIODevice::ReadOnly ) ) {
-		return QString();
-	}
-
-       	QTextStream stream( &file );
-       	QString line;
-       	while ( !stream.atEnd() ) {
-            	line = stream.readLine(); // line of text excluding '\n'
-		line = line.section("#",0,0).trimmed(); //remove any comments
-		if(line.isEmpty()){ continue; }
-		int index = line.indexOf(Key, 0);
-                //qDebug() << "Line:" << line << index;
-                // If the KEY is not found at the start of the line, continue processing 
-		if(index!=0)
-			continue;
-		
-	    	if ( found == occur) {
- 			line.remove(line.indexOf(Key, 0), Key.length());
-    
-    			// Remove any quotes
-   			if ( line.indexOf('"') == 0 )
-				line = line.remove(0, 1);
-    
-    			if ( line.indexOf('"') != -1  )
-				line.truncate(line.indexOf('"'));
-
-			file.close();
-			
-    			return line;
-    		} else {
-       			found++;  
-    		}
-        }
-
-	file.close();
-	return QString();
+	// Served from the parsed copy of the file, which is re-read only when it changes
+	return ConfFileCache::value(oFile, Key, occur);
 }
 
 QString Utils::getConfFileValue( QString oFile, QString Key, QString ValRx, int occur )
 {
 	int found = 1;
-    
-    	QFile file( oFile );
-    	if ( ! file.open( QIODevice::ReadOnly ) ) {
-		return QString();
-	}
 
 	QString rxStr ( Key );
 	rxStr.append( ValRx );
 	QRegExp rx(rxStr);
-       	QTextStream stream( &file );
-       	QString line;
-       	while ( !stream.atEnd() ) {
-            	line = stream.readLine(); // line of text excluding '\n'
-            
+	QStringList lines = ConfFileCache::lines(oFile);
+	for ( int i = 0; i < lines.length(); i++ ) {
+		QString line = lines[i];
+
                 // If the KEY is not found in the line, continue processing 
 		if ( line.trimmed().indexOf("#", 0) == 0 || line.indexOf(rx, 0) == -1 || line.indexOf(rx, 0) > 0)
 			continue;
@@ -477,14 +427,12 @@ QString Utils::getConfFileValue( QString oFile, QString Key, QString ValRx, int
     			if ( line.indexOf('"') != -1  )
 				line.truncate(line.indexOf('"'));
 
-			file.close();
     			return line;
     		} else {
        			found++;  
     		}
         }
 
-	file.close();
 	return QString();
 }
 
@@ -498,88 +446,10 @@ bool Utils::setConfFileValue( QString oFile, QString oldKey, QString newKey, int
     	// Lets the dev save a value into a specified config file. 
 	// The occur value tells which occurance of "oldKey" to replace
     	// If occur is set to -1, it will remove any duplicates of "oldKey"
-    
-	//copy the original file to create a temporary file for editing
-	QString oFileTmp = oFile + ".tmp";
-	QString cmd = "cp "+oFile+" "+oFileTmp;
-	runShellCommand(cmd);
-	
-	//Continue evaluating the temporary file
-    	QStringList SavedFile;
-    	int found = 1;
-
-    	// Load the old file, find the oldKey, remove it and replace with newKey
-    	QFile file( oFileTmp );
-	if ( ! file.open( QIODevice::ReadOnly ) )
-		return false;
-
-        QTextStream stream( &file );
-        QString line;
-        while ( !stream.atEnd() ) {
-        	line = stream.readLine(); // line of text excluding '\n'
-            
-		// Key is not found at all
-		if ( line.indexOf(oldKey, 0) == -1 ) {
-	        	SavedFile << line ;
-			continue;
-		}
-
-		// Found the key, but it is commented out, so don't worry about this line
-		if ( line.trimmed().indexOf("#", 0) == 0 ) {
-	         	SavedFile << line ;
-			continue;
-		}
-
-		// If the KEY is found, and we are just on wrong occurance, save it and continue to search  
-		if ( occur != -1 && found != occur ) {
-	         	SavedFile << line ;
-			found++;
-			continue;
-		}
-
-            	// If the KEY is found in the line and this matches the occurance that must be processed
-            	if ( ! newKey.isEmpty() && found == occur )
-           	{
-	         	SavedFile << newKey ;
-			newKey.clear();
-	    		found++;
-			continue;
-            	} 
-
-             	// If the KEY is found and we just want one occurance of the key
-            	if ( occur == -1 && ! newKey.isEmpty() ) {
-	         	SavedFile << newKey ;
-			newKey.clear();
-			found++;	
-			continue;
-		}
-
-        }
-
-   	file.close();
-
-	// Didn't find the key? Write it!
-	if ( ! newKey.isEmpty() )
-	    SavedFile << newKey;
-	
-    
-    	// Save the new file
-    	QFile fileout( oFileTmp );
-    	if ( ! fileout.open( QIODevice::WriteOnly ) )
-		return false;
-
-  	QTextStream streamout( &fileout );
-	for (int i = 0; i < SavedFile.size(); ++i)
-          	streamout << SavedFile.at(i) << "\n";
-
-       	fileout.close();
-
-	//Have the temporary file with new changes overwrite the original file
-	cmd = "mv "+oFileTmp+" "+oFile;
-	runShellCommand(cmd);	
-	
-	return true;
-    
+	// Use ConfFileBatch directly to change several keys with a single rewrite
+	ConfFileBatch batch(oFile);
+	batch.setValue(oldKey, newKey, occur);
+	return batch.commit();
 }
 
 QStringList Utils::runShellCommand( QString command ){
@@ -730,35 +600,18 @@ void Utils::restartNetworking()
 
 void Utils::runInTerminal(QString command, QString windowTitle)
 {
-    QStringList out = Utils::runShellCommand("de-info");
+    DesktopEnvironmentInfo de = DEInfoCache::current();
     QString terminal_app="xterm";
     QString terminal_title="-T";
     QString terminal_comm="-e";
     bool separateArgs=false;
-
-    for(int i=0; i<out.size(); i++)
+    if (de.Name.length())
     {
-        QString str = out.at(i).trimmed();        
-        if (str.indexOf("Terminal:")>=0)
-        {
-            terminal_app = str.replace("Terminal:","");
-            continue;
-        }
-        if(str.indexOf("Terminal title switch:")>=0)
-        {
-            terminal_title = str.replace("Terminal title switch:","");
-            continue;
-        }
-        if (str.indexOf("Terminal command switch:")>=0)
-        {
-            terminal_comm = str.replace("Terminal command switch:","");
-            continue;
-        }
-        if (str.indexOf("Terminal command separate args:")>=0)
-        {
-            separateArgs = (str.replace("Terminal command separate args:","").trimmed() == QString("YES"));
-        }
-    }//for all strings
+        terminal_app = de.TerminalCommand;
+        terminal_title = de.TerminalTitleKey;
+        terminal_comm = de.TerminalCommandKey;
+        separateArgs = de.isTerminalNeedParamsSplit;
+    }
     if (!terminal_app.length())
         return;    
 
@@ -784,7 +637,9 @@ void Utils::runInTerminal(QString command, QString windowTitle)
 void Utils::openInFileManager(QString location)
 {
     //TODO: Process quotes for location
-    QString exec = Utils::runShellCommand("de-info -fileman").at(0);
+    QString exec = DEInfoCache::current().FileManager;
+    if (exec.isEmpty())
+        return;
     exec = exec.replace("%s", location);
     QProcess::startDetached(exec);
 }
@@ -860,90 +715,14 @@ bool Utils::validateIPV4( QString IP )
   return true;
 }
 
-#define TRY_GET_VALUE_STR(val_name, field)\
-if (Str.contains(val_name)){\
-                            Entry.field = Str.replace(val_name,"").trimmed();\
-                                          continue;}\
-
-#define TRY_GET_VALUE_BOOL(val_name, field, true_val)\
-if (Str.contains(val_name)){\
-                            Entry.field = Str.replace(val_name,"").trimmed().toLower() == QString(true_val).toLower();\
-                                          continue;}\
-
-
-static int de_info(bool isCurrent, QVector<DesktopEnvironmentInfo>& retVal)
-{
-    static const char* const DE_NAME = "DE name:";
-    static const char* const DE_ACTIVE = "Current DE:";
-    static const char* const DE_XDG = "XDG compatible:";
-    static const char* const DE_INSTALLED = "Installed:";
-    static const char* const DE_SUDO = "Sudo command:";
-    static const char* const DE_FILE_MANAGER = "File manager:";
-    static const char* const DE_TERMINAL = "Terminal:";
-    static const char* const DE_CONFIG_APP = "Configuration app:";
-
-    retVal.clear();
-
-    QStringList flags;
-    if (!isCurrent)
-        flags<<"-i";
-
-    QProcess* deinfo = new QProcess();
-    deinfo->setProcessChannelMode(QProcess::MergedChannels);
-    deinfo->start(QString("/usr/local/bin/de-info"), flags);
-    deinfo->waitForFinished(-1);
-    DesktopEnvironmentInfo Entry;
-    QString Str;
-
-    while ( deinfo->canReadLine() )
-    {
-        Str = deinfo->readLine().simplified();
-        if (Str.contains(DE_NAME))
-        {
-            if (Entry.Name.length())
-            {
-                retVal.push_back(Entry);
-                Entry = DesktopEnvironmentInfo();
-            }
-            Entry.Name = Str.replace(DE_NAME,"").trimmed();
-            continue;
-        }//if found 'DE name'
-
-        TRY_GET_VALUE_BOOL(DE_ACTIVE, isActive, "yes");
-        TRY_GET_VALUE_BOOL(DE_INSTALLED, isInstalled, "yes");
-        TRY_GET_VALUE_BOOL(DE_XDG, isXDG, "yes");
-        TRY_GET_VALUE_STR(DE_SUDO, SudoCommand);
-        TRY_GET_VALUE_STR(DE_FILE_MANAGER, FileManager);
-        TRY_GET_VALUE_STR(DE_TERMINAL, TerminalCommand);
-        TRY_GET_VALUE_STR(DE_CONFIG_APP, ConfigurationApplication);
-        //TODO: another fields
-    }//while process output reading
-
-    if (Entry.Name.length())
-        retVal.push_back(Entry);
-
-    return retVal.size();
-}
-
-
-#undef TRY_GET_VALUE_STR
-#undef TRY_GET_VALUE_BOOL
-
 QVector<DesktopEnvironmentInfo> Utils::installedDesktops()
 {
-    QVector<DesktopEnvironmentInfo> retVal;
-    de_info(false, retVal);
-    return retVal;
+    return DEInfoCache::installed();
 }
 
 DesktopEnvironmentInfo Utils::currentDesktop()
 {
-    QVector<DesktopEnvironmentInfo> script_result;
-    if (de_info(true, script_result) != 0)
-    {
-        return script_result[0];
-    }
-    return DesktopEnvironmentInfo();
+    return DEInfoCache::current();
 }
 
 bool Utils::canLogout()
@@ -12,18 +12,26 @@ VERSION		= 0.9.9
 
 HEADERS	+= pcbsd-netif.h \
 	pcbsd-utils.h \
+	pcbsd-conffile.h \
+	pcbsd-deinfo.h \
         pcbsd-hardware.h \
 	pcbsd-DLProcess.h \
+	pcbsd-logfollower.h \
 	pcbsd-sysFlags.h \
+	pcbsd-wifiscan.h \
 	pcbsd-xdgfile.h \
 	pcbsd-xdgutils.h \
     keyboardsettings.h
 
 SOURCES	+= utils.cpp \
+	pcbsd-conffile.cpp \
+	pcbsd-deinfo.cpp \
         hardware.cpp \
         netif.cpp \
 	pcbsd-DLProcess.cpp \
+	pcbsd-logfollower.cpp \
 	pcbsd-sysFlags.cpp \
+	pcbsd-wifiscan.cpp \
 	pcbsd-xdgfile.cpp \
 	pcbsd-xdgutils.cpp \
     keyboardsettings.cpp
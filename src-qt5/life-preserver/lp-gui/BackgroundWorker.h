@@ -3,9 +3,11 @@
 
 #include <QObject>
 #include <QApplication>
+#include <QDir>
 
 #include "LPContainers.h"
 #include "LPGUtils.h"
+#include "LPFileVersions.h"
 
 
 class BackgroundWorker : public QObject{
@@ -15,20 +17,38 @@ public:
 	~BackgroundWorker(){}
 
 signals:
-	void SnapshotsLoaded();
+	void SnapshotsLoaded(LPDataset);
+	void PoolStateLoaded(LPPoolState);
+	void FileVersionsLoaded(QString, QString); //mountpoint, relative path
 
 public slots:
 	//Kickoff processes with these slots
         // and then listen for the appropriate signals when finished
-	void loadSnapshotInfo(LPDataset* DS){
+	void loadSnapshotInfo(LPDataset DS){
+	  //DS is a private copy - the GUI keeps using its own until the results come back
 	  static bool running = false;
 	  if(running){ return; }
 	  running = true;
-	  LPGUtils::loadSnapshotInfo(DS);
-	  emit SnapshotsLoaded();
+	  LPGUtils::loadSnapshotInfo(&DS);
+	  emit SnapshotsLoaded(DS);
 	  QApplication::processEvents();
 	  running = false;
 	}
+
+	void loadPoolState(){
+	  //All the external commands for a refresh are run here (not in the GUI thread)
+	  LPPoolState state;
+	  state.pools = LPBackend::listDatasets();
+	  state.poolsAvail = LPBackend::listPossibleDatasets();
+	  state.users = QDir("/usr/home").entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+	  state.sample = LPGUtils::loadPoolData(state.pools);
+	  emit PoolStateLoaded(state);
+	}
+
+	void loadFileVersions(QString mountpoint, QString relpath, QStringList snaps){
+	  LPFileVersions::versions(mountpoint, relpath, snaps); //results are cached for the GUI
+	  emit FileVersionsLoaded(mountpoint, relpath);
+	}
 	
 };
 
@@ -6,18 +6,10 @@
 //====PUBLIC=====
 LPClassic::LPClassic(QWidget *parent) : QDialog(parent), ui(new Ui::LPClassic){
   ui->setupUi(this); //load the designer file
-  //initialize the file check timer
-  fCheck = new QTimer(this);
-    fCheck->setInterval(2000); //2 second update interval
-    fCheck->setSingleShot(true);
-    connect(fCheck, SIGNAL(timeout()), this, SLOT(updateFCheck()) );
-  //initialize the tar process
-  tarProc = new QProcess(this);
-    tarProc->setProcessEnvironment( QProcessEnvironment::systemEnvironment());
-    connect(tarProc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(slotTarDone()) );
-  //initialize the QFileInfo
-  tarInfo = new QFileInfo();
-	tarInfo->setCaching(false);
+  //initialize the packaging process
+  packager = new LPHomePackager(this);
+    connect(packager, SIGNAL(progress(qint64, qint64, int, int)), this, SLOT(slotTarProgress(qint64, qint64, int, int)) );
+    connect(packager, SIGNAL(finished(bool)), this, SLOT(slotTarDone(bool)) );
   //set the initial stopped flag
   stopped = false;
   running = false;
@@ -36,45 +28,43 @@ void LPClassic::setHomeDir(QString home){
   tarBaseDir = home;
 	tarBaseDir.chop(tarDir.length() +1);
   ui->line_filename->setText(tarDir+"-"+QDateTime::currentDateTime().toString("yyyyMMdd-hhmm"));
-  //Now set the process to start in the parent directory
-  tarProc->setWorkingDirectory(tarBaseDir);
   //Now make sure we start on the right page
   ui->stackedWidget->setCurrentWidget(ui->page_setup);
 }
 
 //====PRIVATE====
-void LPClassic::updateFCheck(){
-  //Get the current size of the file
-  tarInfo->refresh();
-  double size = tarInfo->size();
-  QStringList labels; labels << "B" << "KB" << "MB" << "GB" << "TB" << "PB" << "EB";
-  int i=0;
-  while( size > 1024 && i < labels.length() ){
-    size = size/1024; 
-    i++;
+void LPClassic::slotTarProgress(qint64 bytes, qint64 total, int files, int secsLeft){
+  if(stopped){ return; }
+  if(total <= 0){
+    //Still calculating the size of the directory (or unknown)
+    ui->progressBar->setRange(0,0);
+    ui->label_size->setText( LPHomePackager::sizeText(bytes) );
+  }else{
+    ui->progressBar->setRange(0,1000);
+    ui->progressBar->setValue( qMin(qint64(1000), bytes*1000/total) );
+    ui->label_size->setText( QString(tr("%1 of %2")).arg(LPHomePackager::sizeText(bytes), LPHomePackager::sizeText(total)) );
+  }
+  QString status = tr("Packaging Home Directory...");
+  if(files > 0){
+    status.append("\n"+QString(tr("%1 files")).arg(QString::number(files)) );
+    if(secsLeft >= 0){ status.append(", "+QString(tr("%1 remaining")).arg(LPHomePackager::timeText(secsLeft)) ); }
   }
-  //Round to 2 decimel places if GB or larger
-  if(i>2){ size = int(size*100)/100.0; }
-  else{ size = int(size); }
-  //Now display that size
-  ui->label_size->setText( QString::number(size)+" "+labels[i] );
-  if(!stopped){ fCheck->start(); }
+  ui->label_status->setText(status);
 }
 
-void LPClassic::slotTarDone(){
+void LPClassic::slotTarDone(bool ok){
   running = false;
-  fCheck->stop();
-  updateFCheck(); //Final update for the file size
   if(stopped){
     qDebug() << "Home-Dir Package Cancelled";
     ui->label_status->setText(tr("Cancelled"));
-    //Now try to delete the partial file
-    QString file = tarBaseDir+"/"+tarFile;
-    qDebug() << " - Removing partial archive file:" << file;
-    QFile::remove(file);
+  }else if(!ok){
+    qDebug() << "Home-Dir Package Failed:" << packager->errors();
+    ui->label_status->setText(tr("FAILED"));
   }else{
     qDebug() << "Home-Dir Package Finished";
     ui->label_status->setText(tr("FINISHED"));
+    QFileInfo info(tarBaseDir+"/"+tarFile);
+    ui->label_size->setText( LPHomePackager::sizeText(info.size()) ); //final size of the archive
   }
   ui->push_stop->setVisible(false);
   ui->push_finished->setVisible(true);
@@ -138,10 +128,6 @@ void LPClassic::on_push_start_clicked(){
   stopped = false;
   running = true;
   tarFile = ui->line_filename->text()+".home.tar.gz";
-  tarInfo->setFile(tarBaseDir+"/"+tarFile);
-  //Generate the command
-  QStringList args;
-  args << "-czf" << tarBaseDir+"/"+tarFile << "-C" << tarBaseDir << tarDir;
   //Create the exclude list
   QStringList excludes;
     excludes << "*flashplayer*"; //Always exclude the flashplayer library
@@ -155,16 +141,8 @@ void LPClassic::on_push_start_clicked(){
     if(path.endsWith("/")){ path.append("*"); } //don't put the asterisk on the end of files
     excludes << "*"+path;
   }
-  //Now convert the exclude list into additional arguments
-  for(int i=0; i<excludes.length(); i++){
-    args.prepend(excludes[i]); args.prepend("--exclude");
-  }
-  //qDebug() << "Package command:" << "tar" << args;
-  //Start the process
-  tarProc->start("tar",args); //complex command, use args individually
-  tarProc->waitForStarted(1000);
-  //Start the file watcher
-  fCheck->start();
+  //Start the packaging (the package header gets generated automatically)
+  packager->startPackage(tarBaseDir, tarDir, tarFile, excludes);
   //Now show the proper page with correct elements
   ui->label_fullfilename->setText(tarBaseDir+"/"+tarFile);
   ui->push_finished->setVisible(false);
@@ -177,12 +155,7 @@ void LPClassic::on_push_start_clicked(){
 
 void LPClassic::on_push_stop_clicked(){
   stopped = true;
-  tarProc->kill();
-  tarProc->waitForFinished(1000); //wait a second to let it die
-  if(tarProc->state() != QProcess::NotRunning){ 
-    tarProc->terminate(); //force kill it
-    tarProc->waitForFinished(300);
-  } 
+  packager->cancel(); //the partial archive gets removed once the processes are done
 }
 
 void LPClassic::on_push_finished_clicked(){
@@ -11,6 +11,8 @@
 #include <QDateTime>
 #include <QFileDialog>
 
+#include "LPHomePackager.h"
+
 namespace Ui{
 	class LPClassic;
 };
@@ -27,15 +29,13 @@ public:
 
 private:
 	Ui::LPClassic *ui;
-	QTimer *fCheck;
-	QProcess *tarProc;
+	LPHomePackager *packager;
 	QString tarBaseDir, tarDir, tarFile;
 	bool stopped;
-	QFileInfo *tarInfo;
 
 private slots:
-	void updateFCheck();
-	void slotTarDone();
+	void slotTarProgress(qint64, qint64, int, int);
+	void slotTarDone(bool);
 
 	//Exclude list controls
 	void on_tool_rmexclude_clicked();
@@ -4,6 +4,22 @@
 #include <QHash>
 #include <QStringList>
 #include <QString>
+#include <QMetaType>
+
+//Progress/result of the last scrub or resilver on a pool (the "scan:" section of "zpool status")
+class LPScanStatus{
+public:
+	enum ScanType{ None, Scrub, Resilver };
+	LPScanStatus(){ type = None; running = false; paused = false; cancelled = false; percent = -1; }
+	~LPScanStatus(){}
+
+	ScanType type;
+	bool running, paused, cancelled; //a paused scrub is still in progress ("running" is false)
+	double percent; //percent done while running/paused (-1 if unknown)
+	QString rate, eta; //scan rate ("50.2M/s") and time left ("0h30m") while running
+	QString timestamp; //start time while running, end time when finished
+	QString errors; //number of errors when finished
+};
 
 class LPDataset{
 public:
@@ -17,6 +33,7 @@ public:
 	QStringList harddisks;
 	QStringList harddiskStatus;
 	QString poolStatus;
+	LPScanStatus scan;
 	QStringList repHost;
 	QHash<QString,QStringList> subsetHash; //<subset, snapshot list> (complete dataset name should be <ds><subset>)
 	QHash<QString, QString> snapComment; //<snapshot, comment>
@@ -39,6 +56,20 @@ public:
 	  }
 	}
 };
+Q_DECLARE_METATYPE(LPDataset)
+
+//Pool lists and status loaded in the background, handed to the GUI as a whole (not changed afterwards)
+class LPPoolState{
+public:
+	LPPoolState(){}
+	~LPPoolState(){}
+
+	QStringList pools; //managed pools
+	QStringList poolsAvail; //all the pools on the system
+	QStringList users; //home directories available for packaging
+	QHash<QString, LPDataset> sample; //status of each managed pool
+};
+Q_DECLARE_METATYPE(LPPoolState)
 
 class LPRepHost : private QStringList{
 public:
@@ -0,0 +1,103 @@
+#include "LPFileVersions.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QVector>
+
+#define MAX_STAT_THREADS 8
+
+namespace{
+
+//Result of a stat() on the file within one snapshot
+struct SnapEntry{
+  SnapEntry(){ exists = false; size = 0; mtime = 0; inode = gen = 0; }
+  bool exists;
+  qint64 size, mtime;
+  quint64 inode, gen;
+};
+
+//<mountpoint>/<relpath> -> <snapshot -> stat result>
+QHash<QString, QHash<QString, SnapEntry> > CACHE;
+QMutex CACHELOCK;
+
+class StatTask : public QRunnable{
+public:
+  StatTask(QString file, SnapEntry *result){ path = file; out = result; }
+  void run(){
+    struct stat st;
+    if( 0 != ::lstat(QFile::encodeName(path).constData(), &st) ){ return; }
+    out->exists = true;
+    out->size = st.st_size;
+    out->mtime = st.st_mtime;
+    out->inode = st.st_ino;
+#ifdef __FreeBSD__
+    out->gen = st.st_gen;
+#endif
+  }
+private:
+  QString path;
+  SnapEntry *out;
+};
+
+} //end of anonymous namespace
+
+QList<LPFileVersion> LPFileVersions::versions(QString mountpoint, QString relpath, QStringList snaps){
+  if(relpath.startsWith("/")){ relpath.remove(0,1); }
+  QString key = mountpoint+"/"+relpath;
+  //Find the snapshots which have not been checked yet
+  QStringList missing;
+  QHash<QString, SnapEntry> known;
+  CACHELOCK.lock();
+  known = CACHE.value(key);
+  CACHELOCK.unlock();
+  for(int i=0; i<snaps.length(); i++){
+    if(!known.contains(snaps[i])){ missing << snaps[i]; }
+  }
+  if(!missing.isEmpty()){
+    QVector<SnapEntry> results(missing.length());
+    QThreadPool pool;
+    pool.setMaxThreadCount(MAX_STAT_THREADS);
+    for(int i=0; i<missing.length(); i++){
+      pool.start( new StatTask(mountpoint+"/.zfs/snapshot/"+missing[i]+"/"+relpath, &results[i]) );
+    }
+    pool.waitForDone();
+    for(int i=0; i<missing.length(); i++){ known.insert(missing[i], results[i]); }
+    QMutexLocker lock(&CACHELOCK);
+    QHash<QString, SnapEntry> &cached = CACHE[key];
+    for(int i=0; i<missing.length(); i++){ cached.insert(missing[i], results[i]); }
+  }
+  //Now merge the identical copies
+  QList<LPFileVersion> out;
+  QHash<QString, int> index; //version ID -> position in output
+  for(int i=0; i<snaps.length(); i++){
+    SnapEntry entry = known.value(snaps[i]);
+    if(!entry.exists){ continue; }
+    QString id = QString::number(entry.inode)+":"+QString::number(entry.gen)+":"+QString::number(entry.size)+":"+QString::number(entry.mtime);
+    if(index.contains(id)){
+      out[ index.value(id) ].snapshots << snaps[i];
+    }else{
+      LPFileVersion ver;
+      ver.snapshot = snaps[i];
+      ver.snapshots << snaps[i];
+      ver.size = entry.size;
+      ver.modified = QDateTime::fromTime_t(entry.mtime);
+      ver.inode = entry.inode;
+      ver.gen = entry.gen;
+      index.insert(id, out.length());
+      out << ver;
+    }
+  }
+  return out;
+}
+
+void LPFileVersions::clearCache(){
+  QMutexLocker lock(&CACHELOCK);
+  CACHE.clear();
+}
@@ -0,0 +1,32 @@
+#ifndef _LP_FILE_VERSIONS_H
+#define _LP_FILE_VERSIONS_H
+
+#include <QDateTime>
+#include <QStringList>
+#include <QString>
+
+//One distinct version of a file within the snapshots of a dataset
+class LPFileVersion{
+public:
+	LPFileVersion(){ size = -1; inode = gen = 0; }
+	~LPFileVersion(){}
+
+	QString snapshot; //oldest snapshot with this version
+	QStringList snapshots; //all the snapshots with this version (oldest -> newest)
+	qint64 size;
+	QDateTime modified;
+	quint64 inode, gen; //inode number/generation (same file object if both match)
+};
+
+//Lookup of the different versions of a file across the snapshots of a dataset
+// The snapshots are checked in parallel (each one is a separate automount), and since the contents
+// of a snapshot never change the results are cached: later lookups only check new snapshots.
+class LPFileVersions{
+public:
+	//Distinct versions of <mountpoint>/<relpath> within the given snapshots (oldest -> newest)
+	// Snapshots without the file are skipped, identical copies (same size/mtime/inode) are merged
+	static QList<LPFileVersion> versions(QString mountpoint, QString relpath, QStringList snaps);
+	static void clearCache();
+};
+
+#endif
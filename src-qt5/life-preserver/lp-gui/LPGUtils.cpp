@@ -2,90 +2,23 @@
 
 #include <unistd.h>
 
+#include <QMutex>
+#include <QMutexLocker>
+
+//Snapshot catalogs for each pool, kept between refreshes
+static QHash<QString, LPSnapshotCatalog> CATALOGS;
+static QMutex CATALOGLOCK;
+
 LPDataset LPGUtils::loadPoolData(QString zpool){
   //Load the current information for the given zpool
   qDebug() << "[DEBUG] New Dataset: " << zpool;
-  LPDataset DSC;
-	DSC.zpool = zpool;
+  return LPPoolSampler::sample(QStringList() << zpool).value(zpool);
+}
 
-  //Parse "zpool status <pool>"
-  qDebug() << "[DEBUG] get zpool status";
-  QStringList zstat = LPBackend::getCmdOutput("zpool status "+zpool);
-  qDebug() << zstat.join("\n");
-  //qDebug() << "zpool status "+zpool+":\n" << zstat.join("\n");
-  bool atheader=false;
-  QStringList disks, diskstates, running, errors, finished;
-  for(int i=0; i<zstat.length(); i++){
-    if(zstat[i].isEmpty()){ continue; }
-    else if(zstat[i].startsWith("  scan:")){
-      QString line = zstat[i].section(":",1,50).replace("\t"," ").simplified();
-      if(line.contains("scrub repaired ")){
-	QString timestamp = line.section(" ",9,13,QString::SectionSkipEmpty);
-	QString numerrors = line.section(" ",6,6,QString::SectionSkipEmpty);
-        finished << QString(QObject::tr("Scrub Finished: %1 (%2 errors)")).arg(timestamp, numerrors);
-      }else if(line.contains("scrub cancel")){
-	 QString timestamp = line.section(" ",3,7,QString::SectionSkipEmpty);     
-	  finished << QString(QObject::tr("Scrub Cancelled: %1")).arg(timestamp);
-      }else if(line.contains("scrub")){
-	QString timestamp = line.section(" ",4,8,QString::SectionSkipEmpty);
-        running << QString(QObject::tr("Scrub Started: %1")).arg(timestamp);      
-      }else if(line.contains("resilvered")){
-	QString timestamp = line.section(" ",8,12,QString::SectionSkipEmpty);
-	QString numerrors = line.section(" ",5,5,QString::SectionSkipEmpty);
-        finished << QString(QObject::tr("Resilver Finished: %1 (%2 errors)")).arg(timestamp, numerrors);
-      }
-    }else if(zstat[i].contains("NAME") && zstat[i].contains("STATE") && zstat[i].contains("READ") ){
-      //qDebug() <<"Found header"; 
-      atheader=true;
-    }else if(zstat[i].startsWith("errors:")){ 
-      atheader=false; 
-    }else if(atheader){
-      QString line = zstat[i].replace("\t"," ").simplified();
-      QString dev = line.section(" ",0,0,QString::SectionSkipEmpty);
-      QString state = line.section(" ",1,1,QString::SectionSkipEmpty);
-      //qDebug() << "Found device:" << dev << state;
-      if(dev == zpool){
-	DSC.poolStatus = state;
-      }else if(line.contains("(resilvering)")){
-	disks << dev; diskstates << state; //record this disk and state
-	running << QString(QObject::tr("%1: Currently Resilvering")).arg(dev);
-      }else{
-	disks << dev; diskstates << state; //record this disk and state
-	if(state != "ONLINE"){
-	  errors << QString(QObject::tr("%1: %2")).arg(dev, state);
-	}
-      }
-    }
-  }
-  qDebug() << "[DEBUG] Get latest snapshot/replication info";
-  //Now get the latest Snapshot/Replication information
-  QStringList lpstat = LPBackend::listCurrentStatus();
-  //qDebug() << " - " << lpstat;
-  for(int i=0; i<lpstat.length(); i++){
-    if(lpstat[i].section(":::",0,0) == zpool){
-      QString lastSnap = lpstat[i].section(":::",1,1);
-      QString lastRep = lpstat[i].section(":::",2,2);
-      QString reptarget = lpstat[i].section(":::",3,3);
-      if(lastSnap=="-"){ DSC.latestSnapshot = QObject::tr("No Snapshots Available"); }
-      else{ DSC.latestSnapshot = lastSnap; }
-      if(lastRep!="-"){
-        finished << QString(QObject::tr("Latest Replication: %1")).arg(lastRep);
-      }else if(LPBackend::listReplicationTargets().contains(zpool) ){
-	errors << QObject::tr("No Successful Replication");
-      }
-      if(reptarget=="-"){ DSC.repHost.clear(); }
-      else{ DSC.repHost << reptarget; }
-    }
-  }
-  qDebug() << "[DEBUG] save info to the structure and finish";
-  //Now save the info to the dataset
-  DSC.harddisks = disks;
-  DSC.harddiskStatus = diskstates;
-  DSC.errorStatus = errors.join("\n");
-  DSC.runningStatus = running.join("\n");
-  DSC.finishedStatus = finished.join("\n");
-  //Return the dataset
-  return DSC;
+QHash<QString, LPDataset> LPGUtils::loadPoolData(QStringList zpools){
+  //Load the current information for all the given zpools at once
+  qDebug() << "[DEBUG] Sample pools: " << zpools;
+  return LPPoolSampler::sample(zpools);
 }
 
 void LPGUtils::loadSnapshotInfo(LPDataset* DSC){
@@ -94,38 +27,26 @@ void LPGUtils::loadSnapshotInfo(LPDataset* DSC){
   QStringList subsets = LPBackend::listDatasetSubsets(DSC->zpool);
   QStringList lpsnapcomments;
   QStringList lpsnaps = LPBackend::listLPSnapshots(DSC->zpool, lpsnapcomments);
-  //qDebug() << "subsets:" << subsets;
-  //qDebug() << "lpsnaps:" << lpsnaps;
   //Fill the snapshots/comments hash
   DSC->snapComment.clear();
   for(int i=0; i<lpsnaps.length() && i<lpsnapcomments.length(); i++){
     DSC->snapComment.insert(lpsnaps[i], lpsnapcomments[i]);
   }
+  //Update the catalog for this pool (only new snapshots/mountpoints get checked on disk)
+  QMutexLocker lock(&CATALOGLOCK);
+  LPSnapshotCatalog &catalog = CATALOGS[DSC->zpool];
+  catalog.sync(lpsnaps, subsets);
   //populate the list of snapshots available for each mountpoint
   DSC->subsetHash.clear();
-  for(int i=0; i<subsets.length(); i++){
-    //qDebug() << "Subset:" << subsets[i];
-    QStringList snaps = LPBackend::listSnapshots(subsets[i]);
-    //qDebug() << " - Snapshots:" << snaps;
-    if(snaps.isEmpty()){
-      //invalid subset - remove it from the list
-      subsets.removeAt(i);
-      i--;
-    }else{
-      QStringList subsnaps;
-      //only list the valid snapshots that life preserver created
-      for(int s=0; s<lpsnaps.length(); s++){
-	int index = snaps.indexOf(lpsnaps[s]);
-        if(index > -1){ subsnaps << lpsnaps[s]; snaps.removeAt(index); }
-      }
-      /*//Now list all the other available snapshots (no certain ordering)
-      if(!snaps.isEmpty()){try 
-	subsnaps << "--"; //so we know that this is a divider between the sections
-	subsnaps << snaps;
-      }*/
-      DSC->subsetHash.insert(subsets[i],subsnaps); //add it to the internal container hash
-    }
-  }	
+  QStringList valid = catalog.mountpoints();
+  for(int i=0; i<valid.length(); i++){
+    DSC->subsetHash.insert(valid[i], catalog.snapshots(valid[i])); //add it to the internal container hash
+  }
+}
+
+LPSnapshotCatalog LPGUtils::snapshotCatalog(QString zpool){
+  QMutexLocker lock(&CATALOGLOCK);
+  return CATALOGS.value(zpool);
 }
 
 QString LPGUtils::generateReversionFileName(QString fileName, QString destDir){
@@ -251,27 +172,22 @@ bool LPGUtils::checkPackageUserPath(QString packagePath, QString *user){
   user->clear();
   //Determine if the file exists
   if( !QFile::exists(packagePath) ){ return false; }
-  //Check the username of the home dir in the package
-  QStringList ret = LPBackend::getCmdOutput("tar -tvf "+packagePath+" -q \"*/Desktop\"");
-  if(ret.isEmpty()){ return false; }
-  QString username = ret[0].section(" ",2,2,QString::SectionSkipEmpty).simplified();
-  QString dirname = ret[0].section(" ",8,8,QString::SectionSkipEmpty).section("/",0,0).simplified();
+  //Check the username of the home dir in the package (header entry at the start of newer packages)
+  QString username, dirname;
+  qint64 bytes;
+  if( !LPHomePackager::readHeader(packagePath, &username, &dirname, &bytes) ){
+    //Older package: look for the Desktop folder instead
+    QStringList ret = LPBackend::getCmdOutput("tar -tvf "+packagePath+" -q \"*/Desktop\"");
+    if(ret.isEmpty()){ return false; }
+    username = ret[0].section(" ",2,2,QString::SectionSkipEmpty).simplified();
+    dirname = ret[0].section(" ",8,8,QString::SectionSkipEmpty).section("/",0,0).simplified();
+  }
   user->append(username); //additional output
   //Now check for the user on the local system
   //This is just a simple check that the user directory exists, and the user/directory are the same within the package
   return (username == dirname && QFile::exists("/usr/home/"+dirname) );	
 }
 
-bool LPGUtils::extractHomeDirPackage(QString packagePath){
- //Determine if the file exists
-  if( !QFile::exists(packagePath) ){ return false; }
-  //Now extract the archive in the home directory
-  QString cmd = "tar -xpf "+packagePath+" -C /usr/home";
-  qDebug() << "Extract command:" << cmd;
-  int ret = LPBackend::runCmd(cmd);
-  return (ret == 0);
-}
-
 QStringList LPGUtils::listAvailableHardDisks(){
   QDir dev("/dev");
   QStringList filters;
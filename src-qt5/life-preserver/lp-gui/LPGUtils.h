@@ -10,18 +10,23 @@
 
 #include "LPBackend.h"
 #include "LPContainers.h"
+#include "LPSnapshotCatalog.h"
+#include "LPPoolSampler.h"
+#include "LPHomePackager.h"
 
 class LPGUtils{
 public:
 	static LPDataset loadPoolData(QString zpool); //Load backend data into container
+	static QHash<QString, LPDataset> loadPoolData(QStringList zpools); //Same, for several pools with one "zpool status"
 	static void loadSnapshotInfo(LPDataset*); //Load the backend snapshot info into container
+	static LPSnapshotCatalog snapshotCatalog(QString zpool); //copy of the latest snapshot catalog for a pool
 	static QString generateReversionFileName(QString filename, QString destDir);
 	static bool revertFile(QString oldPath, QString newPath); //copy a file out of a snapshot
 	static QStringList revertDir(QString oldPath, QString newPath); //copy a dir out of a snapshot
 	//Functions for packaging up a user's home directory and extracting it later
 	static QString packageHomeDir(QString username, QString packageName);
 	static bool checkPackageUserPath(QString packagePath, QString *user);
-	static bool extractHomeDirPackage(QString packagePath);
+	//  (packages get extracted in the background with LPHomePackager)
 	//Function to scan the system for available harddisks/devices
 	static QStringList listAvailableHardDisks();
 	//Function to scan the network for available replication targets (SSH open)
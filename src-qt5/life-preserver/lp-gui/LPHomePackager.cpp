@@ -0,0 +1,314 @@
+#include "LPHomePackager.h"
+
+#include <unistd.h>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QThread>
+
+#define HEADERFILE QString(".lp-home-package")
+
+namespace{
+  //Headers which were already read (the package is checked before it gets extracted)
+  struct PackageHeader{
+    QDateTime modified;
+    qint64 size;
+    bool found;
+    QString user, dir;
+    qint64 bytes;
+  };
+  QHash<QString, PackageHeader> HEADERCACHE;
+}
+
+LPHomePackager::LPHomePackager(QObject *parent) : QObject(parent){
+  sizeProc = new QProcess(this);
+    connect(sizeProc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(slotSizeDone()) );
+    connect(sizeProc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(slotProcError(QProcess::ProcessError)) );
+  tarProc = 0;
+  zipProc = 0;
+  headerDir = 0;
+  totalBytes = doneBytes = 0;
+  doneFiles = 0;
+  extracting = stopped = false;
+  tarDone = zipDone = true;
+  tarExit = zipExit = 0;
+}
+
+LPHomePackager::~LPHomePackager(){
+  if(isRunning()){ cancel(); }
+  if(headerDir!=0){ delete headerDir; }
+}
+
+void LPHomePackager::startPackage(QString base, QString homedir, QString archive, QStringList exclude){
+  if(isRunning()){ return; }
+  extracting = false;
+  baseDir = base; dir = homedir; file = archive;
+  packagePath = baseDir+"/"+file;
+  excludes = exclude;
+  reset();
+  emit progress(0, 0, 0, -1);
+  //Get the size of the directory first (apparent size, in KB) for the progress reports
+  sizeProc->start("du", QStringList() << "-A" << "-s" << "-k" << baseDir+"/"+dir);
+}
+
+void LPHomePackager::startExtract(QString path, QString dest){
+  if(isRunning()){ return; }
+  extracting = true;
+  packagePath = path; destDir = dest;
+  reset();
+  QString user;
+  if( !readHeader(packagePath, &user, &dir, &totalBytes) ){ dir.clear(); totalBytes = 0; } //older package
+  emit progress(0, totalBytes, 0, -1);
+  elapsed.start(); lastReport.start();
+  QString zip = QStandardPaths::findExecutable("pigz");
+  if(zip.isEmpty()){
+    //tar can read the compressed file directly
+    zipDone = true;
+    tarProc->start("tar", QStringList() << "-xvpf" << packagePath << "-C" << destDir);
+  }else{
+    zipProc->setStandardInputFile(packagePath);
+    zipProc->setStandardOutputProcess(tarProc);
+    zipProc->start(zip, QStringList() << "-dc");
+    tarProc->start("tar", QStringList() << "-xvpf" << "-" << "-C" << destDir);
+  }
+}
+
+void LPHomePackager::cancel(){
+  stopped = true;
+  if(sizeProc->state() != QProcess::NotRunning){ sizeProc->kill(); }
+  if(tarProc!=0 && tarProc->state() != QProcess::NotRunning){ tarProc->kill(); }
+  if(zipProc!=0 && zipProc->state() != QProcess::NotRunning){ zipProc->kill(); }
+}
+
+bool LPHomePackager::isRunning(){
+  return ( sizeProc->state() != QProcess::NotRunning || !tarDone || !zipDone );
+}
+
+QString LPHomePackager::errors(){
+  return errorLines.join("\n");
+}
+
+bool LPHomePackager::readHeader(QString path, QString *user, QString *hdir, qint64 *bytes){
+  user->clear(); hdir->clear(); *bytes = 0;
+  //Only read each package once (as long as the file does not change)
+  QFileInfo finfo(path);
+  QHash<QString, PackageHeader>::const_iterator cached = HEADERCACHE.constFind(finfo.absoluteFilePath());
+  if(cached != HEADERCACHE.constEnd() && cached.value().modified == finfo.lastModified() && cached.value().size == finfo.size()){
+    user->append(cached.value().user);
+    hdir->append(cached.value().dir);
+    *bytes = cached.value().bytes;
+    return cached.value().found;
+  }
+  PackageHeader header;
+    header.modified = finfo.lastModified();
+    header.size = finfo.size();
+    header.found = false;
+    header.bytes = 0;
+  //The header is always the first entry, so only the start of the archive needs to be read
+  QProcess proc;
+  proc.start("tar", QStringList() << "-tvf" << path);
+  QString first;
+  if(proc.waitForStarted(3000)){
+    while( !proc.canReadLine() && proc.waitForReadyRead(10000) ){}
+    if(proc.canReadLine()){ first = QString::fromLocal8Bit(proc.readLine()).simplified(); }
+  }
+  proc.kill();
+  proc.waitForFinished(1000);
+  //Example: "-rw-r--r--  0 user   user   48 Mar  1 12:00 user/.lp-home-package"
+  QString name = first.section(" ",8,-1,QString::SectionSkipEmpty);
+  if(name.section("/",-1) != HEADERFILE){
+    HEADERCACHE.insert(finfo.absoluteFilePath(), header);
+    return false;
+  }
+  user->append( first.section(" ",2,2,QString::SectionSkipEmpty) );
+  hdir->append( name.section("/",0,0) );
+  //Now read the contents of the header (fast-read: stop at the first match)
+  proc.start("tar", QStringList() << "-xOqf" << path << name);
+  proc.waitForFinished(10000);
+  QStringList info = QString::fromLocal8Bit(proc.readAllStandardOutput()).split("\n", QString::SkipEmptyParts);
+  for(int i=0; i<info.length(); i++){
+    if(info[i].startsWith("bytes=")){ *bytes = info[i].section("=",1,1).toLongLong(); }
+  }
+  header.found = true;
+  header.user = *user;
+  header.dir = *hdir;
+  header.bytes = *bytes;
+  HEADERCACHE.insert(finfo.absoluteFilePath(), header);
+  return true;
+}
+
+QString LPHomePackager::sizeText(qint64 bytes){
+  double size = bytes;
+  QStringList labels; labels << "B" << "KB" << "MB" << "GB" << "TB" << "PB" << "EB";
+  int i=0;
+  while( size > 1024 && i < labels.length()-1 ){
+    size = size/1024;
+    i++;
+  }
+  //Round to 2 decimel places if GB or larger
+  if(i>2){ size = int(size*100)/100.0; }
+  else{ size = int(size); }
+  return QString::number(size)+" "+labels[i];
+}
+
+QString LPHomePackager::timeText(int secs){
+  if(secs < 0){ return ""; }
+  return QString("%1:%2:%3").arg(secs/3600).arg((secs%3600)/60, 2, 10, QChar('0')).arg(secs%60, 2, 10, QChar('0'));
+}
+
+//====PRIVATE====
+void LPHomePackager::reset(){
+  stopped = false;
+  totalBytes = doneBytes = 0;
+  doneFiles = 0;
+  errorLines.clear();
+  tarBuffer.clear();
+  tarExit = zipExit = 0;
+  if(headerDir!=0){ delete headerDir; headerDir = 0; }
+  //The pipe between the two processes is set up differently for packaging/extraction
+  if(tarProc!=0){ tarProc->deleteLater(); }
+  if(zipProc!=0){ zipProc->deleteLater(); }
+  tarProc = new QProcess(this);
+    connect(tarProc, SIGNAL(readyReadStandardError()), this, SLOT(slotTarOutput()) );
+    connect(tarProc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(slotTarDone(int, QProcess::ExitStatus)) );
+    connect(tarProc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(slotProcError(QProcess::ProcessError)) );
+  zipProc = new QProcess(this);
+    connect(zipProc, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(slotZipDone(int, QProcess::ExitStatus)) );
+    connect(zipProc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(slotProcError(QProcess::ProcessError)) );
+  tarDone = zipDone = false;
+}
+
+void LPHomePackager::startTar(){
+  //Write the header into a temporary copy of the directory layout, with the same owner as the home dir
+  headerDir = new QTemporaryDir();
+  QString header = dir+"/"+HEADERFILE;
+  if(headerDir->isValid() && QDir(headerDir->path()).mkpath(dir) ){
+    QFile hfile(headerDir->path()+"/"+header);
+    if(hfile.open(QIODevice::WriteOnly | QIODevice::Text)){
+      QTextStream out(&hfile);
+      out << "version=1\n";
+      out << "dir=" << dir << "\n";
+      out << "bytes=" << totalBytes << "\n";
+      out << "created=" << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n";
+      out.flush();
+      hfile.close();
+      QFileInfo info(baseDir+"/"+dir);
+      if( 0 != ::chown(QFile::encodeName(hfile.fileName()).constData(), info.ownerId(), info.groupId()) ){
+        qDebug() << "Could not set the owner of the package header";
+      }
+    }
+  }
+  //Generate the tar command (archive to stdout)
+  QStringList args;
+  for(int i=0; i<excludes.length(); i++){ args << "--exclude" << excludes[i]; }
+  args << "-cvf" << "-";
+  if(QFile::exists(headerDir->path()+"/"+header)){ args << "-C" << headerDir->path() << header; } //first entry
+  args << "-C" << baseDir << dir;
+  //Compression: parallel gzip if available
+  QString zip = QStandardPaths::findExecutable("pigz");
+  QStringList zargs;
+  if(zip.isEmpty()){ zip = "gzip"; zargs << "-c"; }
+  else{ zargs << "-p" << QString::number(qMax(1, QThread::idealThreadCount())) << "-c"; }
+  qDebug() << "Package command:" << "tar" << args << "|" << zip << zargs;
+  tarProc->setStandardOutputProcess(zipProc);
+  zipProc->setStandardOutputFile(packagePath);
+  elapsed.start(); lastReport.start();
+  zipProc->start(zip, zargs);
+  tarProc->start("tar", args);
+}
+
+void LPHomePackager::checkFinished(){
+  if(!tarDone || !zipDone){ return; }
+  bool ok = (!stopped && tarExit==0 && zipExit==0);
+  if(!extracting && !ok){
+    qDebug() << " - Removing partial archive file:" << packagePath;
+    QFile::remove(packagePath);
+  }else if(extracting && ok && !dir.isEmpty()){
+    QFile::remove(destDir+"/"+dir+"/"+HEADERFILE); //only used inside the package
+  }
+  if(headerDir!=0){ delete headerDir; headerDir = 0; }
+  report(true);
+  emit finished(ok);
+}
+
+void LPHomePackager::report(bool force){
+  if(!force && lastReport.elapsed() < 250){ return; } //don't flood the GUI
+  lastReport.restart();
+  int secsLeft = -1;
+  qint64 msecs = elapsed.elapsed();
+  if(totalBytes > doneBytes && doneBytes > 0 && msecs > 2000){
+    double rate = doneBytes / (msecs/1000.0); //bytes per second so far
+    secsLeft = int( (totalBytes-doneBytes)/rate );
+  }else if(totalBytes > 0 && doneBytes >= totalBytes){
+    secsLeft = 0;
+  }
+  emit progress(doneBytes, totalBytes, doneFiles, secsLeft);
+}
+
+//====PRIVATE SLOTS====
+void LPHomePackager::slotSizeDone(){
+  if(stopped){ tarDone = zipDone = true; emit finished(false); return; }
+  QString out = QString(sizeProc->readAllStandardOutput()).simplified();
+  totalBytes = out.section(" ",0,0).toLongLong()*1024;
+  startTar();
+}
+
+void LPHomePackager::slotTarOutput(){
+  //bsdtar prints "a <path>" (create) or "x <path>" (extract) and ends the line once that file is done
+  tarBuffer.append( tarProc->readAllStandardError() );
+  int index;
+  while( (index = tarBuffer.indexOf('\n')) >= 0 ){
+    QString line = QString::fromLocal8Bit(tarBuffer.left(index));
+    tarBuffer.remove(0, index+1);
+    if(line.startsWith("a ") || line.startsWith("x ")){
+      QFileInfo info( (extracting ? destDir : baseDir)+"/"+line.mid(2) );
+      if(info.isFile() && !info.isSymLink()){ doneBytes += info.size(); }
+      doneFiles++;
+    }else if(!line.isEmpty()){
+      errorLines << line;
+    }
+  }
+  report(false);
+}
+
+void LPHomePackager::slotTarDone(int code, QProcess::ExitStatus status){
+  slotTarOutput(); //read anything left over
+  tarExit = (status==QProcess::NormalExit) ? code : -1;
+  tarDone = true;
+  checkFinished();
+}
+
+void LPHomePackager::slotZipDone(int code, QProcess::ExitStatus status){
+  QString err = QString(zipProc->readAllStandardError()).simplified();
+  if(!err.isEmpty()){ errorLines << err; }
+  zipExit = (status==QProcess::NormalExit) ? code : -1;
+  zipDone = true;
+  checkFinished();
+}
+
+void LPHomePackager::slotProcError(QProcess::ProcessError err){
+  //Crashes are reported through finished() - only a process which never ran needs cleaning up here
+  if(err != QProcess::FailedToStart){ return; }
+  QProcess *proc = static_cast<QProcess*>(sender());
+  errorLines << proc->program()+": "+proc->errorString();
+  if(proc == sizeProc){
+    tarDone = zipDone = true;
+    emit finished(false);
+    return;
+  }
+  //The other half of the pipeline cannot finish on its own
+  if(proc == tarProc){
+    tarExit = -1; tarDone = true;
+    if(zipProc->state() != QProcess::NotRunning){ zipProc->kill(); }
+  }else if(proc == zipProc){
+    zipExit = -1; zipDone = true;
+    if(tarProc->state() != QProcess::NotRunning){ tarProc->kill(); }
+  }
+  checkFinished();
+}
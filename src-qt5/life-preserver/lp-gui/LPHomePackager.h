@@ -0,0 +1,69 @@
+#ifndef _LP_HOME_PACKAGER_H
+#define _LP_HOME_PACKAGER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QStringList>
+#include <QString>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
+//Creates/extracts home directory packages (<user>.home.tar.gz) in the background
+// "tar" is piped through "pigz" (parallel gzip) when it is installed, so the packages stay
+// plain tar.gz files. Progress is taken from the verbose tar output (one line per finished file).
+// Every new package starts with a small header file (<dir>/.lp-home-package) which records
+// the owner and size, so it can be checked without reading through the whole archive.
+class LPHomePackager : public QObject{
+	Q_OBJECT
+public:
+	LPHomePackager(QObject *parent = 0);
+	~LPHomePackager();
+
+	//Package <baseDir>/<dir> into the <baseDir>/<file> archive (excludes: tar patterns)
+	void startPackage(QString baseDir, QString dir, QString file, QStringList excludes);
+	//Extract a package within the given directory
+	void startExtract(QString packagePath, QString destDir);
+	bool isRunning();
+	QString errors(); //tar/compression error messages from the last run
+
+	//Read the header of a package: returns false for older packages without one
+	// (the result is kept until the package file changes)
+	static bool readHeader(QString packagePath, QString *user, QString *dir, qint64 *bytes);
+	//Human-readable text for a size/number of seconds (progress reports)
+	static QString sizeText(qint64 bytes);
+	static QString timeText(int secs);
+
+public slots:
+	void cancel(); //stop the current run (a partial package gets removed)
+
+private:
+	QProcess *sizeProc, *tarProc, *zipProc;
+	QTemporaryDir *headerDir;
+	QString baseDir, dir, file, destDir, packagePath;
+	QStringList excludes, errorLines;
+	QByteArray tarBuffer; //partial line of tar output
+	qint64 totalBytes, doneBytes;
+	int doneFiles;
+	bool extracting, stopped, tarDone, zipDone;
+	int tarExit, zipExit;
+	QElapsedTimer elapsed, lastReport;
+
+	void reset(); //clear the counters and create new processes for the next run
+	void startTar(); //packaging: size known, write the header and start the pipeline
+	void checkFinished();
+	void report(bool force);
+
+private slots:
+	void slotSizeDone();
+	void slotTarOutput();
+	void slotTarDone(int, QProcess::ExitStatus);
+	void slotZipDone(int, QProcess::ExitStatus);
+	void slotProcError(QProcess::ProcessError);
+
+signals:
+	//totalBytes is 0 while unknown, secsLeft is -1 while unknown
+	void progress(qint64 bytes, qint64 totalBytes, int files, int secsLeft);
+	void finished(bool ok);
+};
+
+#endif
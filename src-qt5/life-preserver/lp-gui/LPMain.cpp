@@ -21,12 +21,24 @@ LPMain::LPMain(QWidget *parent) : QMainWindow(parent), ui(new Ui::LPMain){
   WorkThread = new QThread();
   WORKER = new BackgroundWorker();
     WORKER->moveToThread(WorkThread);
-    connect(this, SIGNAL(loadSnaps(LPDataset*)), WORKER, SLOT(loadSnapshotInfo(LPDataset*)) );
+    qRegisterMetaType<LPPoolState>("LPPoolState");
+    qRegisterMetaType<LPDataset>("LPDataset");
+    connect(this, SIGNAL(loadSnaps(LPDataset)), WORKER, SLOT(loadSnapshotInfo(LPDataset)) );
+    connect(this, SIGNAL(loadPoolState()), WORKER, SLOT(loadPoolState()) );
+    connect(WORKER, SIGNAL(PoolStateLoaded(LPPoolState)), this, SLOT(applyPoolState(LPPoolState)) );
+    connect(this, SIGNAL(loadVersions(QString, QString, QStringList)), WORKER, SLOT(loadFileVersions(QString, QString, QStringList)) );
     WorkThread->start();
+  //No pool information yet (loaded in the background)
+  poolSelected = false;
+  stateLoading = stateDirty = reloadSnaps = false;
   //Initialize the waitbox pointer
   waitBox = 0;
   //Initialize the classic dialog pointer
   classicDLG = 0;
+  extractDLG = 0;
+  extractor = new LPHomePackager(this);
+    connect(extractor, SIGNAL(progress(qint64, qint64, int, int)), this, SLOT(slotExtractProgress(qint64, qint64, int, int)) );
+    connect(extractor, SIGNAL(finished(bool)), this, SLOT(slotExtractFinished(bool)) );
   //Create the basic/advanced view options
   viewBasic = new QRadioButton(tr("Basic"), ui->menuView);
 	QWidgetAction *WABasic = new QWidgetAction(this); WABasic->setDefaultWidget(viewBasic);
@@ -44,15 +56,17 @@ LPMain::LPMain(QWidget *parent) : QMainWindow(parent), ui(new Ui::LPMain){
   fsModel = new QFileSystemModel(this);
 	fsModel->setReadOnly(true);
 	ui->treeView->setModel(fsModel);
+	ui->treeView->setContextMenuPolicy(Qt::CustomContextMenu);
   //Connect the UI to all the functions
   connect(ui->tool_refresh, SIGNAL(clicked()), this, SLOT(updatePoolList()) );
-  connect(ui->combo_pools, SIGNAL(currentIndexChanged(int)), this, SLOT(updateTabs()) );
+  connect(ui->combo_pools, SIGNAL(currentIndexChanged(int)), this, SLOT(showTabs()) );
   connect(ui->combo_datasets, SIGNAL(currentIndexChanged(int)), this, SLOT(updateDataset()) );
   connect(ui->slider_snapshots, SIGNAL(valueChanged(int)), this, SLOT(updateSnapshot()) );
   connect(ui->push_prevsnap, SIGNAL(clicked()), this, SLOT(prevSnapshot()) );
   connect(ui->push_nextsnap, SIGNAL(clicked()), this, SLOT(nextSnapshot()) );
   connect(ui->check_hidden, SIGNAL(stateChanged(int)), this, SLOT(setFileVisibility()) );
   connect(ui->push_restore, SIGNAL(clicked()), this, SLOT(restoreFiles()) );
+  connect(ui->treeView, SIGNAL(customContextMenuRequested(const QPoint&)), this, SLOT(showFileMenu(const QPoint&)) );
   connect(ui->push_configure, SIGNAL(clicked()), this, SLOT(openConfigGUI()) );
   //Connect the Menu buttons
   connect(ui->menuManage_Pool, SIGNAL(triggered(QAction*)), this, SLOT(menuAddPool(QAction*)) );
@@ -81,7 +95,8 @@ LPMain::LPMain(QWidget *parent) : QMainWindow(parent), ui(new Ui::LPMain){
   //Now connect the watcher to the update slot
   connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(autoRefresh()) );
   //Connect the worker process to the update routine
-  connect(WORKER, SIGNAL(SnapshotsLoaded()), this, SLOT(updateSnapshots()) );
+  connect(WORKER, SIGNAL(SnapshotsLoaded(LPDataset)), this, SLOT(applySnapshots(LPDataset)) );
+  connect(WORKER, SIGNAL(FileVersionsLoaded(QString, QString)), this, SLOT(showFileVersions(QString, QString)) );
 }
 
 LPMain::~LPMain(){
@@ -137,68 +152,78 @@ void LPMain::hideWaitBox(){
 //     PRIVATE SLOTS
 // ==============
 void LPMain::updatePoolList(){
-  //Get the currently selected pool (if there is one)
+  //Load the pool lists/status in the background (applyPoolState() updates the UI)
+  if(stateLoading){ stateDirty = true; return; } //load again once the current one is done
   qDebug() << "Update Pool List";
+  stateLoading = true;
+  stateDirty = false;
+  ui->statusbar->showMessage(tr("Loading pool information..."), 0);
+  emit loadPoolState();
+}
+
+void LPMain::applyPoolState(LPPoolState state){
+  stateLoading = false;
+  if(ui->statusbar->currentMessage() == tr("Loading pool information...")){ ui->statusbar->clearMessage(); }
+  //Get the currently selected pool (if there is one)
   QString cPool;
   QStringList cpoolList;
-  if(ui->combo_pools->currentIndex() != -1){ cPool = ui->combo_pools->currentText(); }
-  for(int i=0; i<ui->combo_pools->count(); i++){
-    cpoolList << ui->combo_pools->itemText(i);
-  }
-  //Get the list of managed pools
-  qDebug() << "[DEBUG] Fetching list of pools";
-  QStringList pools = LPBackend::listDatasets();
-  QStringList poolsAvail = LPBackend::listPossibleDatasets();
-  for(int i=0; i<pools.length(); i++){
+  if(poolSelected){
+    cPool = ui->combo_pools->currentText();
+    for(int i=0; i<ui->combo_pools->count(); i++){
+      cpoolList << ui->combo_pools->itemText(i);
+    }
+  }
+  QStringList pools = state.pools;
+  for(int i=0; i<pools.length() && !cpoolList.isEmpty(); i++){
     if(!cpoolList.contains(pools[i])){ cPool = pools[i]; break; } //new managed pool, activate this one instead
   }
-  //Now put the lists into the UI
-  poolSelected = false; //disable for the moment while changing lists
-  ui->combo_pools->clear();
-  if(!pools.isEmpty()){ ui->combo_pools->addItems(pools); }
-  //Now set the currently selected pools
+  POOLSAMPLE = state.sample;
+  //Now put the lists into the UI (only if they changed)
   qDebug() << "[DEBUG] Pool list:" << pools;
-  if(pools.length() > 0){
-    poolSelected=true;	  
-    int index = pools.indexOf(cPool);
-    if(index < 0){ ui->combo_pools->setCurrentIndex(0); }
-    else{ ui->combo_pools->setCurrentIndex(index); }
-  }else{
-    //No managed pools
-    poolSelected=false;
-    ui->combo_pools->addItem("No Managed Pools!");
-    ui->combo_pools->setCurrentIndex(0);
-    //Reset to Basic View
-    viewBasic->setChecked(true);
-  }
-  qDebug() << "[DEBUG] Update pool menu options";
+  if(pools != cpoolList || ui->combo_pools->count()==0 ){
+    ui->combo_pools->blockSignals(true); //showTabs() gets called below
+    ui->combo_pools->clear();
+    if(pools.length() > 0){
+      ui->combo_pools->addItems(pools);
+      int index = pools.indexOf(cPool);
+      if(index < 0){ ui->combo_pools->setCurrentIndex(0); }
+      else{ ui->combo_pools->setCurrentIndex(index); }
+      poolSelected = true;
+    }else{
+      //No managed pools
+      poolSelected = false;
+      ui->combo_pools->addItem("No Managed Pools!");
+      ui->combo_pools->setCurrentIndex(0);
+      //Reset to Basic View
+      viewBasic->setChecked(true);
+    }
+    ui->combo_pools->blockSignals(false);
+  }
   //Now update the add/remove pool menu's
-  ui->menuManage_Pool->clear();
-  for( int i=0; i<poolsAvail.length(); i++){
-    if(pools.contains(poolsAvail[i])){ continue; } //already managed
-    ui->menuManage_Pool->addAction(poolsAvail[i]);
-  }
-  ui->menuManage_Pool->setEnabled( !ui->menuManage_Pool->isEmpty() );
-  ui->menuUnmanage_Pool->clear();
-  //ui->menuEnable_Offsite_Backups->clear();
-  for( int i=0; i<pools.length(); i++){
-    ui->menuUnmanage_Pool->addAction(pools[i]);
-    //ui->menuEnable_Offsite_Backups->addAction(pools[i]);
-  }
-  ui->menuUnmanage_Pool->setEnabled( !ui->menuUnmanage_Pool->isEmpty() );
-  //ui->menuEnable_Offsite_Backups->setEnabled( !ui->menuEnable_Offsite_Backups->isEmpty() );
-  qDebug() << "[DEBUG] Update user menus";
-  //Now update the user's that are available for home-dir packaging
-  QDir hdir("/usr/home");
-  QStringList users = hdir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
-  ui->menuCompress_Home_Dir->clear();
-  for(int i=0; i<users.length(); i++){
-    ui->menuCompress_Home_Dir->addAction(users[i]);
+  QStringList unmanaged;
+  for( int i=0; i<state.poolsAvail.length(); i++){
+    if(!pools.contains(state.poolsAvail[i])){ unmanaged << state.poolsAvail[i]; } //not managed yet
   }
+  setMenuItems(ui->menuManage_Pool, unmanaged);
+  setMenuItems(ui->menuUnmanage_Pool, pools);
+  //Now update the user's that are available for home-dir packaging
+  setMenuItems(ui->menuCompress_Home_Dir, state.users);
   //Now update the interface appropriately
   ui->combo_pools->setEnabled(poolSelected);
-  qDebug() << "[DEBUG] Finished updatePoolList()";
-  updateTabs();
+  showTabs();
+  if(stateDirty){ updatePoolList(); } //something changed while this was loading
+}
+
+void LPMain::setMenuItems(QMenu *menu, QStringList items){
+  //Only re-create the menu entries if the list changed
+  QList<QAction*> acts = menu->actions();
+  QStringList current;
+  for(int i=0; i<acts.length(); i++){ current << acts[i]->text(); }
+  if(current != items){
+    menu->clear();
+    for(int i=0; i<items.length(); i++){ menu->addAction(items[i]); }
+  }
+  menu->setEnabled( !items.isEmpty() );
 }
 
 void LPMain::viewChanged(){
@@ -219,14 +244,19 @@ void LPMain::viewChanged(){
 }
 
 void LPMain::updateTabs(){
+  //Re-load the status of all the pools (the tabs get updated once it is loaded)
+  updatePoolList();
+}
+
+void LPMain::showTabs(){
   static bool updating = false;
   if(updating){ return; } //prevent double-taps on this function
   updating = true;
-  QApplication::processEvents();
-  //qDebug() << "Update Tabs" << poolSelected;
-  qDebug() << "[DEBUG] start updateTabs():" << poolSelected;
+  qDebug() << "[DEBUG] start showTabs():" << poolSelected;
+  QString pool = poolSelected ? ui->combo_pools->currentText() : "";
+  bool newPool = (pool != POOLDATA.zpool);
   viewChanged();
-  ui->tabWidget->setCurrentWidget(ui->tab_status);
+  if(newPool){ ui->tabWidget->setCurrentWidget(ui->tab_status); }
   ui->tabWidget->setEnabled(poolSelected);
   ui->menuView->setEnabled(poolSelected);	
   ui->menuDisks->setEnabled(poolSelected); 
@@ -241,11 +271,23 @@ void LPMain::updateTabs(){
 	  ui->label_runningstat->setVisible(false);
 	  ui->label_finishedstat->setVisible(false);
   if(poolSelected){
-    showWaitBox(tr("Loading Information"));
-    qDebug() << "[DEBUG] loadPoolData:" << ui->combo_pools->currentText();
-    POOLDATA = LPGUtils::loadPoolData(ui->combo_pools->currentText());
+    if(!POOLSAMPLE.contains(pool)){
+      //Not in the last background sample (should not happen): load it now
+      showWaitBox(tr("Loading Information"));
+      QStringList pools;
+      for(int i=0; i<ui->combo_pools->count(); i++){ pools << ui->combo_pools->itemText(i); }
+      POOLSAMPLE = LPGUtils::loadPoolData(pools);
+      hideWaitBox();
+    }
+    //Keep the snapshot info if nothing changed (no need to reset the restore tab)
+    LPDataset old = POOLDATA;
+    POOLDATA = POOLSAMPLE.value(pool);
+    bool newSnaps = (newPool || reloadSnaps || old.subsetHash.isEmpty() || old.latestSnapshot != POOLDATA.latestSnapshot);
+    if(!newSnaps){
+      POOLDATA.subsetHash = old.subsetHash;
+      POOLDATA.snapComment = old.snapComment;
+    }
     qDebug() << "[DEBUG] loaded data";
-    hideWaitBox();
     //Now list the status information
     ui->label_status->setText(POOLDATA.poolStatus);
     ui->label_numdisks->setText( QString::number(POOLDATA.harddisks.length()) );
@@ -274,17 +316,9 @@ void LPMain::updateTabs(){
     
     //Update the replication/disk menus
     QStringList repHosts = POOLDATA.repHost;
-    ui->menuStart_Replication->clear();
-    ui->menuInit_Replications->clear();
-    ui->menuReset_Replication_Password->clear();
-    for(int i=0; i<repHosts.length(); i++){
-      ui->menuStart_Replication->addAction( repHosts[i] );
-      ui->menuInit_Replications->addAction( repHosts[i] );
-      ui->menuReset_Replication_Password->addAction( repHosts[i] );
-    }
-    ui->menuStart_Replication->setEnabled( !ui->menuStart_Replication->isEmpty() );
-    ui->menuInit_Replications->setEnabled( !ui->menuInit_Replications->isEmpty() );
-    ui->menuReset_Replication_Password->setEnabled( !ui->menuReset_Replication_Password->isEmpty() );
+    setMenuItems(ui->menuStart_Replication, repHosts);
+    setMenuItems(ui->menuInit_Replications, repHosts);
+    setMenuItems(ui->menuReset_Replication_Password, repHosts);
     //Now update the disk menu items
     /*ui->menuRemove_Disk->clear();
     ui->menuSet_Disk_Offline->clear();
@@ -302,17 +336,29 @@ void LPMain::updateTabs(){
     ui->menuSet_Disk_Online->setEnabled(!ui->menuSet_Disk_Online->isEmpty());*/
     
     //Now list the data restore options
-    QString cds = ui->combo_datasets->currentText();
-    ui->combo_datasets->clear();
+    if(newSnaps){
+      reloadSnaps = false;
+      cds = ui->combo_datasets->currentText();
+      ui->combo_datasets->clear();
     
-    ui->menuDelete_Snapshot->clear();
+      ui->menuDelete_Snapshot->clear();
     
-    emit loadSnaps(&POOLDATA); //kickoff the snapshot loading in the background
+      emit loadSnaps(POOLDATA); //kickoff the snapshot loading in the background
+    }
+  }else{
+    POOLDATA = LPDataset();
   }
-  QApplication::processEvents();
   updating = false;
 }
     
+void LPMain::applySnapshots(LPDataset DS){
+  //Only keep the results if the same pool is still shown (the selection may have changed meanwhile)
+  if(DS.zpool != POOLDATA.zpool){ return; }
+  POOLDATA.subsetHash = DS.subsetHash;
+  POOLDATA.snapComment = DS.snapComment;
+  updateSnapshots();
+}
+
 void LPMain::updateSnapshots(){
     qDebug() << "Snapshot data Available";
     QStringList dslist = POOLDATA.subsets();
@@ -461,6 +507,51 @@ void LPMain::restoreFiles(){
   }
 }
 
+void LPMain::showFileMenu(const QPoint &pt){
+  QModelIndex index = ui->treeView->indexAt(pt);
+  if(!index.isValid() || fsModel->isDir(index) ){ return; }
+  QMenu menu(this);
+  menu.addAction(tr("Find Other Versions"), this, SLOT(findFileVersions()) );
+  menu.exec(ui->treeView->viewport()->mapToGlobal(pt));
+}
+
+void LPMain::findFileVersions(){
+  QString filePath = fsModel->filePath(ui->treeView->currentIndex());
+  QString ds = ui->combo_datasets->currentText();
+  QStringList snaps = POOLDATA.snapshots(ds);
+  int sval = ui->slider_snapshots->value();
+  if(filePath.isEmpty() || sval < 0 || sval >= snaps.length()){ return; }
+  //Get the path relative to the snapshot directory
+  QString snapdir = ds+"/.zfs/snapshot/"+snaps[sval]+"/";
+  if(!filePath.startsWith(snapdir)){ return; }
+  QString relpath = filePath.mid(snapdir.length());
+  //Check all the snapshots in the background
+  showWaitBox( QString(tr("Searching snapshots for: %1")).arg(relpath.section("/",-1)) );
+  emit loadVersions(ds, relpath, snaps);
+}
+
+void LPMain::showFileVersions(QString ds, QString relpath){
+  hideWaitBox();
+  if(ds != ui->combo_datasets->currentText()){ return; } //dataset changed in the meantime
+  QStringList snaps = POOLDATA.snapshots(ds);
+  QList<LPFileVersion> versions = LPFileVersions::versions(ds, relpath, snaps); //already cached
+  if(versions.isEmpty()){ return; }
+  QStringList items;
+  int current = 0;
+  QString csnap = snaps.value(ui->slider_snapshots->value());
+  for(int i=0; i<versions.length(); i++){
+    items << QString(tr("%1: %2 (%3)")).arg(versions[i].snapshot, versions[i].modified.toString(Qt::DefaultLocaleShortDate), LPHomePackager::sizeText(versions[i].size));
+    if(versions[i].snapshots.contains(csnap)){ current = i; }
+  }
+  bool ok = false;
+  QString sel = QInputDialog::getItem(this, tr("File Versions"), QString(tr("%1 different versions of %2 were found in %3 snapshots. Select one to view it:")).arg(QString::number(versions.length()), relpath.section("/",-1), QString::number(snaps.length())), items, current, false, &ok);
+  if(!ok || sel.isEmpty()){ return; }
+  //Jump to the first snapshot with that version and select the file
+  QString snap = versions[ items.indexOf(sel) ].snapshot;
+  ui->slider_snapshots->setValue( snaps.indexOf(snap) );
+  ui->treeView->setCurrentIndex( fsModel->index(ds+"/.zfs/snapshot/"+snap+"/"+relpath) );
+}
+
 void LPMain::openConfigGUI(){
   qDebug() << "Open Configuration UI";
   QString ds = ui->combo_pools->currentText();
@@ -707,17 +798,48 @@ void LPMain::menuExtractHomeDir(){
     QMessageBox::warning(this,tr("User Missing"),QString(tr("The user (%1) does not exist on this system. Please create this user first and then try again.")).arg(username) );
     return;
   }
-  //Now extract the package
-  showWaitBox(tr("Extracting Home Directory"));
-  ok = LPGUtils::extractHomeDirPackage(filePath);
-  hideWaitBox();
+  //Now extract the package in the background
+  extractUser = username;
+  if(extractDLG == 0){
+    extractDLG = new QProgressDialog(this);
+    extractDLG->setWindowTitle(tr("Please Wait"));
+    extractDLG->setWindowModality(Qt::WindowModal);
+    extractDLG->setAutoClose(false);
+    extractDLG->setAutoReset(false);
+    connect(extractDLG, SIGNAL(canceled()), extractor, SLOT(cancel()) );
+  }
+  extractDLG->setLabelText(tr("Extracting Home Directory"));
+  extractDLG->setRange(0,0);
+  extractDLG->setValue(0);
+  extractDLG->show();
+  extractor->startExtract(filePath, "/usr/home");
+}
+
+void LPMain::slotExtractProgress(qint64 bytes, qint64 total, int files, int secsLeft){
+  if(extractDLG == 0){ return; }
+  QString msg = tr("Extracting Home Directory");
+  if(total > 0){
+    extractDLG->setRange(0,1000);
+    extractDLG->setValue( qMin(qint64(1000), bytes*1000/total) );
+    msg.append("\n"+QString(tr("%1 of %2")).arg(LPHomePackager::sizeText(bytes), LPHomePackager::sizeText(total)) );
+  }else{
+    msg.append("\n"+LPHomePackager::sizeText(bytes));
+  }
+  msg.append("\n"+QString(tr("%1 files")).arg(QString::number(files)) );
+  if(secsLeft >= 0){ msg.append(", "+QString(tr("%1 remaining")).arg(LPHomePackager::timeText(secsLeft)) ); }
+  extractDLG->setLabelText(msg);
+}
+
+void LPMain::slotExtractFinished(bool ok){
+  bool cancelled = (extractDLG != 0 && extractDLG->wasCanceled());
+  if(extractDLG != 0){ extractDLG->reset(); extractDLG->hide(); }
   //Now report the results
   if(ok){
-    QMessageBox::information(this,tr("Package Extracted"), QString(tr("The package was successfully extracted within %1")).arg("/usr/home/"+username) );
-  }else{
-    QMessageBox::warning(this, tr("Package Failure"), QString(tr("The package could not be extracted within %1")).arg("/usr/home/"+username) );
+    QMessageBox::information(this,tr("Package Extracted"), QString(tr("The package was successfully extracted within %1")).arg("/usr/home/"+extractUser) );
+  }else if(!cancelled){
+    qDebug() << "Extraction errors:" << extractor->errors();
+    QMessageBox::warning(this, tr("Package Failure"), QString(tr("The package could not be extracted within %1")).arg("/usr/home/"+extractUser) );
   }
-  
 }
 
 // ==== Disks Menu ====
@@ -872,6 +994,8 @@ void LPMain::menuRemoveSnapshot(QAction *act){
   //verify snapshot removal
   if( QMessageBox::Yes == QMessageBox::question(this,tr("Verify Snapshot Deletion"),QString(tr("Do you wish to delete this snapshot? %1 (%2)")).arg(pool+"/"+snapshot, comment)+"\n"+tr("WARNING: This is a permanant change that cannot be reversed"),QMessageBox::Yes | QMessageBox::No, QMessageBox::No) ){
     bool ok = LPBackend::removeSnapshot(ui->combo_pools->currentText(), snapshot);
+    LPFileVersions::clearCache(); //a new snapshot could re-use the name
+    reloadSnaps = true;
     if(ok){
       QMessageBox::information(this,tr("Snapshot Removed"),tr("The snapshot was successfully deleted"));
     }else{
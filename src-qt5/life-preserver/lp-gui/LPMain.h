@@ -17,6 +17,8 @@
 #include <QFileSystemWatcher>
 #include <QSettings>
 #include <QThread>
+#include <QProgressDialog>
+#include <QMenu>
 
 #include "LPBackend.h"
 #include "LPContainers.h"
@@ -46,11 +48,17 @@ private:
 	QFileSystemModel *fsModel;
 	bool poolSelected;
 	LPDataset POOLDATA;
+	QHash<QString, LPDataset> POOLSAMPLE; //status of all the managed pools from the last refresh
 	QMessageBox *waitBox;
 	QFileSystemWatcher *watcher;
 	QTimer *timer;
 	QSettings *settings;
 	LPClassic *classicDLG;
+	LPHomePackager *extractor;
+	QProgressDialog *extractDLG;
+	QString extractUser; //user of the home dir package being extracted
+	bool stateLoading, stateDirty; //background pool state load running/requested again
+	bool reloadSnaps; //snapshot list changed (not visible in the pool status)
 
 	QThread *WorkThread;
 	BackgroundWorker *WORKER;
@@ -59,12 +67,16 @@ private:
 
 	void showErrorDialog(QString title, QString message, QString errors);
 	void showWaitBox(QString message);
+	void setMenuItems(QMenu *menu, QStringList items);
 	void hideWaitBox();
 
 private slots:
-	void updatePoolList();  //re-load available pools
+	void updatePoolList();  //re-load available pools (in the background)
+	void applyPoolState(LPPoolState); //new pool lists/status are available
 	void viewChanged();
-	void updateTabs();      //load current pool info and update tabs
+	void updateTabs();      //re-load the pool info and update tabs
+	void showTabs();        //update tabs for the current pool (from the last sample if available)
+	void applySnapshots(LPDataset); //new snapshot info is available
 	void updateSnapshots(); //load the current snapshot info into the UI
 	void updateDataset();  //restore dataset changed
 	void updateSnapshot(); //selected snapshot changed
@@ -72,6 +84,9 @@ private slots:
 	void prevSnapshot();
 	void setFileVisibility();
 	void restoreFiles();
+	void showFileMenu(const QPoint&);
+	void findFileVersions(); //versions of the current file in all the snapshots
+	void showFileVersions(QString, QString);
 	void openConfigGUI();
 	void autoRefresh();
 	// -- Menu Actions --
@@ -84,6 +99,8 @@ private slots:
 	//Classic Backups
 	void menuCompressHomeDir(QAction*);
 	void menuExtractHomeDir();
+	void slotExtractProgress(qint64, qint64, int, int);
+	void slotExtractFinished(bool);
 	//Disk Menu
 	//void menuAddDisk();
 	//void menuRemoveDisk(QAction*);
@@ -99,7 +116,9 @@ private slots:
 	void menuResetReplicationPassword(QAction*);
 
 signals:
-	void loadSnaps(LPDataset*);
+	void loadSnaps(LPDataset);
+	void loadPoolState();
+	void loadVersions(QString, QString, QStringList);
 	
 };
 
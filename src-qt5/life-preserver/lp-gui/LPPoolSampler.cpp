@@ -0,0 +1,165 @@
+#include "LPPoolSampler.h"
+#include "LPBackend.h"
+
+#include <QObject>
+#include <QRegExp>
+
+QHash<QString, LPDataset> LPPoolSampler::sample(QStringList pools){
+  QHash<QString, LPDataset> out;
+  if(pools.isEmpty()){ return out; }
+  out = parseZpoolStatus( LPBackend::getCmdOutput("zpool status "+pools.join(" ")) );
+  //Make sure every requested pool has an entry (even if zpool did not report it)
+  for(int i=0; i<pools.length(); i++){
+    if(!out.contains(pools[i])){ out[pools[i]].zpool = pools[i]; }
+  }
+  //Only the pools which were asked for
+  QList<QString> found = out.keys();
+  for(int i=0; i<found.length(); i++){
+    if(!pools.contains(found[i])){ out.remove(found[i]); }
+  }
+  //Latest Snapshot/Replication information
+  QStringList repTargets;
+  bool haveTargets = false;
+  QStringList lpstat = LPBackend::listCurrentStatus();
+  for(int i=0; i<lpstat.length() && !haveTargets; i++){
+    if(lpstat[i].section(":::",2,2)=="-" && out.contains(lpstat[i].section(":::",0,0)) ){
+      repTargets = LPBackend::listReplicationTargets();
+      haveTargets = true;
+    }
+  }
+  applyStatus(out, lpstat, &repTargets);
+  return out;
+}
+
+QHash<QString, LPDataset> LPPoolSampler::parseZpoolStatus(QStringList zstat){
+  QHash<QString, LPDataset> out;
+  QString zpool;
+  bool atheader = false;
+  QStringList scanlines;
+  QHash<QString, QStringList> running, errors, finished;
+  QRegExp label("^\\s*[a-z]+:.*"); //start of the next section ("config:", "errors:", ...)
+  for(int i=0; i<zstat.length(); i++){
+    QString line = zstat[i];
+    if(line.trimmed().isEmpty()){ continue; }
+    if(line.startsWith("  pool:")){
+      zpool = line.section(":",1,-1).simplified();
+      out[zpool].zpool = zpool;
+      atheader = false;
+      scanlines.clear();
+      continue;
+    }
+    if(zpool.isEmpty()){ continue; }
+    LPDataset &DSC = out[zpool];
+    if(line.startsWith("  scan:")){
+      scanlines << line.section(":",1,-1);
+      //Progress for a running scan is on the lines below (indented, no "<label>:" prefix)
+      while(i+1<zstat.length() && !zstat[i+1].trimmed().isEmpty() && !label.exactMatch(zstat[i+1]) ){
+        i++; scanlines << zstat[i];
+      }
+      DSC.scan = parseScan(scanlines);
+      scanlines.clear();
+      LPScanStatus &S = DSC.scan;
+      if(S.type==LPScanStatus::Scrub){
+        if(S.running){
+          if(S.percent >= 0){ running[zpool] << QString(QObject::tr("Scrub Started: %1 (%2% done, %3 to go)")).arg(S.timestamp, QString::number(S.percent, 'f', 1), S.eta); }
+          else{ running[zpool] << QString(QObject::tr("Scrub Started: %1")).arg(S.timestamp); }
+        }else if(S.paused){
+          if(S.percent >= 0){ running[zpool] << QString(QObject::tr("Scrub Paused: %1 (%2% done)")).arg(S.timestamp, QString::number(S.percent, 'f', 1)); }
+          else{ running[zpool] << QString(QObject::tr("Scrub Paused: %1")).arg(S.timestamp); }
+        }else if(S.cancelled){ finished[zpool] << QString(QObject::tr("Scrub Cancelled: %1")).arg(S.timestamp); }
+        else{ finished[zpool] << QString(QObject::tr("Scrub Finished: %1 (%2 errors)")).arg(S.timestamp, S.errors); }
+      }else if(S.type==LPScanStatus::Resilver){
+        if(S.running){
+          if(S.percent >= 0){ running[zpool] << QString(QObject::tr("Resilver Started: %1 (%2% done, %3 to go)")).arg(S.timestamp, QString::number(S.percent, 'f', 1), S.eta); }
+          else{ running[zpool] << QString(QObject::tr("Resilver Started: %1")).arg(S.timestamp); }
+        }else{ finished[zpool] << QString(QObject::tr("Resilver Finished: %1 (%2 errors)")).arg(S.timestamp, S.errors); }
+      }
+    }else if(line.contains("NAME") && line.contains("STATE") && line.contains("READ") ){
+      atheader=true;
+    }else if(line.startsWith("errors:")){
+      atheader=false;
+    }else if(atheader){
+      line = line.replace("\t"," ").simplified();
+      QString dev = line.section(" ",0,0,QString::SectionSkipEmpty);
+      QString state = line.section(" ",1,1,QString::SectionSkipEmpty);
+      if(dev == zpool){
+	DSC.poolStatus = state;
+      }else if(line.contains("(resilvering)")){
+	DSC.harddisks << dev; DSC.harddiskStatus << state; //record this disk and state
+	running[zpool] << QString(QObject::tr("%1: Currently Resilvering")).arg(dev);
+      }else{
+	DSC.harddisks << dev; DSC.harddiskStatus << state; //record this disk and state
+	if(state != "ONLINE"){
+	  errors[zpool] << QString(QObject::tr("%1: %2")).arg(dev, state);
+	}
+      }
+    }
+  }
+  QList<QString> pools = out.keys();
+  for(int i=0; i<pools.length(); i++){
+    out[pools[i]].runningStatus = running.value(pools[i]).join("\n");
+    out[pools[i]].errorStatus = errors.value(pools[i]).join("\n");
+    out[pools[i]].finishedStatus = finished.value(pools[i]).join("\n");
+  }
+  return out;
+}
+
+LPScanStatus LPPoolSampler::parseScan(QStringList lines){
+  //Examples of the first line:
+  // "scrub repaired 0 in 1h2m with 0 errors on Sun Mar  1 03:02:47 2015"
+  // "scrub in progress since Sun Mar  1 02:00:01 2015"
+  // "scrub canceled on Sun Mar  1 02:10:00 2015"
+  // "scrub paused since Sun Mar  1 02:10:00 2015" (continues with "scrub started on ...")
+  // "resilvered 1.23G in 0h5m with 0 errors on Sun Mar  1 03:02:47 2015"
+  // "resilver in progress since Sun Mar  1 02:00:01 2015"
+  // Running scans continue with: "12.3G scanned out of 100G at 50.2M/s, 0h30m to go" and "..., 12.30% done"
+  LPScanStatus S;
+  if(lines.isEmpty()){ return S; }
+  QString first = lines[0].replace("\t"," ").simplified();
+  QString rest = QStringList(lines.mid(1)).join(" ").replace("\t"," ").simplified();
+  if(first.startsWith("scrub")){ S.type = LPScanStatus::Scrub; }
+  else if(first.startsWith("resilver")){ S.type = LPScanStatus::Resilver; }
+  else{ return S; } //"none requested" or unknown
+  S.running = first.contains(" in progress ");
+  S.paused = first.contains(" paused ");
+  S.cancelled = first.contains(" cancel");
+  //The timestamp is everything after the keyword (the date format depends on the locale)
+  QRegExp stamp(" (since|on) (.+)$");
+  if(stamp.indexIn(first) >= 0){ S.timestamp = stamp.cap(2); }
+  QRegExp errs(" with (\\d+) errors");
+  if(errs.indexIn(first) >= 0){ S.errors = errs.cap(1); }
+  if(S.running || S.paused){
+    QRegExp pct("([\\d.]+)% done");
+    if(pct.indexIn(rest) >= 0){ S.percent = pct.cap(1).toDouble(); }
+  }
+  if(S.running){
+    QRegExp rate(" at (\\S+/s)");
+    if(rate.indexIn(rest) >= 0){ S.rate = rate.cap(1); }
+    QRegExp eta("(\\S+) to go");
+    if(eta.indexIn(rest) >= 0){ S.eta = eta.cap(1); }
+  }
+  return S;
+}
+
+void LPPoolSampler::applyStatus(QHash<QString, LPDataset> &pools, QStringList lpstat, QStringList *repTargets){
+  //lpstat: output of LPBackend::listCurrentStatus() (<pool>:::<lastsnap>:::<lastrep>:::<target>)
+  for(int i=0; i<lpstat.length(); i++){
+    QString zpool = lpstat[i].section(":::",0,0);
+    if(!pools.contains(zpool)){ continue; }
+    LPDataset &DSC = pools[zpool];
+    QString lastSnap = lpstat[i].section(":::",1,1);
+    QString lastRep = lpstat[i].section(":::",2,2);
+    QString reptarget = lpstat[i].section(":::",3,3);
+    if(lastSnap=="-"){ DSC.latestSnapshot = QObject::tr("No Snapshots Available"); }
+    else{ DSC.latestSnapshot = lastSnap; }
+    if(lastRep!="-"){
+      if(!DSC.finishedStatus.isEmpty()){ DSC.finishedStatus.append("\n"); }
+      DSC.finishedStatus.append( QString(QObject::tr("Latest Replication: %1")).arg(lastRep) );
+    }else if(repTargets!=0 && repTargets->contains(zpool) ){
+      if(!DSC.errorStatus.isEmpty()){ DSC.errorStatus.append("\n"); }
+      DSC.errorStatus.append( QObject::tr("No Successful Replication") );
+    }
+    if(reptarget=="-"){ DSC.repHost.clear(); }
+    else{ DSC.repHost << reptarget; }
+  }
+}
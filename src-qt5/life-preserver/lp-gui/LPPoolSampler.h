@@ -0,0 +1,23 @@
+#ifndef _LP_POOL_SAMPLER_H
+#define _LP_POOL_SAMPLER_H
+
+#include <QHash>
+#include <QStringList>
+#include <QString>
+
+#include "LPContainers.h"
+
+//Gathers the status of several pools in one pass:
+// one "zpool status" for all the pools, one "lpreserver status", and the list of
+// replicated pools only if it is needed (at most once per sample)
+class LPPoolSampler{
+public:
+	static QHash<QString, LPDataset> sample(QStringList pools);
+
+	//Parsers for the command output (split out so they can be checked against saved output)
+	static QHash<QString, LPDataset> parseZpoolStatus(QStringList lines);
+	static LPScanStatus parseScan(QStringList lines); //"scan:" line + its continuation lines
+	static void applyStatus(QHash<QString, LPDataset> &pools, QStringList lpstat, QStringList *repTargets);
+};
+
+#endif
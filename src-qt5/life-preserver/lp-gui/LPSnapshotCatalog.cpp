@@ -0,0 +1,98 @@
+#include "LPSnapshotCatalog.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtAlgorithms>
+
+//Beyond this many new snapshots a full directory listing is cheaper than checking each one
+#define MAX_SNAP_PROBES 64
+
+void LPSnapshotCatalog::sync(QStringList lpsnaps, QStringList mountpoints){
+  //Figure out which snapshots are new or have been removed since the last sync
+  QHash<QString, int> newIndex;
+  QStringList added;
+  for(int i=0; i<lpsnaps.length(); i++){
+    newIndex.insert(lpsnaps[i], i);
+    if( !orderIndex.contains(lpsnaps[i]) ){ added << lpsnaps[i]; }
+  }
+  for(int i=0; i<order.length(); i++){
+    if(newIndex.contains(order[i])){ continue; }
+    //Snapshot was destroyed - drop it from every mountpoint
+    QList<QString> mounts = snapMounts.value(order[i]).toList();
+    for(int m=0; m<mounts.length(); m++){
+      mountSnaps[mounts[m]].remove(order[i]);
+      if(mountSnaps[mounts[m]].isEmpty()){ nonEmpty.remove(mounts[m]); } //nothing left to restore
+    }
+    snapMounts.remove(order[i]);
+  }
+  order = lpsnaps;
+  orderIndex = newIndex;
+  //Drop any mountpoints which are gone
+  QSet<QString> current = mountpoints.toSet();
+  QList<QString> known = mountSnaps.keys();
+  for(int i=0; i<known.length(); i++){
+    if( !current.contains(known[i]) ){ removeMountpoint(known[i]); }
+  }
+  //Now look for the new snapshots on disk
+  for(int i=0; i<mountpoints.length(); i++){
+    QString mp = mountpoints[i];
+    if( !mountSnaps.contains(mp) || added.length() > MAX_SNAP_PROBES ){ scanMountpoint(mp); continue; }
+    for(int s=0; s<added.length(); s++){
+      if( QFileInfo(mp+"/.zfs/snapshot/"+added[s]).exists() ){ addEntry(added[s], mp); }
+    }
+  }
+}
+
+void LPSnapshotCatalog::clear(){
+  order.clear();
+  orderIndex.clear();
+  snapMounts.clear();
+  mountSnaps.clear();
+  nonEmpty.clear();
+}
+
+QStringList LPSnapshotCatalog::mountpoints(){
+  return QStringList(nonEmpty.toList());
+}
+
+QStringList LPSnapshotCatalog::snapshots(QString mountpoint){
+  QList<int> index;
+  QList<QString> snaps = mountSnaps.value(mountpoint).toList();
+  for(int i=0; i<snaps.length(); i++){ index << orderIndex.value(snaps[i]); }
+  qSort(index);
+  QStringList out;
+  for(int i=0; i<index.length(); i++){ out << order[index[i]]; }
+  return out;
+}
+
+QStringList LPSnapshotCatalog::mountpointsFor(QString snapshot){
+  return QStringList(snapMounts.value(snapshot).toList());
+}
+
+//=========
+//  PRIVATE
+//=========
+void LPSnapshotCatalog::addEntry(QString snap, QString mountpoint){
+  snapMounts[snap].insert(mountpoint);
+  mountSnaps[mountpoint].insert(snap);
+  nonEmpty.insert(mountpoint);
+}
+
+void LPSnapshotCatalog::removeMountpoint(QString mountpoint){
+  QList<QString> snaps = mountSnaps.value(mountpoint).toList();
+  for(int i=0; i<snaps.length(); i++){ snapMounts[snaps[i]].remove(mountpoint); }
+  mountSnaps.remove(mountpoint);
+  nonEmpty.remove(mountpoint);
+}
+
+void LPSnapshotCatalog::scanMountpoint(QString mountpoint){
+  removeMountpoint(mountpoint);
+  mountSnaps.insert(mountpoint, QSet<QString>()); //mark it as scanned
+  QDir dir(mountpoint+"/.zfs/snapshot");
+  if( !dir.exists() ){ return; }
+  QStringList list = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Unsorted);
+  //only list the valid snapshots that life preserver created
+  for(int i=0; i<list.length(); i++){
+    if( orderIndex.contains(list[i]) ){ addEntry(list[i], mountpoint); }
+  }
+}
@@ -0,0 +1,36 @@
+#ifndef _LP_SNAPSHOT_CATALOG_H
+#define _LP_SNAPSHOT_CATALOG_H
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QString>
+
+//Index of which life-preserver snapshots are available under which dataset mountpoints
+// This is kept around between refreshes so that only new snapshots/mountpoints need to be looked up on disk
+class LPSnapshotCatalog{
+public:
+	LPSnapshotCatalog(){}
+	~LPSnapshotCatalog(){}
+
+	//Bring the catalog up to date with the current snapshot list (oldest -> newest) and mounted subsets
+	void sync(QStringList lpsnaps, QStringList mountpoints);
+	void clear();
+
+	QStringList mountpoints(); //mountpoints which have snapshots available
+	QStringList snapshots(QString mountpoint); //life-preserver snapshots for a mountpoint (oldest -> newest)
+	QStringList mountpointsFor(QString snapshot); //mountpoints where a snapshot is available
+
+private:
+	QStringList order; //life-preserver snapshots, oldest -> newest
+	QHash<QString, int> orderIndex; //snapshot -> position in "order"
+	QHash<QString, QSet<QString> > snapMounts; //snapshot -> mountpoints
+	QHash<QString, QSet<QString> > mountSnaps; //mountpoint -> snapshots (life-preserver ones only)
+	QSet<QString> nonEmpty; //mountpoints with at least one life-preserver snapshot
+
+	void addEntry(QString snap, QString mountpoint);
+	void removeMountpoint(QString mountpoint);
+	void scanMountpoint(QString mountpoint); //full listing of <mountpoint>/.zfs/snapshot
+};
+
+#endif
@@ -15,6 +15,10 @@ HEADERS	+= LPBackend.h \
 		LPGUtils.h \
 		LPClassic.h \
 		LPISCSIWizard.h \
+		LPSnapshotCatalog.h \
+		LPPoolSampler.h \
+		LPHomePackager.h \
+		LPFileVersions.h \
 		BackgroundWorker.h
 		
 SOURCES	+= main.cpp \
@@ -24,7 +28,11 @@ SOURCES	+= main.cpp \
 		LPMain.cpp \
 		LPGUtils.cpp \
 		LPClassic.cpp \
-		LPISCSIWizard.cpp
+		LPISCSIWizard.cpp \
+		LPSnapshotCatalog.cpp \
+		LPPoolSampler.cpp \
+		LPHomePackager.cpp \
+		LPFileVersions.cpp
 
 RESOURCES += lPreserve.qrc
 
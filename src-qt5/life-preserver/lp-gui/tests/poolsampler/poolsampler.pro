@@ -0,0 +1,19 @@
+QT       += core widgets testlib
+CONFIG   += testcase console
+
+TARGET = tst_poolsampler
+TEMPLATE = app
+
+LIBS += -L$$_PRO_FILE_PWD_/../../../../libpcbsd -L/usr/local/lib -lpcbsd-utils
+QMAKE_RPATHDIR += $$_PRO_FILE_PWD_/../../../../libpcbsd
+INCLUDEPATH += ../.. ../../../../libpcbsd/utils /usr/local/include
+
+HEADERS += ../../LPBackend.h \
+	../../LPContainers.h \
+	../../LPPoolSampler.h
+
+SOURCES += tst_poolsampler.cpp \
+	../../LPBackend.cpp \
+	../../LPPoolSampler.cpp
+
+OTHER_FILES += zpool-status.txt
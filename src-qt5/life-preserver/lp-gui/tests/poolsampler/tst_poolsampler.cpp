@@ -0,0 +1,144 @@
+#include <QtTest>
+#include <QFile>
+
+#include "LPPoolSampler.h"
+
+//Checks the pool status parsers against saved "zpool status" output
+class tst_PoolSampler : public QObject{
+	Q_OBJECT
+private:
+	QHash<QString, LPDataset> pools;
+
+private slots:
+	void initTestCase();
+	void scrubRunning();
+	void scrubPaused();
+	void resilverRunning();
+	void scrubFinished();
+	void scanLines_data();
+	void scanLines();
+	void replicationStatus();
+};
+
+void tst_PoolSampler::initTestCase(){
+  QFile file(QFINDTESTDATA("zpool-status.txt"));
+  QVERIFY( file.open(QIODevice::ReadOnly | QIODevice::Text) );
+  pools = LPPoolSampler::parseZpoolStatus( QString(file.readAll()).split("\n") );
+  QStringList names = pools.keys();
+  names.sort();
+  QCOMPARE( names, QStringList() << "backup" << "data" << "tank" << "zroot" );
+}
+
+void tst_PoolSampler::scrubRunning(){
+  LPDataset DS = pools["tank"];
+  QCOMPARE( DS.zpool, QString("tank") );
+  QCOMPARE( DS.poolStatus, QString("ONLINE") );
+  QCOMPARE( DS.harddisks, QStringList() << "mirror-0" << "ada0p2" << "ada1p2" );
+  QCOMPARE( DS.harddiskStatus, QStringList() << "ONLINE" << "ONLINE" << "ONLINE" );
+  QCOMPARE( DS.scan.type, LPScanStatus::Scrub );
+  QVERIFY( DS.scan.running );
+  QVERIFY( !DS.scan.paused );
+  QCOMPARE( DS.scan.percent, 12.3 );
+  QCOMPARE( DS.scan.rate, QString("50.2M/s") );
+  QCOMPARE( DS.scan.eta, QString("0h30m") );
+  QCOMPARE( DS.scan.timestamp, QString("Sun Mar 1 02:00:01 2015") );
+  QCOMPARE( DS.runningStatus, QString("Scrub Started: Sun Mar 1 02:00:01 2015 (12.3% done, 0h30m to go)") );
+  QVERIFY( DS.errorStatus.isEmpty() );
+  QVERIFY( DS.finishedStatus.isEmpty() );
+}
+
+void tst_PoolSampler::scrubPaused(){
+  LPDataset DS = pools["backup"];
+  QCOMPARE( DS.poolStatus, QString("DEGRADED") );
+  QCOMPARE( DS.scan.type, LPScanStatus::Scrub );
+  QVERIFY( !DS.scan.running );
+  QVERIFY( DS.scan.paused );
+  QVERIFY( !DS.scan.cancelled );
+  QCOMPARE( DS.scan.percent, 30.27 );
+  QVERIFY( DS.scan.eta.isEmpty() );
+  //Paused is not finished - it stays in the running list
+  QCOMPARE( DS.runningStatus, QString("Scrub Paused: Mon Mar 2 10:15:00 2015 (30.3% done)") );
+  QVERIFY( DS.finishedStatus.isEmpty() );
+  QCOMPARE( DS.harddisks, QStringList() << "raidz1-0" << "ada2" << "ada3" << "8734983749837498374" );
+  QCOMPARE( DS.errorStatus, QString("raidz1-0: DEGRADED\n8734983749837498374: UNAVAIL") );
+}
+
+void tst_PoolSampler::resilverRunning(){
+  LPDataset DS = pools["data"];
+  QCOMPARE( DS.scan.type, LPScanStatus::Resilver );
+  QVERIFY( DS.scan.running );
+  QCOMPARE( DS.scan.percent, 22.54 );
+  QCOMPARE( DS.scan.rate, QString("100M/s") );
+  QCOMPARE( DS.runningStatus, QString("Resilver Started: Tue Mar 3 08:00:00 2015 (22.5% done, 0h26m to go)\nada7: Currently Resilvering") );
+  QCOMPARE( DS.harddisks, QStringList() << "mirror-0" << "ada6" << "replacing-1" << "ada7/old" << "ada7" );
+  QCOMPARE( DS.errorStatus, QString("mirror-0: DEGRADED\nreplacing-1: DEGRADED\nada7/old: UNAVAIL") );
+}
+
+void tst_PoolSampler::scrubFinished(){
+  LPDataset DS = pools["zroot"];
+  QCOMPARE( DS.scan.type, LPScanStatus::Scrub );
+  QVERIFY( !DS.scan.running );
+  QVERIFY( !DS.scan.paused );
+  QCOMPARE( DS.scan.percent, -1.0 );
+  QCOMPARE( DS.scan.errors, QString("0") );
+  QCOMPARE( DS.finishedStatus, QString("Scrub Finished: Sun Mar 1 03:02:47 2015 (0 errors)") );
+  QVERIFY( DS.runningStatus.isEmpty() );
+  QCOMPARE( DS.harddisks, QStringList() << "ada5p3" );
+}
+
+void tst_PoolSampler::scanLines_data(){
+  QTest::addColumn<QStringList>("lines");
+  QTest::addColumn<int>("type");
+  QTest::addColumn<bool>("running");
+  QTest::addColumn<bool>("paused");
+  QTest::addColumn<bool>("cancelled");
+  QTest::addColumn<QString>("timestamp");
+  QTest::addColumn<QString>("errors");
+
+  QTest::newRow("none") << (QStringList() << " none requested") << int(LPScanStatus::None) << false << false << false << QString() << QString();
+  QTest::newRow("empty") << QStringList() << int(LPScanStatus::None) << false << false << false << QString() << QString();
+  QTest::newRow("canceled") << (QStringList() << " scrub canceled on Sun Mar  1 02:10:00 2015") << int(LPScanStatus::Scrub) << false << false << true << QString("Sun Mar 1 02:10:00 2015") << QString();
+  QTest::newRow("resilvered") << (QStringList() << " resilvered 1.23G in 0h5m with 2 errors on Sun Mar  1 03:02:47 2015") << int(LPScanStatus::Resilver) << false << false << false << QString("Sun Mar 1 03:02:47 2015") << QString("2");
+  QTest::newRow("paused-no-progress") << (QStringList() << "\tscrub paused since Mon Mar  2 10:15:00 2015") << int(LPScanStatus::Scrub) << false << true << false << QString("Mon Mar 2 10:15:00 2015") << QString();
+}
+
+void tst_PoolSampler::scanLines(){
+  QFETCH(QStringList, lines);
+  QFETCH(int, type);
+  QFETCH(bool, running);
+  QFETCH(bool, paused);
+  QFETCH(bool, cancelled);
+  QFETCH(QString, timestamp);
+  QFETCH(QString, errors);
+  LPScanStatus S = LPPoolSampler::parseScan(lines);
+  QCOMPARE( int(S.type), type );
+  QCOMPARE( S.running, running );
+  QCOMPARE( S.paused, paused );
+  QCOMPARE( S.cancelled, cancelled );
+  QCOMPARE( S.timestamp, timestamp );
+  QCOMPARE( S.errors, errors );
+  QCOMPARE( S.percent, -1.0 );
+}
+
+void tst_PoolSampler::replicationStatus(){
+  QHash<QString, LPDataset> sample = pools;
+  QStringList lpstat;
+  lpstat << "tank:::tank@auto-2015-03-01-02-00-00:::-:::backuphost"
+	 << "zroot:::-:::2015-03-01 03:30:00:::-"
+	 << "other:::other@auto:::-:::-"; //not sampled, ignored
+  QStringList targets;
+  targets << "tank";
+  LPPoolSampler::applyStatus(sample, lpstat, &targets);
+  QVERIFY( !sample.contains("other") );
+
+  QCOMPARE( sample["tank"].latestSnapshot, QString("tank@auto-2015-03-01-02-00-00") );
+  QCOMPARE( sample["tank"].errorStatus, QString("No Successful Replication") );
+  QCOMPARE( sample["tank"].repHost, QStringList() << "backuphost" );
+
+  QCOMPARE( sample["zroot"].latestSnapshot, QString("No Snapshots Available") );
+  QCOMPARE( sample["zroot"].finishedStatus, QString("Scrub Finished: Sun Mar 1 03:02:47 2015 (0 errors)\nLatest Replication: 2015-03-01 03:30:00") );
+  QVERIFY( sample["zroot"].repHost.isEmpty() );
+}
+
+QTEST_GUILESS_MAIN(tst_PoolSampler)
+#include "tst_poolsampler.moc"
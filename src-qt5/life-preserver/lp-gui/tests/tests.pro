@@ -0,0 +1,4 @@
+# Unit tests for lp-gui (run with "qmake && make check" after building libpcbsd)
+TEMPLATE = subdirs
+
+SUBDIRS += poolsampler
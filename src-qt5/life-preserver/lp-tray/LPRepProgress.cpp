@@ -0,0 +1,92 @@
+#include "LPRepProgress.h"
+
+#include <QObject>
+
+// Weight of the newest rate sample in the smoothed rate
+const static double rateSmoothing = 0.2;
+// Time without any data sent before a replication is flagged as stalled
+const static int stallTime = 120; // 2 minutes
+
+LPRepProgress::LPRepProgress(){
+  clear();
+}
+
+void LPRepProgress::clear(){
+  snapshot.clear();
+  sent = total = 0;
+  rate = avgRate = 0;
+  done = false;
+  lastRecord = lastProgress = 0;
+}
+
+bool LPRepProgress::parseLine(QString line){
+  QStringList rec = line.simplified().split(" ");
+  if(rec.length() < 7 || (rec[0]!="PROGRESS" && rec[0]!="DONE") ){ return false; }
+  bool ok = true;
+  qint64 time = rec[1].toLongLong(&ok);
+  if(!ok){ return false; }
+  qint64 nsent = rec[3].toLongLong();
+  qint64 ntotal = rec[4].toLongLong();
+  if(rec[2] != snapshot && !snapshot.isEmpty() && nsent < sent){
+    //New stream (next dataset): start over
+    clear();
+  }
+  if(lastProgress==0 || nsent > sent){ lastProgress = time; }
+  snapshot = rec[2];
+  sent = nsent;
+  total = ntotal;
+  avgRate = rec[6].toDouble();
+  done = (rec[0]=="DONE");
+  if(!done){
+    //Exponential smoothing of the current rate (a single slow second should not change the ETA much)
+    double cur = rec[5].toDouble();
+    if(rate <= 0){ rate = cur; }
+    else{ rate = rateSmoothing*cur + (1-rateSmoothing)*rate; }
+  }
+  lastRecord = time;
+  return true;
+}
+
+double LPRepProgress::percent(){
+  if(total <= 0){ return -1; }
+  double p = (sent*100.0)/total;
+  if(p > 100){ p = 100; } //the total is only an estimate
+  return int(p*10)/10.0; //round to 1 decimel places
+}
+
+int LPRepProgress::secsLeft(){
+  if(done){ return 0; }
+  double r = (rate > 0) ? rate : avgRate;
+  if(total <= 0 || r <= 0){ return -1; }
+  if(sent >= total){ return 0; }
+  return int( (total-sent)/r );
+}
+
+bool LPRepProgress::isStalled(qint64 now){
+  if(done || lastProgress == 0){ return false; }
+  return ( (now - lastProgress) > stallTime );
+}
+
+QString LPRepProgress::summary(){
+  QString txt = bytesToDisplay(sent)+"/"+(total>0 ? bytesToDisplay(total) : QString("??"));
+  if(percent() >= 0){ txt.append(" ("+QString::number(percent())+"%)"); }
+  if(!done && rate > 0){ txt.append(", "+bytesToDisplay(rate)+"/s"); }
+  int secs = secsLeft();
+  if(!done && secs >= 0){ txt.append(", "+QString(QObject::tr("%1 left")).arg(timeToDisplay(secs)) ); }
+  return txt;
+}
+
+QString LPRepProgress::bytesToDisplay(double bytes){
+  QStringList labels;
+    labels << "B" << "K" << "M" << "G" << "T" << "P" << "E";
+  int i=0;
+  while( bytes >= 1024 && i < labels.length()-1 ){
+    bytes = bytes/1024;
+    i++;
+  }
+  return QString::number( int(bytes*10)/10.0 )+labels[i];
+}
+
+QString LPRepProgress::timeToDisplay(int secs){
+  return QString("%1:%2:%3").arg(secs/3600).arg((secs%3600)/60, 2, 10, QChar('0')).arg(secs%60, 2, 10, QChar('0'));
+}
@@ -0,0 +1,34 @@
+#ifndef _LP_REP_PROGRESS_H
+#define _LP_REP_PROGRESS_H
+
+#include <QString>
+#include <QStringList>
+
+//Progress of a running replication, built from the records that lpreserver writes
+// to /var/log/lpreserver/lastrep-progress (one per line, sizes in bytes, rates in bytes/sec):
+//   PROGRESS <unix time> <snapshot> <sent> <total> <current rate> <average rate>
+//   DONE <unix time> <snapshot> <sent> <total> 0 <average rate>
+class LPRepProgress{
+public:
+	LPRepProgress();
+	~LPRepProgress(){}
+
+	void clear();
+	bool parseLine(QString line); //returns false if the line is not a progress record
+
+	QString snapshot; //dataset@snapshot currently being sent
+	qint64 sent, total; //bytes (total is the zfs send estimate, 0 if unknown)
+	double rate, avgRate; //smoothed/average transfer rate (bytes/sec)
+	bool done; //stream finished
+	qint64 lastRecord, lastProgress; //unix time of the last record / last time the byte count went up
+
+	double percent(); //-1 if unknown
+	int secsLeft(); //-1 if unknown
+	bool isStalled(qint64 now); //no data sent for a while (but the stream is not done)
+	QString summary(); //"1.2G/10G (12%), 50M/s, 0:03:00 left"
+
+	static QString bytesToDisplay(double bytes); //"1.2G"
+	static QString timeToDisplay(int secs); //"h:mm:ss"
+};
+
+#endif
@@ -33,6 +33,10 @@ const static int sysCheckTime = 300000; // 5 minutes
 const static int activeCheckTime = 60000; // 1 minute
 // "startup" time allotted before polling begins.
 const static int startupTime = 30000; // 30 seconds.
+// Minimum time between two "zpool status" probes (extra requests are merged)
+const static int minPoolCheckTime = 10000; // 10 seconds
+// Interval to check a running replication for stalls (no progress records needed)
+const static int repStallCheckTime = 30000; // 30 seconds
 // "Disabled" timer value
 const static int disabledTime = INT_MAX; // 10 minutes
 
@@ -41,19 +45,30 @@ LPWatcher::LPWatcher() : QObject(){
   FILE_LOG = "/var/log/lpreserver/lpreserver.log";
   FILE_ERROR="/var/log/lpreserver/error.log";
   FILE_REPLICATION=""; //this is set automatically based on the log file outputs
+  FILE_REPCONF="/var/db/lpreserver/replication"; //replication tasks (lpreserver REPCONF)
   //initialize the watcher and timer
   watcher = new QFileSystemWatcher(this);
     connect(watcher, SIGNAL(fileChanged(QString)),this,SLOT(fileChanged(QString)) );
   timer = new QTimer();
-    connect(timer, SIGNAL(timeout()), this, SLOT(checkPoolStatus()) );
+    connect(timer, SIGNAL(timeout()), this, SLOT(requestPoolStatus()) );
+  poolTimer = new QTimer(this);
+    poolTimer->setSingleShot(true);
+    connect(poolTimer, SIGNAL(timeout()), this, SLOT(checkPoolStatus()) );
+  poolCheckRunning = poolCheckPending = poolCheckNow = false;
   iniTimer = new QTimer();
     connect(iniTimer, SIGNAL(timeout()), this, SLOT(endInitPhase()) );
     iniTimer->setSingleShot(true);
   //initialize the log file reader
   logfile = new QFile(FILE_LOG, this);
-  LFSTREAM = new QTextStream(logfile);
+  logOffset = 0;
+  repPoolsValid = false;
+  repConfSize = -1;
   //initialize the replication file reader
   repfile = new QFile(this);
+  repStructured = false;
+  repTimer = new QTimer(this);
+    repTimer->setInterval(repStallCheckTime);
+    connect(repTimer, SIGNAL(timeout()), this, SLOT(checkRepStall()) );
 }
 
 LPWatcher::~LPWatcher(){
@@ -61,7 +76,6 @@ LPWatcher::~LPWatcher(){
   delete watcher;
   delete timer;
   delete logfile;
-  delete LFSTREAM;
 }
 
 // -----------------------------------
@@ -71,7 +85,7 @@ void LPWatcher::start(){
   INIT=true;
   setupLogFile();
   //Now check for any current errors in the LPbackend
-  checkPoolStatus();
+  requestPoolStatus();
   //And start up the error file watcher
   if(!timer->isActive()){ timer->start(sysCheckTime); }
   iniTimer->start(startupTime);
@@ -80,11 +94,13 @@ void LPWatcher::start(){
 void LPWatcher::stop(){
   watcher->removePaths(watcher->files());
   logfile->close();
+  logOffset = 0;
   timer->stop();
+  poolTimer->stop();
 }
 
 void LPWatcher::refresh(){
-  QTimer::singleShot(1, this, SLOT(checkPoolStatus()) );
+  requestPoolStatus(true); //asked for by the user - don't wait for the rate limit
 }
 
 QStringList LPWatcher::getMessages(QString type, QStringList msgList){
@@ -168,18 +184,31 @@ void LPWatcher::setupLogFile(){
 	
   //Read the current state of the log file
   if(logfile->exists()){
-    logfile->open(QIODevice::ReadOnly | QIODevice::Text);
+    if(!logfile->isOpen()){ logfile->open(QIODevice::ReadOnly | QIODevice::Text); logOffset = 0; }
     readLogFile(true); //do this quietly the first time through
     //Now start up the log file watcher
     watcher->addPath(FILE_LOG);	
   }
 }
 
+void LPWatcher::reopenLogFile(){
+  //The log was rotated or truncated - start over at the beginning of the new file
+  logfile->close();
+  logOffset = 0;
+  if(logfile->exists()){ logfile->open(QIODevice::ReadOnly | QIODevice::Text); }
+}
+
 void LPWatcher::readLogFile(bool quiet){
-  QStringList reppools = listReplicatedPools();
-  QTextStream in(logfile);
-  while(!LFSTREAM->atEnd()){
-    QString log = LFSTREAM->readLine();
+  if(!logfile->isOpen()){ return; }
+  //Only new lines are read: continue from the end of the last complete line
+  if(QFileInfo(FILE_LOG).size() < logOffset){ reopenLogFile(); }
+  if(!logfile->isOpen() || !logfile->seek(logOffset)){ return; }
+  QStringList reppools = replicatedPools();
+  while(!logfile->atEnd()){
+    QByteArray raw = logfile->readLine();
+    if(!raw.endsWith('\n')){ break; } //partial line still being written - get it next time
+    logOffset = logfile->pos();
+    QString log = QString::fromUtf8(raw).trimmed();
 
     //Divide up the log into it's sections
     QString timestamp = log.section(":",0,2).simplified();
@@ -277,7 +306,20 @@ void LPWatcher::readLogFile(bool quiet){
   }
 }
 
+LPRepProgress LPWatcher::replicationProgress(){
+  return repProgress;
+}
+
 void LPWatcher::readReplicationFile(){
+  if(repStructured){
+    bool changed = false;
+    while( !RFSTREAM->atEnd() ){
+      if( repProgress.parseLine(RFSTREAM->readLine()) ){ changed = true; }
+    }
+    if(changed){ updateRepStatus(); }
+    return;
+  }
+  //Older lpreserver: parse the human-readable send log
   QString stat;
   while( !RFSTREAM->atEnd() ){ 
     QString line = RFSTREAM->readLine(); 
@@ -322,10 +364,28 @@ void LPWatcher::readReplicationFile(){
   }
 }
 
+void LPWatcher::updateRepStatus(){
+  if(repProgress.snapshot.isEmpty()){ return; }
+  QString dataset = repProgress.snapshot.section("@",0,0).section("/",0,0).simplified();
+  QString txt;
+  if(repProgress.isStalled(QDateTime::currentDateTime().toTime_t())){
+    txt = QString(tr("Replication of %1 stalled: %2")).arg(dataset, repProgress.summary());
+  }else{
+    txt = QString(tr("Replicating %1: %2")).arg(dataset, repProgress.summary());
+  }
+  if(LOGS.value(20)=="RUNNING" && LOGS.value(22)==txt){ return; } //no change
+  //Now set the current process status
+  LOGS.insert(20,"RUNNING");
+  LOGS.insert(21,dataset);
+  LOGS.insert(22,txt);
+  LOGS.insert(23,txt);
+  emit MessageAvailable("");
+}
+
 bool LPWatcher::startRepFileWatcher(){
   //qDebug() << "Start Rep File Watcher:" << FILE_REPLICATION;
   if(FILE_REPLICATION.isEmpty()){ return false; }
-  if(watcher->files().contains(FILE_REPLICATION)){ return true; } //duplicate - file already opened
+  if(!FILE_REPWATCH.isEmpty() && watcher->files().contains(FILE_REPWATCH)){ return true; } //duplicate - file already opened
   /*else if(!watcher->files().isEmpty()){ 
     //Check that the file watcher is not already operating on a file
     // only one can be running at a time, so always cancel the previous instance (it is stale)
@@ -336,13 +396,19 @@ bool LPWatcher::startRepFileWatcher(){
   }*/
   //Check to make sure that lpreserver actually has a process running before starting this
   if( !isReplicationRunning() ){ FILE_REPLICATION.clear(); return false; }
+  //Newer lpreserver versions write progress records next to the send log
+  QString progfile = FILE_REPLICATION.section("/",0,-2)+"/lastrep-progress";
+  repStructured = QFile::exists(progfile);
+  FILE_REPWATCH = repStructured ? progfile : FILE_REPLICATION;
+  repProgress.clear();
   //Check for the existance of the file to watch and create it as necessary  
-  if(!QFile::exists(FILE_REPLICATION)){ system( QString("touch "+FILE_REPLICATION).toUtf8() ); }
+  if(!QFile::exists(FILE_REPWATCH)){ system( QString("touch "+FILE_REPWATCH).toUtf8() ); }
   //Now open the file and start watching it for changes
-  repfile->setFileName(FILE_REPLICATION);
+  repfile->setFileName(FILE_REPWATCH);
   repfile->open(QIODevice::ReadOnly | QIODevice::Text);
   RFSTREAM = new QTextStream(repfile);
-  watcher->addPath(FILE_REPLICATION);
+  watcher->addPath(FILE_REPWATCH);
+  if(repStructured){ repTimer->start(); }
   //qDebug() << "Finished starting rep file watcher";
   return true;
 }
@@ -350,7 +416,8 @@ bool LPWatcher::startRepFileWatcher(){
 void LPWatcher::stopRepFileWatcher(){
   //qDebug() << "Stop Rep File Watcher:" << FILE_REPLICATION;
   if(FILE_REPLICATION.isEmpty()){ return; }
-  watcher->removePath(FILE_REPLICATION);
+  watcher->removePath(FILE_REPWATCH);
+  repTimer->stop();
   //Close down the stream
   RFSTREAM->setStatus(QTextStream::ReadPastEnd); //let any running process know to stop now
   delete RFSTREAM;  
@@ -358,8 +425,10 @@ void LPWatcher::stopRepFileWatcher(){
   repfile->close();
   //clear internal variables
   FILE_REPLICATION.clear();
+  FILE_REPWATCH.clear();
   repTotK.clear();
   lastSize.clear();
+  repProgress.clear();
   //qDebug() << "Finished stopping rep file watcher";
 }
 
@@ -399,6 +468,20 @@ QStringList LPWatcher::listReplicatedPools(){
   return out;
 }
 
+QStringList LPWatcher::replicatedPools(){
+  //Only ask lpreserver again when the replication config was changed
+  QFileInfo info(FILE_REPCONF);
+  QDateTime mod = info.exists() ? info.lastModified() : QDateTime();
+  qint64 size = info.exists() ? info.size() : -1;
+  if(!repPoolsValid || mod != repConfTime || size != repConfSize){
+    repPools = listReplicatedPools();
+    repConfTime = mod;
+    repConfSize = size;
+    repPoolsValid = true;
+  }
+  return repPools;
+}
+
 QStringList LPWatcher::getCmdOutput(QString  cmd){
   QProcess *proc = new QProcess;
   proc->setProcessChannelMode(QProcess::MergedChannels);
@@ -415,14 +498,38 @@ QStringList LPWatcher::getCmdOutput(QString  cmd){
 //    PRIVATE SLOTS
 // ------------------------------
 void LPWatcher::fileChanged(QString file){
-  if(file == FILE_LOG){ readLogFile(); }
-  else  if(file == FILE_REPLICATION){ readReplicationFile(); }
   //Make sure the watched files were not removed for some reason
   QStringList wfiles = watcher->files();
-  if( !wfiles.contains(file) ){ watcher->addPath(file); } //There will always be one signal like this when it is removed
+  if( !wfiles.contains(file) ){
+    if(file == FILE_LOG){ reopenLogFile(); } //log was rotated - the open file is the old one
+    watcher->addPath(file); //There will always be one signal like this when it is removed
+  }
+  if(file == FILE_LOG){ readLogFile(); }
+  else  if(file == FILE_REPWATCH){ readReplicationFile(); }
+}
+
+void LPWatcher::checkRepStall(){
+  //The progress records stop (or the byte count stops changing) when the transfer hangs
+  if(repStructured){ updateRepStatus(); }
+}
+
+void LPWatcher::requestPoolStatus(bool now){
+  //Merge all the requests which come in while a probe is running or already scheduled
+  if(poolCheckRunning){ poolCheckPending = true; poolCheckNow = poolCheckNow || now; return; }
+  if(now){ poolTimer->start(0); return; }
+  if(poolTimer->isActive()){ return; }
+  int wait = 0;
+  if(lastPoolCheck.isValid() && lastPoolCheck.elapsed() < minPoolCheckTime){
+    wait = minPoolCheckTime - lastPoolCheck.elapsed();
+  }
+  poolTimer->start(wait);
 }
 
 void LPWatcher::checkPoolStatus(){
+  //getCmdOutput() processes events while waiting, so never run two probes at once
+  if(poolCheckRunning){ poolCheckPending = true; return; }
+  poolCheckRunning = true;
+  lastPoolCheck.start();
   if(watcher->files().isEmpty()){
     setupLogFile(); //try it now - might have been created in the meantime
   }
@@ -624,6 +731,12 @@ void LPWatcher::checkPoolStatus(){
   else if(newresilver){ emit MessageAvailable("resilver"); }
   else if(newscrub){ emit MessageAvailable("scrub"); }
   else{ emit StatusUpdated(); }
+  poolCheckRunning = false;
+  if(poolCheckPending){
+    bool now = poolCheckNow;
+    poolCheckPending = poolCheckNow = false;
+    requestPoolStatus(now);
+  }
 }
 
 void LPWatcher::endInitPhase(){
@@ -10,10 +10,15 @@
 #include <QHash>
 #include <QTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QDebug>
 #include <QProcess>
 
+#include "LPRepProgress.h"
+
 class LPWatcher : public QObject{
 	Q_OBJECT
 public:
@@ -26,6 +31,7 @@ public:
 	bool hasError();
 	bool initPhase();
 	bool hasSuccessfulReplication();
+	LPRepProgress replicationProgress(); //progress of the running replication
 
 public slots:
 	void start();
@@ -34,22 +40,37 @@ public slots:
 
 private:
 	//Internal paths for the lpreserver output files
-	QString FILE_LOG, FILE_ERROR, FILE_REPLICATION;
+	QString FILE_LOG, FILE_ERROR, FILE_REPLICATION, FILE_REPCONF;
+	QString FILE_REPWATCH; //file watched for replication progress (progress records or the send log)
 	//Internal message Logs
 	QHash<unsigned int,QString> LOGS;
 	//File system watcher
 	QFileSystemWatcher *watcher;
-	QTimer *timer, *iniTimer;
+	QTimer *timer, *iniTimer, *poolTimer;
 	int sysCheckTime;
 	QFile *logfile, *repfile;
-	QTextStream *LFSTREAM, *RFSTREAM;
+	QTextStream *RFSTREAM;
+	qint64 logOffset; //position in the log file which has already been read
+	//Cached list of replicated pools (re-read only when the lpreserver config changes)
+	QStringList repPools;
+	QDateTime repConfTime;
+	qint64 repConfSize;
+	bool repPoolsValid;
+	//Pool status probe state
+	QElapsedTimer lastPoolCheck;
+	bool poolCheckRunning, poolCheckPending, poolCheckNow; //poolCheckNow: the pending request skips the rate limit
 	//Replication size variables
 	QString repTotK, lastSize;
+	bool repStructured; //progress records available (older lpreserver: only the send log)
+	LPRepProgress repProgress;
+	QTimer *repTimer; //stall check while a replication is running
 	bool INIT;
 
 	void setupLogFile();
+	void reopenLogFile();
 	void readLogFile(bool quiet = false);
 	void readReplicationFile(); //always sends quiet signals
+	void updateRepStatus(); //replication status messages from the progress records
 
 	bool startRepFileWatcher();
 	void stopRepFileWatcher();
@@ -58,12 +79,15 @@ private:
 	bool isReplicationRunning(); //check for replication PID file
 	
 	QStringList listReplicatedPools();
+	QStringList replicatedPools(); //cached version of listReplicatedPools()
 	QStringList getCmdOutput(QString cmd);
 	
 private slots:
 	void fileChanged(QString); //file system watcher saw a change
+	void requestPoolStatus(bool now = false); //schedule a checkPoolStatus() (rate-limited unless "now")
 	void checkPoolStatus(); //check for serious system errors
 	void endInitPhase();
+	void checkRepStall();
 
 signals:
 	void MessageAvailable(QString type);
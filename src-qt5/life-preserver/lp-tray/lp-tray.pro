@@ -9,11 +9,13 @@ CONFIG	+= qt warn_on release
 
 HEADERS	+= LPTray.h \
 		LPWatcher.h \
+		LPRepProgress.h \
 		LPMessages.h
 		
 SOURCES	+= main.cpp \
 		LPTray.cpp \
 		LPWatcher.cpp \
+		LPRepProgress.cpp \
 		LPMessages.cpp
 
 RESOURCES += lPreserve.qrc
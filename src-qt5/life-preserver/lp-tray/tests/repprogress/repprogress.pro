@@ -0,0 +1,14 @@
+QT       += core testlib
+QT       -= gui
+CONFIG   += testcase console
+
+TARGET = tst_repprogress
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+HEADERS += ../../LPRepProgress.h
+SOURCES += tst_repprogress.cpp \
+	../../LPRepProgress.cpp
+
+OTHER_FILES += lastrep-progress.txt
@@ -0,0 +1,130 @@
+#include <QtTest>
+#include <QFile>
+
+#include "LPRepProgress.h"
+
+//Replays a saved lastrep-progress file (as written by rep_progress_filter) through LPRepProgress
+class tst_RepProgress : public QObject{
+	Q_OBJECT
+private:
+	QStringList records;
+	LPRepProgress replay(int count); //progress after the first "count" records
+
+private slots:
+	void initTestCase();
+	void running();
+	void stalled();
+	void finished();
+	void nextStream();
+	void ignoresOtherLines();
+	void summary();
+	void display();
+};
+
+LPRepProgress tst_RepProgress::replay(int count){
+  LPRepProgress prog;
+  for(int i=0; i<count; i++){ prog.parseLine(records[i]); }
+  return prog;
+}
+
+void tst_RepProgress::initTestCase(){
+  QFile file(QFINDTESTDATA("lastrep-progress.txt"));
+  QVERIFY( file.open(QIODevice::ReadOnly | QIODevice::Text) );
+  records = QString(file.readAll()).split("\n", QString::SkipEmptyParts);
+  QCOMPARE( records.length(), 6 );
+}
+
+void tst_RepProgress::running(){
+  LPRepProgress prog = replay(3);
+  QCOMPARE( prog.snapshot, QString("tank/home@auto-2015-03-03-00-00-00") );
+  QCOMPARE( prog.sent, qint64(1310720) );
+  QCOMPARE( prog.total, qint64(3145728) );
+  QVERIFY( !prog.done );
+  //Smoothed rate: the slower last second only moves it part of the way
+  QVERIFY( qFuzzyCompare(prog.rate, 0.2*262144 + 0.8*524288) );
+  QCOMPARE( prog.avgRate, 436906.0 );
+  QCOMPARE( prog.percent(), 41.6 );
+  QCOMPARE( prog.secsLeft(), 3 );
+  QCOMPARE( prog.lastRecord, qint64(1425204003) );
+  QCOMPARE( prog.lastProgress, qint64(1425204003) );
+  QVERIFY( !prog.isStalled(1425204003 + 60) );
+}
+
+void tst_RepProgress::stalled(){
+  //A record without new data keeps the time of the last progress
+  LPRepProgress prog = replay(4);
+  QCOMPARE( prog.sent, qint64(1310720) );
+  QCOMPARE( prog.lastRecord, qint64(1425204100) );
+  QCOMPARE( prog.lastProgress, qint64(1425204003) );
+  QVERIFY( !prog.isStalled(1425204003 + 120) );
+  QVERIFY( prog.isStalled(1425204003 + 121) );
+}
+
+void tst_RepProgress::finished(){
+  LPRepProgress prog = replay(5);
+  QVERIFY( prog.done );
+  QCOMPARE( prog.sent, qint64(3145728) );
+  QCOMPARE( prog.percent(), 100.0 );
+  QCOMPARE( prog.secsLeft(), 0 );
+  QVERIFY( !prog.isStalled(1425204200 + 1000) );
+  QCOMPARE( prog.summary(), QString("3M/3M (100%)") );
+}
+
+void tst_RepProgress::nextStream(){
+  //Another dataset starts from zero: nothing carries over from the last one
+  LPRepProgress prog = replay(6);
+  QCOMPARE( prog.snapshot, QString("tank/usr@auto-2015-03-03-00-00-00") );
+  QVERIFY( !prog.done );
+  QCOMPARE( prog.sent, qint64(1024) );
+  QCOMPARE( prog.total, qint64(2048) );
+  QCOMPARE( prog.rate, 1024.0 );
+  QCOMPARE( prog.lastProgress, qint64(1425204300) );
+  QCOMPARE( prog.percent(), 50.0 );
+  QCOMPARE( prog.secsLeft(), 1 );
+}
+
+void tst_RepProgress::ignoresOtherLines(){
+  LPRepProgress prog = replay(2);
+  QVERIFY( !prog.parseLine("") );
+  QVERIFY( !prog.parseLine("size\t3145728") );
+  QVERIFY( !prog.parseLine("10:00:01\t524288\ttank/home@auto-2015-03-02-00-00-00") );
+  QVERIFY( !prog.parseLine("PROGRESS 1425204003 tank/home@auto") ); //cut off
+  QVERIFY( !prog.parseLine("PROGRESS later tank/home@auto 1 2 3 4") );
+  QCOMPARE( prog.sent, qint64(1048576) );
+  QCOMPARE( prog.lastRecord, qint64(1425204002) );
+}
+
+void tst_RepProgress::summary(){
+  LPRepProgress prog;
+  prog.sent = 1536;
+  prog.rate = 512;
+  QCOMPARE( prog.percent(), -1.0 );
+  QCOMPARE( prog.secsLeft(), -1 );
+  QCOMPARE( prog.summary(), QString("1.5K/??, 512B/s") );
+  prog.total = 1024*1024;
+  QCOMPARE( prog.secsLeft(), 2045 );
+  QCOMPARE( prog.summary(), QString("1.5K/1M (0.1%), 512B/s, 0:34:05 left") );
+  //Without a current rate the average is used for the estimate
+  prog.rate = 0;
+  prog.avgRate = 1024;
+  QCOMPARE( prog.secsLeft(), 1022 );
+  QCOMPARE( prog.summary(), QString("1.5K/1M (0.1%), 0:17:02 left") );
+  //The total is only an estimate
+  prog.sent = 2*1024*1024;
+  QCOMPARE( prog.percent(), 100.0 );
+  QCOMPARE( prog.secsLeft(), 0 );
+}
+
+void tst_RepProgress::display(){
+  QCOMPARE( LPRepProgress::bytesToDisplay(0), QString("0B") );
+  QCOMPARE( LPRepProgress::bytesToDisplay(1023), QString("1023B") );
+  QCOMPARE( LPRepProgress::bytesToDisplay(1024), QString("1K") );
+  QCOMPARE( LPRepProgress::bytesToDisplay(1310720), QString("1.2M") );
+  QCOMPARE( LPRepProgress::bytesToDisplay(1073741824.0*5), QString("5G") );
+  QCOMPARE( LPRepProgress::timeToDisplay(0), QString("0:00:00") );
+  QCOMPARE( LPRepProgress::timeToDisplay(3725), QString("1:02:05") );
+  QCOMPARE( LPRepProgress::timeToDisplay(36000), QString("10:00:00") );
+}
+
+QTEST_MAIN(tst_RepProgress)
+#include "tst_repprogress.moc"
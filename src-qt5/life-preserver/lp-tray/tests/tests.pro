@@ -0,0 +1,4 @@
+# Unit tests for lp-tray (run with "qmake && make check")
+TEMPLATE = subdirs
+
+SUBDIRS += repprogress
@@ -0,0 +1,89 @@
+#include "cp-iconcache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QSaveFile>
+
+///////////////////////////////////////////////////////////////////////////////
+QString CIconCache::cacheDir()
+{
+    return QDir::homePath() + QString("/.cache/PC-BSD/ControlPanel/icons/");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+QImage CIconCache::thumbnail(QString iconFile, QString overlayFile)
+{
+    QFileInfo info(iconFile);
+    if (!info.exists())
+        return QImage();
+
+    QString key = info.absoluteFilePath() + "\n"
+                + QString::number(info.lastModified().toMSecsSinceEpoch()) + "\n"
+                + QString::number(info.size()) + "\n"
+                + overlayFile + "\n"
+                + QString::number(THUMBNAIL_SIZE);
+    QString cache_file = cacheDir()
+                       + QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex()
+                       + ".png";
+
+    QImage image;
+    if (image.load(cache_file))
+        return image;
+
+    //---------------- Not cached yet - scale original icon
+    if (!image.load(iconFile))
+        return QImage();
+    if ((image.width() > THUMBNAIL_SIZE) || (image.height() > THUMBNAIL_SIZE))
+    {
+        image = image.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    if (overlayFile.length())
+    {
+        image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        int orig_w = image.width();
+        int orig_h = image.height();
+        QPainter painter(&image);
+        QImage mark(overlayFile);
+        QRect draw_rect=QRect(orig_w - orig_w/2, 0, orig_w/2, orig_h/2);
+        painter.drawImage(draw_rect, mark);
+    }
+
+    //---------------- Remember the original, so prune() can tell when it is gone
+    image.setText("Source", info.absoluteFilePath());
+    image.setText("Modified", QString::number(info.lastModified().toMSecsSinceEpoch()));
+
+    //---------------- Store it (renamed into place, so readers never get half written file)
+    QDir().mkpath(cacheDir());
+    QSaveFile out(cache_file);
+    if (out.open(QIODevice::WriteOnly))
+    {
+        if (image.save(&out, "PNG"))
+            out.commit();
+        else
+            out.cancelWriting();
+    }
+
+    return image;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void CIconCache::prune()
+{
+    QDir dir(cacheDir());
+    QStringList files = dir.entryList(QStringList() << "*.png", QDir::Files);
+    for (int i=0; i<files.size(); i++)
+    {
+        // Only the PNG text chunks are read here, not the image itself
+        QImageReader reader(dir.absoluteFilePath(files[i]));
+        QFileInfo source(reader.text("Source"));
+        bool stale = reader.text("Source").isEmpty() || !source.exists()
+                   || reader.text("Modified") != QString::number(source.lastModified().toMSecsSinceEpoch());
+        if (stale)
+            dir.remove(files[i]);
+    }
+}
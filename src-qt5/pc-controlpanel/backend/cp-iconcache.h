@@ -0,0 +1,29 @@
+#ifndef CPICONCACHE_H
+#define CPICONCACHE_H
+
+#include <QString>
+#include <QImage>
+
+//! Persistent cache of the scaled item icons (~/.cache/PC-BSD/ControlPanel/icons)
+//! Thumbnails are keyed by icon path, modification time and size, so they are
+//! rebuilt automatically once the original icon changes. Safe to call from the
+//! item loader threads (only QImage is used).
+class CIconCache
+{
+public:
+    //! Largest icon size shown by the control panel
+    static const int THUMBNAIL_SIZE = 64;
+
+    //! Returns icon scaled down to THUMBNAIL_SIZE with overlayFile painted into the
+    //! top right quarter (if given). Returns null image if icon could not be loaded
+    static QImage thumbnail(QString iconFile, QString overlayFile = QString());
+
+    //! Removes the cached thumbnails whose original icon was removed or changed
+    //! (call before the item loader threads start)
+    static void prune();
+
+private:
+    static QString cacheDir();
+};
+
+#endif // CPICONCACHE_H
@@ -23,6 +23,7 @@
 ***************************************************************************/
 
 #include "cp-item.h"
+#include "cp-iconcache.h"
 #include "../config.h"
 #include "pcbsd-utils.h"
 #include "misc.h"
@@ -75,6 +76,29 @@ const int ICON_SEARCH_PASS_SIZE = sizeof(ICON_SEARCH_PATH) / sizeof(QString);
 
 __string_constant DEFAULT_ICON = "preferences-other.png";
 
+///////////////////////////////////////////////////////////////////////////////
+// Finds icon file on disk (absolute path, default location, or search paths).
+// Returns empty string if icon should be looked up in the icon theme instead
+static QString findIconFile(QString icon)
+{
+    if (!icon.length())
+        return QString();
+    if (QFile::exists(icon))
+        return icon;
+    if (QFile::exists(QString(DEFAULT_ICON_LOCATION) + icon))
+        return QString(DEFAULT_ICON_LOCATION) + icon;
+    if (icon.indexOf("/") == -1)
+    {
+        QString icon_name = (icon.indexOf(".")>0)?icon:icon + ".png";
+        for (int i=0; i<ICON_SEARCH_PASS_SIZE; i++)
+        {
+            if (QFile::exists(ICON_SEARCH_PATH[i] + icon_name))
+                return ICON_SEARCH_PATH[i] + icon_name;
+        }
+    }
+    return QString();
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 CControlPanelItem::CControlPanelItem()
@@ -199,12 +223,10 @@ bool CControlPanelItem::read(QString file, bool skipRootAccess)
     mExecPath= Reader.value("Path").toString();
 
     //---------------- Get icon
+    // read() runs in the item group thread, so find and scale the icon here
     mIconFile=  Reader.value("Icon").toString();
-    if (!mIconImage.load(mIconFile))
-    {
-        QString FileName = QString(DEFAULT_ICON_LOCATION) + mIconFile;
-        mIconImage.load(FileName);
-    }
+    mIconPath= findIconFile(mIconFile);
+    mDisplayImage= CIconCache::thumbnail(mIconPath, (misRootRequired)?QString(ROOT_PICTURE):QString());
 
     //----------------- Get TryMessage extended field
     mMsgBoxText = getLocalizedField(Reader, TRY_MESSAGE_FIELD);
@@ -223,6 +245,9 @@ bool CControlPanelItem::read(QString file, bool skipRootAccess)
     mComment= Reader.value("Comment").toString();
     mDisplayComment= getLocalizedField(Reader,"Comment");
 
+    //---------------- Build search key (fields are separated by new line, filter can not contain it)
+    mSearchKey= (QStringList()<<mDisplayName<<mName<<mKeywords).join("\n").toLower();
+
     mFile= file;
     misValid = true;
     return true;
@@ -238,9 +263,9 @@ QIcon CControlPanelItem::icon()
         return mIcon;
     }
 
-    if (!mIconImage.isNull())
+    if (mIconPath.length())
     {
-        mIcon = QIcon(QPixmap::fromImage(mIconImage));
+        mIcon = QIcon(mIconPath);
     }
 
     if (mIconFile.length())
@@ -290,6 +315,13 @@ QIcon CControlPanelItem::displayIcon()
         return mDisplayIcon;
     }
 
+    // Prepared by read() (from thumbnail cache)
+    if (!mDisplayImage.isNull())
+    {
+        mDisplayIcon= QIcon(QPixmap::fromImage(mDisplayImage));
+        return mDisplayIcon;
+    }
+
     QSize orig_size = icon().availableSizes()[0]; //It should be loaded in read() and should have one size;
     int orig_h = orig_size.height();
     int orig_w = orig_size.width();
@@ -315,19 +347,21 @@ QIcon CControlPanelItem::displayIcon()
 ///////////////////////////////////////////////////////////////////////////////
 bool CControlPanelItem::matchWithFilter(QString filter)
 {
-    filter= filter.toLower().trimmed();
+    return matchWithNormalizedFilter(normalizeFilter(filter));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+QString CControlPanelItem::normalizeFilter(QString filter)
+{
+    return filter.toLower().trimmed();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool CControlPanelItem::matchWithNormalizedFilter(const QString &filter)
+{
     if (!filter.length())
         return true;
-    if (mDisplayName.toLower().indexOf(filter)>=0)
-        return true;
-    if (mName.toLower().indexOf(filter)>=0)
-        return true;
-    for (int i=0; i<mKeywords.size(); i++)
-    {
-        if (mKeywords[i].toLower().indexOf(filter)>=0)
-            return true;
-    }
-    return false;
+    return mSearchKey.contains(filter);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
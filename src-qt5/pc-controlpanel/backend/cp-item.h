@@ -62,6 +62,10 @@ public:
 
     bool    matchWithFilter(QString filter);
 
+    //! Filter text as matchWithNormalizedFilter() expects it (compute once per filter change)
+    static QString normalizeFilter(QString filter);
+    bool    matchWithNormalizedFilter(const QString& filter);
+
 private:
     bool    misValid;
     QString mType;
@@ -75,13 +79,15 @@ private:
     bool    misRootRequired;
     bool    misSudo;
     QString mIconFile;
+    QString mIconPath;
     QString mMsgBoxText;
+    QString mSearchKey;
 
     QStringList mKeywords;
     QStringList mShowIn;
     QStringList mNotShowIn;
 
-    QImage mIconImage;
+    QImage mDisplayImage;
     QIcon  mIcon;
     QIcon  mDisplayIcon;
 
@@ -7,6 +7,7 @@
 
 #include <pcbsd-SingleApplication.h>
 #include "backend/cp-itemgroup.h"
+#include "backend/cp-iconcache.h"
 
 #ifndef PREFIX
 #define PREFIX QString("/usr/local")
@@ -25,6 +26,7 @@ int main(int argc, char *argv[])
     translator.load( QString("pc-controlpanel_") + langCode, PREFIX + "/share/pcbsd/i18n/" );
     a.installTranslator( &translator );
     QTextCodec::setCodecForLocale( QTextCodec::codecForName("UTF-8") ); //Force Utf-8 compliance
+    CIconCache::prune(); //drop thumbnails of removed/changed icons
     MainWindow w;       
 
     w.show();
@@ -32,6 +32,7 @@
 #include <sys/types.h>
 
 #include "pcbsd-utils.h"
+#include "pcbsd-deinfo.h"
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
@@ -409,8 +410,6 @@ void MainWindow::repaintGroupWidget(MainWindow::SUIItemsGroup *itemsGroup)
     itemsGroup->mListWidget->setVisible(itemsGroup->mGroupNameWidget->isChecked());
     itemsGroup->mGroupNameWidget->setVisible(true);
 
-    int disabled_count = 0;
-
     for (int i=0; i<itemsGroup->mItems.size(); i++)
     {
         QListWidgetItem* lw_item = new QListWidgetItem( itemsGroup->mItems[i].displayIcon(),
@@ -448,12 +447,6 @@ void MainWindow::repaintGroupWidget(MainWindow::SUIItemsGroup *itemsGroup)
         }
 
         lw_item->setText(item_text);
-        bool is_enabled = itemsGroup->mItems[i].matchWithFilter(ui->filterEdit->text());
-
-        lw_item->setFlags((is_enabled)?lw_item->flags() | Qt::ItemIsEnabled
-                                     :lw_item->flags() & (~Qt::ItemIsEnabled));
-        if (!is_enabled)
-            disabled_count++;
 
         QVariant v;
         v.setValue(&itemsGroup->mItems[i]);
@@ -462,6 +455,35 @@ void MainWindow::repaintGroupWidget(MainWindow::SUIItemsGroup *itemsGroup)
         widget->addItem(lw_item);
     }
 
+    applyFilter(itemsGroup);
+
+    QApplication::processEvents();
+    widget->fitSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MainWindow::applyFilter(MainWindow::SUIItemsGroup *itemsGroup)
+{
+    QAutoExpandList* widget= itemsGroup->mListWidget;
+    if ((!widget) || (!itemsGroup->mItems.size()))
+        return;
+
+    // Only item flags are updated here, list items are not recreated on each keystroke
+    QString filter = CControlPanelItem::normalizeFilter(ui->filterEdit->text());
+    int disabled_count = 0;
+
+    for (int i=0; i<widget->count(); i++)
+    {
+        QListWidgetItem* lw_item = widget->item(i);
+        CControlPanelItem* backend_item = lw_item->data(Qt::UserRole).value<CControlPanelItem*>();
+        bool is_enabled = (!backend_item) || backend_item->matchWithNormalizedFilter(filter);
+
+        lw_item->setFlags((is_enabled)?lw_item->flags() | Qt::ItemIsEnabled
+                                     :lw_item->flags() & (~Qt::ItemIsEnabled));
+        if (!is_enabled)
+            disabled_count++;
+    }
+
     if (ui->filterEdit->text().length())
     {
         if (disabled_count>=itemsGroup->mItems.size())
@@ -473,9 +495,6 @@ void MainWindow::repaintGroupWidget(MainWindow::SUIItemsGroup *itemsGroup)
             itemsGroup->mGroupNameWidget->setChecked(true);
         }
     }
-
-    QApplication::processEvents();
-    widget->fitSize();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -702,6 +721,8 @@ void MainWindow::slotViewModeActionTriggered()
 ///////////////////////////////////////////////////////////////////////////////
 void MainWindow::on_refreshButton_clicked()
 {
+    // Desktops may have been installed/removed since the last read
+    pcbsd::DEInfoCache::invalidate();
     for (int i=0; i<6; i++)
     {
         if (mItemGropus[i].mItemGroup)
@@ -725,7 +746,7 @@ void MainWindow::on_filterEdit_textChanged(const QString &arg1)
         {
             mItemGropus[i].mGroupNameWidget->setChecked(mItemGropus[i].mStoredNameState);
         }
-        repaintGroupWidget(&mItemGropus[i]);
+        applyFilter(&mItemGropus[i]);
     }
 
     mLastFilterLength = ui->filterEdit->text().length();
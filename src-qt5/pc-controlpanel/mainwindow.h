@@ -87,6 +87,7 @@ private:
 
     void fillGroupWidget(SUIItemsGroup* itemsGroup);
     void repaintGroupWidget(SUIItemsGroup* itemsGroup);
+    void applyFilter(SUIItemsGroup* itemsGroup);
     void setBigIcons(bool isBig);
     void setListMode(bool isListMode);
     void setFixedItemsLayout(bool isFixedLayout);
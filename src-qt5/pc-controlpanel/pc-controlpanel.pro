@@ -20,11 +20,13 @@ SOURCES += main.cpp\
         mainwindow.cpp \
     backend/cp-item.cpp \
     backend/cp-itemgroup.cpp \
+    backend/cp-iconcache.cpp \
     controls/qautoexpandlist.cpp
 
 HEADERS  += mainwindow.h \
     backend/cp-item.h \
     backend/cp-itemgroup.h \
+    backend/cp-iconcache.h \
     backend/misc.h \
     controls/qautoexpandlist.h
 
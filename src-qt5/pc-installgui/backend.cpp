@@ -1,10 +1,40 @@
 #include <QApplication>
 #include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
 
 #include "backend.h"
 
 using namespace Scripts;
 
+// Most disks to probe at once
+#define MAXDISKPROBES 8
+
+namespace {
+
+struct DiskCacheEntry {
+  QString devinfo;
+  QList<QStringList> info;
+};
+
+QHash<QString, DiskCacheEntry> DISKCACHE;
+QHash<QString, int> DISKGENERATION; //bumped whenever a disk is invalidated
+QMutex DISKCACHELOCK;
+bool DISKWATCHED = false; //the cache is only used while devd tells us about disk changes
+
+// Whether the device is the disk itself or one of its slices/partitions (ada1p2, ada1s1a - not ada10)
+bool isDiskDevice(const QString &dev, const QString &disk)
+{
+  if ( dev == disk )
+    return true;
+  if ( dev.length() < disk.length() + 2 || ! dev.startsWith(disk) )
+    return false;
+  QChar type = dev.at(disk.length());
+  return (type == 'p' || type == 's') && dev.at(disk.length() + 1).isDigit();
+}
+
+} //end of anonymous namespace
+
 void Backend::createErrorReport()
 {
   QString line;
@@ -282,135 +312,340 @@ QList<QStringList> Backend::availComponents()
 }
 
 QList<QStringList> Backend::hardDrives()
+{
+    // Probe all the disks at once (cached disks are not probed again)
+    DiskProbe probe;
+    probe.start();
+    probe.waitForDone();
+    return probe.results();
+}
+
+QList<QStringList> Backend::probeDisk(QString dev, QString devinfo)
 {
     QList<QStringList> drives;
     QStringList drive; //its a "list" so as to also append drive information
     QStringList partition; //its a "list" so as to also append drive information
 
-    QString size, devinfo, type;
-    QString line, info, format;
-    QString tmp, dev, lastslice, slice, slabel, ssize;
+    QString size, type;
+    QString info, format;
+    QString tmp, lastslice, slice, slabel, ssize;
     bool ok;
 
-    Process p(QStringList() << "disk-list");
+    // Get the disk information for this dev
+    Process pp(QStringList() << "disk-info" << dev);
+    if (pp.waitForFinished()) {
+        while (pp.canReadLine()) {
+            info = pp.readLine().simplified();
+            if (info.indexOf("size=") == 0) size = info.replace("size=", "");
+            if (info.indexOf("type=") == 0) type = info.replace("type=", "");
+        }
+    }
 
-    if (p.waitForFinished(90000)) {
-        while (p.canReadLine()) {
-            line = p.readLine();
-	    if ( line.isEmpty() ) 
-               continue;
-            dev = line.simplified();
-            dev.truncate(line.indexOf(":"));
-
-            tmp = line.simplified().remove(0, line.indexOf(":") + 1);
-            devinfo = tmp;
-
-            // Get the disk information for this dev
-            Process pp(QStringList() << "disk-info" << dev);
-            if (pp.waitForFinished()) {
-                while (pp.canReadLine()) {
-                    info = pp.readLine().simplified();
-                    if (info.indexOf("size=") == 0) size = info.replace("size=", "");
-                    if (info.indexOf("type=") == 0) type = info.replace("type=", "");
-                }
+    // Pad the disk size a bit
+    size.toInt(&ok);
+    if ( !ok)
+	return drives;
+    //size.setNum(size.toInt(&ok) - 100);
+
+    // Add this info to our list
+    qDebug() << "Found Drive:" << dev << size << devinfo << type;
+    drive.clear();
+    drive << "DRIVE" << dev << size << devinfo << type;
+    drives.append(drive);
+
+    // Init lastslize in case this disk is completely empty
+    lastslice = "s0";
+
+    // Get the slice information for this disk
+    Process ppp(QStringList() << "disk-part" << dev);
+    if (ppp.waitForFinished()) {
+        while (ppp.canReadLine()) {
+            info = ppp.readLine().simplified();
+            // Get the slice we are working on
+            if ( info.indexOf(dev + "s") == 0 || info.indexOf(dev + "p") == 0 ) {
+              slice = info;
+              slice.truncate(slice.indexOf("-"));
+            } else {
+              slice = "";
+            }
+             
+            if (info.indexOf(slice + "-label: ") == 0) slabel = info.replace(slice + "-label: ", "");
+
+            // Check if we've found the format flag
+            if (info.indexOf(dev + "-format: ") == 0) {
+              format = info.replace(dev + "-format: ", "");
+              qDebug() << "Found Disk Format: " <<  dev << " - " << format;
+              partition.clear();
+              partition << "FORMAT" << dev << format;
+              drives.append(partition);
             }
 
-	    // Pad the disk size a bit
-	    size.toInt(&ok);
-	    if ( !ok)
+            // Check if we've found the new slice
+            if (info.indexOf(slice + "-sizemb: ") == 0) {
+              ssize = info.replace(slice + "-sizemb: ", "");
+	      // Make sure we have a number
+	      ssize.toInt(&ok);
+	      if (!ok)
 		continue;
-	    //size.setNum(size.toInt(&ok) - 100);
-
-            // Add this info to our list
-            qDebug() << "Found Drive:" << dev << size << devinfo << type;
-            drive.clear();
-            drive << "DRIVE" << dev << size << devinfo << type;
-            drives.append(drive);
-
-            // Init lastslize in case this disk is completely empty
-            lastslice = "s0";
-
-            // Get the slice information for this disk
-            Process ppp(QStringList() << "disk-part" << dev);
-            if (ppp.waitForFinished()) {
-                while (ppp.canReadLine()) {
-                    info = ppp.readLine().simplified();
-                    // Get the slice we are working on
-                    if ( info.indexOf(dev + "s") == 0 || info.indexOf(dev + "p") == 0 ) {
-                      slice = info;
-                      slice.truncate(slice.indexOf("-"));
-                    } else {
-                      slice = "";
-                    }
-                     
-                    if (info.indexOf(slice + "-label: ") == 0) slabel = info.replace(slice + "-label: ", "");
-
-                    // Check if we've found the format flag
-                    if (info.indexOf(dev + "-format: ") == 0) {
-                      format = info.replace(dev + "-format: ", "");
-                      qDebug() << "Found Disk Format: " <<  dev << " - " << format;
-                      partition.clear();
-                      partition << "FORMAT" << dev << format;
-                      drives.append(partition);
-                    }
-
-                    // Check if we've found the new slice
-                    if (info.indexOf(slice + "-sizemb: ") == 0) {
-                      ssize = info.replace(slice + "-sizemb: ", "");
-		      // Make sure we have a number
-		      ssize.toInt(&ok);
-		      if (!ok)
-			continue;
-
-		      // Pad the slice by 5MB
-		      //ssize.setNum(ssize.toInt(&ok) - 5);
-			
-                      qDebug() << "Found Slice:" << dev << slice << slabel << ssize;
-                      partition.clear();
-                      partition << "SLICE" << dev << slice << ssize << slabel;   
-                      drives.append(partition);
-                      lastslice = slice;
-                    }
-
-                    // Check if we've found some free disk space
-                    if (info.indexOf(dev + "-freemb: ") == 0) {
-                      bool ok;
-		      int checkSize;
-                      ssize = info.replace(dev + "-freemb: ", "");
-                      checkSize = ssize.toInt(&ok); 
-                      if ( ok && checkSize > 100 )
-                      {
-                        // Figure out the next slice number, if its less than 4
-                        QString freeslice;
-                        tmp = lastslice;
-                        tmp = tmp.remove(0, tmp.size() - 1);
-                        int nextslicenum = tmp.toInt(&ok);
-                        if ( ok ) {
-                          if ( format == "MBR" || format == "mbr" ) {
-                            nextslicenum++;
-                            slice = dev + "s" + tmp.setNum(nextslicenum);
-                            slabel = "Unused Space";
-                            qDebug() << "Found Slice:" << dev << slice << slabel << ssize;
-                            partition.clear();
-                            partition << "SLICE" << dev << slice << ssize << slabel;
-                            drives.append(partition);
-                          } else if ( format == "GPT" || format == "gpt" ) {
-                            nextslicenum++;
-                            slice = dev + "p" + tmp.setNum(nextslicenum);
-                            slabel = "Unused Space";
-                            qDebug() << "Found Slice:" << dev << slice << slabel << ssize;
-                            partition.clear();
-                            partition << "SLICE" << dev << slice << ssize << slabel;
-                            drives.append(partition);
- 			  }
-			}
-		      }
-                    } // End of Free Space Check
-                }
+
+	      // Pad the slice by 5MB
+	      //ssize.setNum(ssize.toInt(&ok) - 5);
+		
+              qDebug() << "Found Slice:" << dev << slice << slabel << ssize;
+              partition.clear();
+              partition << "SLICE" << dev << slice << ssize << slabel;   
+              drives.append(partition);
+              lastslice = slice;
             }
 
+            // Check if we've found some free disk space
+            if (info.indexOf(dev + "-freemb: ") == 0) {
+              bool ok;
+	      int checkSize;
+              ssize = info.replace(dev + "-freemb: ", "");
+              checkSize = ssize.toInt(&ok); 
+              if ( ok && checkSize > 100 )
+              {
+                // Figure out the next slice number, if its less than 4
+                QString freeslice;
+                tmp = lastslice;
+                tmp = tmp.remove(0, tmp.size() - 1);
+                int nextslicenum = tmp.toInt(&ok);
+                if ( ok ) {
+                  if ( format == "MBR" || format == "mbr" ) {
+                    nextslicenum++;
+                    slice = dev + "s" + tmp.setNum(nextslicenum);
+                    slabel = "Unused Space";
+                    qDebug() << "Found Slice:" << dev << slice << slabel << ssize;
+                    partition.clear();
+                    partition << "SLICE" << dev << slice << ssize << slabel;
+                    drives.append(partition);
+                  } else if ( format == "GPT" || format == "gpt" ) {
+                    nextslicenum++;
+                    slice = dev + "p" + tmp.setNum(nextslicenum);
+                    slabel = "Unused Space";
+                    qDebug() << "Found Slice:" << dev << slice << slabel << ssize;
+                    partition.clear();
+                    partition << "SLICE" << dev << slice << ssize << slabel;
+                    drives.append(partition);
+                  }
+                }
+              }
+            } // End of Free Space Check
         }
     }
     return drives;
 }
 
+namespace Scripts {
+
+// Runs "disk-list" (empty dev) or the probes of one disk within the DiskProbe pool
+class DiskProbeTask : public QRunnable {
+public:
+    DiskProbeTask(DiskProbe *probe, QString dev, QString devinfo) {
+      PROBE = probe; DEV = dev; DEVINFO = devinfo;
+    }
+    void run() {
+      if ( DEV.isEmpty() )
+        PROBE->listDisks();
+      else
+        PROBE->probe(DEV, DEVINFO);
+    }
+private:
+    DiskProbe *PROBE;
+    QString DEV, DEVINFO;
+};
+
+} //namespace Scripts
+
+DiskProbe::DiskProbe(QObject *parent) : QObject(parent)
+{
+  qRegisterMetaType< QList<QStringList> >("QList<QStringList>");
+  pool = new QThreadPool(this);
+  pool->setMaxThreadCount(MAXDISKPROBES);
+  reported = 0;
+  listed = false;
+  emittedDone = false;
+}
+
+DiskProbe::~DiskProbe()
+{
+  // The running tasks still use this object
+  pool->waitForDone();
+}
+
+void DiskProbe::start()
+{
+  pool->start(new DiskProbeTask(this, "", ""));
+}
+
+bool DiskProbe::isRunning()
+{
+  return !emittedDone;
+}
+
+void DiskProbe::waitForDone()
+{
+  pool->waitForDone();
+}
+
+QList<QStringList> DiskProbe::results()
+{
+  QMutexLocker locker(&lock);
+  QList<QStringList> drives;
+  for (int i=0; i < devs.count(); ++i)
+    drives << found.value(devs.at(i));
+  return drives;
+}
+
+void DiskProbe::invalidate(QString dev)
+{
+  QMutexLocker locker(&DISKCACHELOCK);
+  // Also drop the disk which a slice/partition belongs to (ada0p2 -> ada0)
+  // A new generation keeps the probes already running from caching their old results
+  QStringList disks = DISKGENERATION.keys();
+  for (int i=0; i < disks.count(); ++i) {
+    if ( dev.isEmpty() || isDiskDevice(dev, disks.at(i)) ) {
+      DISKGENERATION[disks.at(i)]++;
+      DISKCACHE.remove(disks.at(i));
+    }
+  }
+}
+
+// Runs in the thread pool
+void DiskProbe::listDisks()
+{
+  QString line, dev, devinfo;
+
+  Process p(QStringList() << "disk-list");
+
+  if (p.waitForFinished(90000)) {
+    while (p.canReadLine()) {
+      line = p.readLine();
+      if ( line.isEmpty() )
+        continue;
+      dev = line.simplified();
+      dev.truncate(line.indexOf(":"));
+      devinfo = line.simplified().remove(0, line.indexOf(":") + 1);
+
+      lock.lock();
+      devs << dev;
+      lock.unlock();
+
+      // Use the cached results if the disk has not changed
+      bool cached = false;
+      DISKCACHELOCK.lock();
+      if ( DISKWATCHED && DISKCACHE.contains(dev) && DISKCACHE.value(dev).devinfo == devinfo ) {
+        cached = true;
+        lock.lock();
+        found.insert(dev, DISKCACHE.value(dev).info);
+        lock.unlock();
+      }
+      DISKCACHELOCK.unlock();
+
+      if ( ! cached )
+        pool->start(new DiskProbeTask(this, dev, devinfo));
+    }
+  }
+
+  lock.lock();
+  listed = true;
+  lock.unlock();
+  QMetaObject::invokeMethod(this, "slotProbed", Qt::QueuedConnection);
+}
+
+// Runs in the thread pool
+void DiskProbe::probe(QString dev, QString devinfo)
+{
+  DISKCACHELOCK.lock();
+  int generation = DISKGENERATION.value(dev);
+  DISKGENERATION.insert(dev, generation);
+  DISKCACHELOCK.unlock();
+
+  DiskCacheEntry entry;
+  entry.devinfo = devinfo;
+  entry.info = Backend::probeDisk(dev, devinfo);
+
+  // Don't cache the results if devd reported a change of the disk meanwhile
+  DISKCACHELOCK.lock();
+  if ( DISKGENERATION.value(dev) == generation )
+    DISKCACHE.insert(dev, entry);
+  DISKCACHELOCK.unlock();
+
+  lock.lock();
+  found.insert(dev, entry.info);
+  lock.unlock();
+  QMetaObject::invokeMethod(this, "slotProbed", Qt::QueuedConnection);
+}
+
+void DiskProbe::slotProbed()
+{
+  // Report the disks in disk-list order, as soon as all the disks before them are done
+  QStringList newdevs;
+  QList< QList<QStringList> > newinfo;
+  bool done;
+  lock.lock();
+  while ( reported < devs.count() && found.contains(devs.at(reported)) ) {
+    newdevs << devs.at(reported);
+    newinfo << found.value(devs.at(reported));
+    reported++;
+  }
+  done = listed && reported == devs.count();
+  lock.unlock();
+
+  for (int i=0; i < newdevs.count(); ++i)
+    if ( ! newinfo.at(i).isEmpty() )
+      emit diskProbed(newdevs.at(i), newinfo.at(i));
+
+  if ( done && ! emittedDone ) {
+    emittedDone = true;
+    emit finished();
+  }
+}
+
+DiskWatcher::DiskWatcher(QObject *parent) : QObject(parent)
+{
+  devdProc = new QLocalSocket(this);
+  devdProc->connectToServer("/var/run/devd.pipe", QIODevice::ReadOnly | QIODevice::Text);
+  if ( devdProc->waitForConnected(3000) ) { //Max wait of 3 sec
+    connect(devdProc, SIGNAL(readyRead()), this, SLOT(newDevdMessage()) );
+    QMutexLocker locker(&DISKCACHELOCK);
+    DISKWATCHED = true;
+  } else {
+    qDebug() << "Could not startup the devd watching process, disk probes will not be cached";
+    devdProc->deleteLater();
+    devdProc = 0;
+  }
+}
+
+DiskWatcher::~DiskWatcher()
+{
+  if ( devdProc == 0 )
+    return;
+  devdProc->disconnectFromServer();
+  DISKCACHELOCK.lock();
+  DISKWATCHED = false;
+  DISKCACHELOCK.unlock();
+  DiskProbe::invalidate();
+}
+
+void DiskWatcher::newDevdMessage()
+{
+  // Look for devices being attached/detached (!system=DEVFS subsystem=CDEV type=CREATE cdev=ada1)
+  QStringList info = QString(devdProc->readAll()).split("\n");
+  bool changed = false;
+  for (int i=0; i < info.count(); ++i) {
+    QString msg = info.at(i).simplified();
+    if ( msg.indexOf("type=CREATE") == -1 && msg.indexOf("type=DESTROY") == -1 )
+      continue;
+    int pos = msg.indexOf("cdev=");
+    if ( pos == -1 )
+      continue;
+    QString dev = msg.mid(pos + 5).section(" ", 0, 0);
+    qDebug() << "Device changed:" << dev;
+    DiskProbe::invalidate(dev);
+    changed = true;
+  }
+  if ( changed )
+    emit disksChanged();
+}
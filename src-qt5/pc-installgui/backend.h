@@ -10,6 +10,11 @@
 #include <QByteArray>
 #include <QFile>
 #include <QWidget>
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <QLocalSocket>
 
 #define PCSYSINSTALLCFG QString("/tmp/sys-install.cfg")
 #define TMPLANGFILE QString("/tmp/.SysInstallLang")
@@ -34,7 +39,10 @@ public:
         QString PCSYSINSTALL;
         setReadChannel(QProcess::StandardOutput);
         // If we are using a debug copy of pc-sysinstall, we can execute that instead of default
-        if ( QFile::exists("/root/pc-sysinstall/pc-sysinstall") )
+        // (a stub can also be given with PCSYSINSTALL in the environment, see tests/diskprobe)
+        if ( ! qgetenv("PCSYSINSTALL").isEmpty() )
+          PCSYSINSTALL = QString::fromLocal8Bit(qgetenv("PCSYSINSTALL"));
+        else if ( QFile::exists("/root/pc-sysinstall/pc-sysinstall") )
           PCSYSINSTALL = "/root/pc-sysinstall/pc-sysinstall";
         else
           PCSYSINSTALL = "/usr/local/sbin/pc-sysinstall";
@@ -57,6 +65,7 @@ public:
     static QString detectCountryCode();
     static void changeKbMap(QString model, QString layout, QString variant);
     static QList<QStringList> hardDrives();
+    static QList<QStringList> probeDisk(QString dev, QString devinfo);
     static QList<QStringList> availComponents();
     static int systemMemory();
     static QList<QStringList> getPackageData(bool &found, QString pkgset);
@@ -67,6 +76,59 @@ private:
   QString PCSYSINSTALLDIR;
 };
 
+// Runs the "disk-info"/"disk-part" probes of every disk from "disk-list" in parallel
+// The results of each disk are kept in a cache (see DiskWatcher) and reported in disk-list order
+class DiskProbe : public QObject {
+	Q_OBJECT
+public:
+    DiskProbe(QObject *parent = 0);
+    ~DiskProbe();
+
+    void start();
+    bool isRunning();
+    void waitForDone();
+    //DRIVE/FORMAT/SLICE entries of all the disks found (same format as Backend::hardDrives())
+    QList<QStringList> results();
+
+    //Drop the cached results for a device (all disks if empty)
+    static void invalidate(QString dev = "");
+
+private:
+    QThreadPool *pool;
+    QMutex lock;
+    QStringList devs; //disks in disk-list order
+    QHash<QString, QList<QStringList> > found;
+    int reported; //number of disks already emitted
+    bool listed, emittedDone;
+
+    void listDisks();
+    void probe(QString dev, QString devinfo);
+    friend class DiskProbeTask;
+
+private slots:
+    void slotProbed();
+
+signals:
+    void diskProbed(QString dev, QList<QStringList> info);
+    void finished();
+};
+
+// Watches devd for devices being attached/detached and invalidates the cached disk probes
+class DiskWatcher : public QObject {
+	Q_OBJECT
+public:
+    DiskWatcher(QObject *parent = 0);
+    ~DiskWatcher();
+
+private:
+    QLocalSocket *devdProc;
+
+private slots:
+    void newDevdMessage();
+
+signals:
+    void disksChanged();
+};
 
 } //namespace Scripts
 
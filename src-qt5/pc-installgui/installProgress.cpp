@@ -0,0 +1,135 @@
+#include <QObject>
+
+#include "installProgress.h"
+
+// Weight of the newest rate sample in the smoothed rate
+#define RATESMOOTHING 0.2
+
+InstallProgress::InstallProgress()
+{
+  clear();
+}
+
+void InstallProgress::clear()
+{
+  phase.clear();
+  unit.clear();
+  msg.clear();
+  done = total = 0;
+  rate = 0;
+  startTime = lastTime = 0;
+  rateDone = rateTime = 0;
+}
+
+bool InstallProgress::parseLine(QString line)
+{
+  line = line.trimmed();
+  if ( line.indexOf("PROGRESS: ") != 0 )
+    return false;
+
+  // msg= is always last and may contain spaces
+  QString nmsg;
+  int mpos = line.indexOf(" msg=");
+  if ( mpos != -1 ) {
+    nmsg = line.mid(mpos + 5);
+    line.truncate(mpos);
+  }
+
+  QString nphase, nunit;
+  qint64 ndone = -1, ntotal = 0, ntime = -1;
+  QStringList fields = line.section(" ", 1, -1).split(" ", QString::SkipEmptyParts);
+  for ( int i=0; i < fields.count(); ++i ) {
+    QString key = fields.at(i).section("=", 0, 0);
+    QString val = fields.at(i).section("=", 1, -1);
+    if ( key == "phase" ) nphase = val;
+    else if ( key == "unit" ) nunit = val;
+    else if ( key == "done" ) ndone = val.toLongLong();
+    else if ( key == "total" ) ntotal = val.toLongLong();
+    else if ( key == "time" ) ntime = val.toLongLong();
+  }
+  if ( nphase.isEmpty() || ndone < 0 || ntime < 0 )
+    return false;
+
+  // New phase (or a new archive/stream of the same phase): start over
+  if ( nphase != phase || ndone < done )
+    clear();
+
+  if ( startTime == 0 ) {
+    startTime = ntime;
+    rateTime = ntime;
+    rateDone = ndone;
+  } else if ( ntime > rateTime ) {
+    // Exponential smoothing of the rate (a single slow second should not change the ETA much)
+    double cur = double(ndone - rateDone) / (ntime - rateTime);
+    if ( rate <= 0 )
+      rate = cur;
+    else
+      rate = RATESMOOTHING * cur + (1 - RATESMOOTHING) * rate;
+    rateTime = ntime;
+    rateDone = ndone;
+  }
+
+  phase = nphase;
+  unit = nunit;
+  done = ndone;
+  total = ntotal;
+  lastTime = ntime;
+  if ( ! nmsg.isEmpty() )
+    msg = nmsg;
+  return true;
+}
+
+int InstallProgress::permille()
+{
+  if ( total <= 0 )
+    return -1;
+  if ( done >= total )
+    return 1000;
+  return int( (done * 1000) / total );
+}
+
+int InstallProgress::secsLeft()
+{
+  if ( total <= 0 || rate <= 0 )
+    return -1;
+  if ( done >= total )
+    return 0;
+  return int( (total - done) / rate );
+}
+
+QString InstallProgress::summary()
+{
+  QString txt = amountToDisplay(done);
+  if ( total > 0 )
+    txt += "/" + amountToDisplay(total);
+  if ( rate > 0 )
+    txt += ", " + amountToDisplay(rate) + "/s";
+  int secs = secsLeft();
+  if ( secs > 0 )
+    txt += ", " + QObject::tr("%1 left").arg(timeToDisplay(secs));
+  return txt;
+}
+
+QString InstallProgress::amountToDisplay(double amount)
+{
+  if ( unit == "bytes" )
+    return bytesToDisplay(amount);
+  return QString::number( int(amount * 10) / 10.0 );
+}
+
+QString InstallProgress::bytesToDisplay(double bytes)
+{
+  QStringList labels;
+  labels << "B" << "K" << "M" << "G" << "T" << "P" << "E";
+  int i=0;
+  while ( bytes >= 1024 && i < labels.count() - 1 ) {
+    bytes = bytes / 1024;
+    i++;
+  }
+  return QString::number( int(bytes * 10) / 10.0 ) + labels.at(i);
+}
+
+QString InstallProgress::timeToDisplay(int secs)
+{
+  return QString("%1:%2:%3").arg(secs / 3600).arg((secs % 3600) / 60, 2, 10, QChar('0')).arg(secs % 60, 2, 10, QChar('0'));
+}
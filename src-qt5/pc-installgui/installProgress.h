@@ -0,0 +1,36 @@
+#ifndef INSTALLPROGRESS_H
+#define INSTALLPROGRESS_H
+
+#include <QString>
+#include <QStringList>
+
+// Progress of the current pc-sysinstall phase, built from the records it writes on stdout:
+//   PROGRESS: phase=<name> done=<n> total=<n> unit=<bytes|items> time=<unix time> [msg=<text>]
+// (total is 0 if unknown, msg runs until the end of the line)
+class InstallProgress {
+public:
+    InstallProgress();
+
+    void clear();
+    bool parseLine(QString line); // returns false if the line is not a progress record
+
+    QString phase; // fetch, extract, restore, packages
+    QString unit; // bytes or items
+    QString msg; // current file/dataset/package
+    qint64 done, total;
+    double rate; // smoothed rate for this phase (units/sec)
+    qint64 startTime, lastTime; // unix time of the first/last record for this phase
+
+    int permille(); // -1 if unknown
+    int secsLeft(); // -1 if unknown
+    QString summary(); // "1.2G/10G, 50M/s, 0:03:00 left" or "1200/3400, 25/s, 0:01:28 left"
+
+    static QString bytesToDisplay(double bytes); // "1.2G"
+    static QString timeToDisplay(int secs); // "h:mm:ss"
+
+private:
+    qint64 rateDone, rateTime; // counts at the last rate sample
+    QString amountToDisplay(double amount);
+};
+
+#endif // INSTALLPROGRESS_H
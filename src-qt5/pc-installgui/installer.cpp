@@ -6,6 +6,7 @@
 #include <QInputDialog>
 #include <QSplashScreen>
 #include <QGraphicsPixmapItem>
+#include <QRegExp>
 #include <QScreen>
 
 #include "backend.h"
@@ -203,15 +204,47 @@ void Installer::initInstall(QSplashScreen *splash)
     // Connect the disk slots
     connect(pushDiskCustomize,SIGNAL(clicked()), this, SLOT(slotDiskCustomizeClicked()));
 
-    // Load the disks
+    // Load the disks in the background (the probes are cached until devd reports a disk change)
     splash->showMessage("Loading disk information", Qt::AlignHCenter | Qt::AlignBottom);
+    diskWatcher = new Scripts::DiskWatcher(this);
+    connect(diskWatcher, SIGNAL(disksChanged()), this, SLOT(slotDisksChanged()));
+    diskProbe = 0;
+    diskReloadPending = false;
+    wDisk = 0;
     loadDiskInfo();
     
 }
 
 void Installer::loadDiskInfo()
 {
-   sysDisks = Scripts::Backend::hardDrives();
+   if ( diskProbe != 0 ) {
+      diskReloadPending = true;
+      return;
+   }
+
+   // The disk page can't be used until all the disks are probed
+   pushDiskCustomize->setEnabled(false);
+   textEditDiskSummary->clear();
+   textEditDiskSummary->append(tr("Detecting disks..."));
+
+   diskProbe = new Scripts::DiskProbe(this);
+   connect(diskProbe, SIGNAL(finished()), this, SLOT(slotDisksProbed()));
+   diskProbe->start();
+}
+
+void Installer::slotDisksProbed()
+{
+   sysDisks = diskProbe->results();
+   diskProbe->deleteLater();
+   diskProbe = 0;
+
+   // The disks changed again while probing
+   if ( diskReloadPending ) {
+      diskReloadPending = false;
+      loadDiskInfo();
+      return;
+   }
+
    if ( sysDisks.empty() ) {
       QMessageBox::critical(this, tr("PC-BSD Installer"),
                                 tr("Unable to detect any disk drives! The install will now exit."),
@@ -235,9 +268,18 @@ void Installer::loadDiskInfo()
      textEditDiskSummary->append(summary.at(i));
 
    textEditDiskSummary->moveCursor(QTextCursor::Start);
+   pushDiskCustomize->setEnabled(true);
 
 }
 
+// devd reported a disk being attached/detached
+void Installer::slotDisksChanged()
+{
+   // Keep a layout the user has customized, only the suggested one is redone
+   if ( defaultInstall )
+      loadDiskInfo();
+}
+
 // Function which will auto-generate a partition layout based upon the target disk / slice
 bool Installer::autoGenPartitionLayout(QString target, bool isDisk)
 {
@@ -500,6 +542,7 @@ void Installer::slotDiskCustomizeClicked()
   wDisk = new wizardDisk();
   wDisk->programInit();
   wDisk->setWindowModality(Qt::ApplicationModal);
+  connect(diskWatcher, SIGNAL(disksChanged()), wDisk, SLOT(slotDisksChanged()));
   if ( radioRestore->isChecked() )
     wDisk->setRestoreMode();
   connect(wDisk, SIGNAL(saved(QList<QStringList>, QString, QString, QString, bool, QString)), this, SLOT(slotSaveDiskChanges(QList<QStringList>, QString, QString, QString, bool, QString)));
@@ -1186,6 +1229,10 @@ QStringList Installer::getDiskCfgSettings()
 // Slot which checks any disk requirements before procceding to the next page
 bool Installer::checkDiskRequirements()
 {
+  // Wait for the disks to be probed
+  if ( diskProbe != 0 )
+    return false;
+
   // For now just return true, the wizard should handle making sure
   // the user doesn't shoot themselves in the foot during disk setup
   return true;
@@ -1216,7 +1263,7 @@ void Installer::startInstall()
   installFoundCounter = false;
   installFoundMetaCounter = false;
   installFoundFetchOutput = false;
-  inZFSSend = false;
+  resetInstallProgress();
 
   // Setup some defaults for the secondary progress bar
   progressBarInstall2->setValue(0); 
@@ -1331,43 +1378,36 @@ void Installer::slotReadInstallerOutput()
   while ( installProc->canReadLine() )
   {
      tmp = installProc->readLine();
+
+     // Progress records (phase, done/total and time) drive the progress bar directly
+     if ( instProgress.parseLine(tmp) ) {
+       showInstallProgress();
+       continue;
+     }
+
      tmp.truncate(75);
      //qDebug() << tmp;
 
      // If doing a restore we can do all parsing right here
      if ( radioRestore->isChecked() ) {
-       line = tmp;
-
-       if ( tmp.contains("total estimated size"))
-       {  
-          repTotalK = line.section(" ",-1).simplified();
-	  double totSize = displayToDoubleK(repTotalK);
-          progressBarInstall->setRange(0, totSize + 1024);
-	  inZFSSend = true;
-          continue;
-       } 
        if ( tmp.contains("Moving datasets to"))
-          inZFSSend=false;
-
-       if( line.contains("send from ") )
-	 continue;
-       if( line.contains("TIME ") )
-         continue;
+          resetInstallProgress();
 
-       labelInstallStatus->setText(tmp);
-
-       if ( ! inZFSSend )
+       // The zfs send -vP status lines are shown through the progress records (errors still show up)
+       if ( tmp.indexOf("full\t") == 0 || tmp.indexOf("incremental\t") == 0 || tmp.indexOf("size\t") == 0
+            || tmp.contains(QRegExp("^\\d+:\\d\\d:\\d\\d\t")) )
           continue;
 
-       // We got here, lets parse the ZFS send message
-       parseStatusMessage(tmp);
-
+       labelInstallStatus->setText(tmp);
        continue;
      } // End of restore parsing
 
      // Parse fetch output
      if ( installFoundFetchOutput ) {
        if ( tmp.indexOf("SIZE: ") != -1 ) {
+          // Already shown through the progress records
+          if ( instProgress.phase == "fetch" )
+             continue;
 
           // Get the total range first
           line = tmp;
@@ -1388,6 +1428,7 @@ void Installer::slotReadInstallerOutput()
 	  continue;
         } else {
           installFoundFetchOutput = false;
+          resetInstallProgress();
 	  break;
         }
      } 
@@ -1459,12 +1500,14 @@ void Installer::slotReadInstallerOutput()
        } 
 
 
-       // Increment the progress
-       progressBarInstall->setValue(progressBarInstall->value() + 1); 
+       // Increment the progress (unless the progress records are doing it)
+       if ( instProgress.phase != "extract" )
+         progressBarInstall->setValue(progressBarInstall->value() + 1); 
 
        // We've reached the end of this counted section
        if ( tmp.indexOf("Extraction Finished") != -1 ) {
          installFoundCounter = false;
+         resetInstallProgress();
          progressBarInstall->setRange(0, 0);  
        }
 
@@ -1475,13 +1518,15 @@ void Installer::slotReadInstallerOutput()
      if ( installFoundMetaCounter ) {
 	// Check if we are on the next meta-pkg
         if ( tmp.indexOf("Installing package: ") != -1 ) {
-           progressBarInstall->setValue(progressBarInstall->value() + 1); 
+           if ( instProgress.phase != "packages" )
+             progressBarInstall->setValue(progressBarInstall->value() + 1); 
            labelInstallStatus->setText(tr("Installing meta-package: %1").arg(tmp.section(":", 1, 5))); 
 	   continue;
 	}
 
         if ( tmp.indexOf("Package installation complete!") != -1 ) {
            installFoundMetaCounter = false;
+           resetInstallProgress();
            progressBarInstall->setRange(0, 0);  
            progressBarInstall2->setHidden(true);
            labelInstallStatus2->setHidden(true);
@@ -1852,48 +1897,30 @@ void Installer::slotSaveRestoreSettings(QStringList Opts)
   installStackWidget->setCurrentIndex(installStackWidget->currentIndex() + 1);
 }
 
-void Installer::parseStatusMessage(QString stat){
-  //qDebug() << "msg:" << stat;
-  QString dispTotal;
-
-  //Divide up the status message into sections
-  stat.replace("\t"," ");
-  QString cSize = stat.section(" ",1,1,QString::SectionSkipEmpty);
-
-  //Now Setup the tooltip
-  if(!repTotalK.isEmpty()){
-    double c = displayToDoubleK(cSize);
-    progressBarInstall->setValue(c);
-    dispTotal = repTotalK;
+// Show the last progress record from pc-sysinstall
+void Installer::showInstallProgress()
+{
+  int pm = instProgress.permille();
+  if ( pm < 0 ) {
+    progressBarInstall->setRange(0, 0);
   } else {
-    dispTotal = "??";
+    progressBarInstall->setRange(0, 1000);
+    progressBarInstall->setValue(pm);
   }
+  // Add the throughput and time left to the bar
+  progressBarInstall->setFormat(QString("%p% - %1").arg(instProgress.summary()));
 
-  //Format the tooltip String
-  QString status = cSize+"/"+dispTotal;
-
-  QString txt = QString(tr("Restoring system: %1")).arg(status);
-  labelInstallStatus->setText(txt);
-
+  if ( instProgress.phase == "restore" )
+    labelInstallStatus->setText(tr("Restoring system: %1").arg(instProgress.summary()));
 }
 
-double Installer::displayToDoubleK(QString displayNumber){
-  QStringList labels;
-    labels << "K" << "M" << "G" << "T" << "P" << "E";
-  QString clab = displayNumber.right(1); //last character is the size label
-        displayNumber.chop(1); //remove the label from the number
-  double num = displayNumber.toDouble();
-  //Now format the number properly
-  bool ok = false;
-  for(int i=0; i<labels.length(); i++){
-    if(labels[i] == clab){ ok = true; break; }
-    else{ num = num*1024; } //get ready for the next size
-  }
-  if(!ok){ num = -1; } //could not determine the size
-  return num;
+// Back to the plain progress bar, once a phase is done
+void Installer::resetInstallProgress()
+{
+  instProgress.clear();
+  progressBarInstall->setFormat("%p%");
 }
 
-
 void Installer::slotEmergencyShell() {
   system("xterm -e /root/PCBSDUtil.sh &");
 }
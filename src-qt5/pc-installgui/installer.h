@@ -26,6 +26,7 @@
 #define wXFCE 6
 
 #include "backend.h"
+#include "installProgress.h"
 
 class Installer : public QMainWindow, private Ui::Installer
 {
@@ -47,6 +48,8 @@ private slots:
 
     // Disk slots
     void slotDiskCustomizeClicked();
+    void slotDisksProbed();
+    void slotDisksChanged();
     void slotSaveDiskChanges(QList<QStringList>, QString, QString, QString, bool, QString);
 
     // Slots for the installation
@@ -87,11 +90,10 @@ private:
     void startInstall(); // Function which begins the install process
     void installFailed(); // Function which does post-install failure stuff
 
-    // Functions to parse ZFS send/recv messages
-    bool inZFSSend;
-    double displayToDoubleK(QString);
-    void parseStatusMessage(QString);
-    QString repTotalK;
+    // Structured progress records from pc-sysinstall
+    InstallProgress instProgress;
+    void showInstallProgress();
+    void resetInstallProgress();
 
     // Disk functions
     void loadDiskInfo();
@@ -182,6 +184,9 @@ private:
 
     // Disk setup wizard
     wizardDisk *wDisk;
+    Scripts::DiskWatcher *diskWatcher;
+    Scripts::DiskProbe *diskProbe; // Probes the disks in the background (see loadDiskInfo())
+    bool diskReloadPending; // The disks changed while they were being probed
     //QTranslator *translator;
 
     // Custom CFG file to install with
@@ -4,7 +4,7 @@
 TARGET = pc-sysinstaller
 target.path = /usr/local/bin/
 TEMPLATE = app
-QT += core gui widgets
+QT += core gui widgets network
 LIBS += -L/usr/local/lib
 SOURCES += main.cpp \
     dialogCheckHardware.cpp \
@@ -16,6 +16,7 @@ SOURCES += main.cpp \
     wizardFreeBSD.cpp \
     wizardRestore.cpp \
     installer.cpp \
+    installProgress.cpp \
     backend.cpp
 HEADERS += installer.h \
     dialogCheckHardware.h \
@@ -27,6 +28,7 @@ HEADERS += installer.h \
     wizardFreeBSD.h \
     wizardRestore.h \
     helpText.h \
+    installProgress.h \
     backend.h
 TRANSLATIONS =  i18n/SysInstaller_af.ts \
 		i18n/SysInstaller_ar.ts \
@@ -0,0 +1,13 @@
+QT       += core widgets network testlib
+CONFIG   += testcase console
+
+TARGET = tst_diskprobe
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+HEADERS += ../../backend.h
+SOURCES += tst_diskprobe.cpp \
+	../../backend.cpp
+
+OTHER_FILES += stub-pc-sysinstall
@@ -0,0 +1,96 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSignalSpy>
+
+#include "backend.h"
+
+using namespace Scripts;
+
+// Number of disks listed by the stub and the time each of its disk-info/disk-part calls takes
+#define STUB_DISKS 16
+#define STUB_DELAY_MSEC 250
+
+// Probes the disks of a stub pc-sysinstall which is slow to answer (like a storage server)
+class tst_DiskProbe : public QObject {
+	Q_OBJECT
+private slots:
+    void initTestCase();
+    void probeOneDisk();
+    void parallelIsFaster();
+    void reportsInOrder();
+};
+
+void tst_DiskProbe::initTestCase()
+{
+    QString stub = QFINDTESTDATA("stub-pc-sysinstall");
+    QVERIFY( QFileInfo(stub).isExecutable() );
+    qputenv("PCSYSINSTALL", QFileInfo(stub).absoluteFilePath().toLocal8Bit());
+    qputenv("STUB_DISKS", QByteArray::number(STUB_DISKS));
+    qputenv("STUB_DELAY", QByteArray::number(STUB_DELAY_MSEC / 1000.0));
+}
+
+void tst_DiskProbe::probeOneDisk()
+{
+    QList<QStringList> info = Backend::probeDisk("da3", "<SEAGATE ST4000NM0023 0004> (stub)");
+    QCOMPARE( info.count(), 5 );
+    QCOMPARE( info.at(0), QStringList() << "DRIVE" << "da3" << "3815447" << "<SEAGATE ST4000NM0023 0004> (stub)" << "GPT" );
+    QCOMPARE( info.at(1), QStringList() << "FORMAT" << "da3" << "GPT" );
+    QCOMPARE( info.at(2), QStringList() << "SLICE" << "da3" << "da3p1" << "200" << "efi" );
+    QCOMPARE( info.at(3), QStringList() << "SLICE" << "da3" << "da3p2" << "3800000" << "freebsd-zfs" );
+    QCOMPARE( info.at(4), QStringList() << "SLICE" << "da3" << "da3p3" << "15247" << "Unused Space" );
+}
+
+void tst_DiskProbe::parallelIsFaster()
+{
+    QElapsedTimer timer;
+
+    // The old way: probe one disk after the other
+    timer.start();
+    QList<QStringList> sequential;
+    Process p(QStringList() << "disk-list");
+    QVERIFY( p.waitForFinished() );
+    while ( p.canReadLine() ) {
+      QString line = p.readLine();
+      QString dev = line.simplified();
+      dev.truncate(line.indexOf(":"));
+      QString devinfo = line.simplified().remove(0, line.indexOf(":") + 1);
+      sequential << Backend::probeDisk(dev, devinfo);
+    }
+    qint64 seqTime = timer.elapsed();
+
+    timer.restart();
+    QList<QStringList> parallel = Backend::hardDrives();
+    qint64 parTime = timer.elapsed();
+
+    qDebug() << "Probing" << STUB_DISKS << "disks: sequential" << seqTime << "ms, parallel" << parTime << "ms";
+    QCOMPARE( sequential.count(), STUB_DISKS * 5 );
+    QCOMPARE( parallel, sequential );
+    QVERIFY( seqTime >= STUB_DISKS * 2 * STUB_DELAY_MSEC );
+    // 8 disks at a time: about 2 rounds of 2 calls instead of 16 (plenty of slack for slow machines)
+    QVERIFY2( parTime * 3 < seqTime, qPrintable(QString("parallel probe took %1 ms").arg(parTime)) );
+}
+
+void tst_DiskProbe::reportsInOrder()
+{
+    DiskProbe probe;
+    QSignalSpy probed(&probe, SIGNAL(diskProbed(QString, QList<QStringList>)));
+    QSignalSpy finished(&probe, SIGNAL(finished()));
+    probe.start();
+    QVERIFY( probe.isRunning() );
+
+    QTRY_COMPARE_WITH_TIMEOUT( finished.count(), 1, 20000 );
+    QVERIFY( !probe.isRunning() );
+
+    QCOMPARE( probed.count(), STUB_DISKS );
+    for (int i=0; i < probed.count(); ++i) {
+      QCOMPARE( probed.at(i).at(0).toString(), QString("da%1").arg(i) );
+      QList<QStringList> info = probed.at(i).at(1).value< QList<QStringList> >();
+      QCOMPARE( info.count(), 5 );
+      QCOMPARE( info.at(0).at(1), QString("da%1").arg(i) );
+    }
+    QCOMPARE( probe.results().count(), STUB_DISKS * 5 );
+}
+
+QTEST_GUILESS_MAIN(tst_DiskProbe)
+#include "tst_diskprobe.moc"
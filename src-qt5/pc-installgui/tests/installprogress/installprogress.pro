@@ -0,0 +1,14 @@
+QT       += core testlib
+QT       -= gui
+CONFIG   += testcase console
+
+TARGET = tst_installprogress
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+HEADERS += ../../installProgress.h
+SOURCES += tst_installprogress.cpp \
+	../../installProgress.cpp
+
+OTHER_FILES += install-output.txt
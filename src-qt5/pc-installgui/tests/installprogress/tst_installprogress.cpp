@@ -0,0 +1,160 @@
+#include <QtTest>
+#include <QFile>
+
+#include "installProgress.h"
+
+// Replays recorded pc-sysinstall output (progress records mixed with the old lines) through InstallProgress
+class tst_InstallProgress : public QObject {
+	Q_OBJECT
+private:
+    QStringList output;
+    InstallProgress replay(int records); // progress after the first "records" progress records
+
+private slots:
+    void initTestCase();
+    void fetchStarted();
+    void fetchRunning();
+    void fetchDone();
+    void newPhase();
+    void newArchive();
+    void messageWithSpaces();
+    void otherLines();
+    void display();
+};
+
+InstallProgress tst_InstallProgress::replay(int records)
+{
+    InstallProgress prog;
+    int found = 0;
+    for (int i=0; i < output.count() && found < records; ++i) {
+      if ( prog.parseLine(output.at(i)) )
+        found++;
+    }
+    return prog;
+}
+
+void tst_InstallProgress::initTestCase()
+{
+    QFile file(QFINDTESTDATA("install-output.txt"));
+    QVERIFY( file.open(QIODevice::ReadOnly | QIODevice::Text) );
+    output = QString(file.readAll()).split("\n");
+    // Every "PROGRESS:" line is a record, nothing else is
+    InstallProgress prog;
+    int records = 0;
+    for (int i=0; i < output.count(); ++i) {
+      bool isRecord = prog.parseLine(output.at(i));
+      QCOMPARE( isRecord, output.at(i).startsWith("PROGRESS: ") );
+      if ( isRecord )
+        records++;
+    }
+    QCOMPARE( records, 10 );
+}
+
+void tst_InstallProgress::fetchStarted()
+{
+    InstallProgress prog = replay(1);
+    QCOMPARE( prog.phase, QString("fetch") );
+    QCOMPARE( prog.unit, QString("bytes") );
+    QCOMPARE( prog.msg, QString("base.txz") );
+    QCOMPARE( prog.done, qint64(0) );
+    QCOMPARE( prog.total, qint64(104857600) );
+    QCOMPARE( prog.startTime, qint64(1425200000) );
+    QCOMPARE( prog.permille(), 0 );
+    // No rate yet
+    QCOMPARE( prog.rate, 0.0 );
+    QCOMPARE( prog.secsLeft(), -1 );
+    QCOMPARE( prog.summary(), QString("0B/100M") );
+}
+
+void tst_InstallProgress::fetchRunning()
+{
+    InstallProgress prog = replay(2);
+    QCOMPARE( prog.rate, 10485760.0 );
+    QCOMPARE( prog.permille(), 200 );
+    QCOMPARE( prog.secsLeft(), 8 );
+    QCOMPARE( prog.summary(), QString("20M/100M, 10M/s, 0:00:08 left") );
+
+    // The faster second sample only moves the rate part of the way
+    prog = replay(3);
+    QVERIFY( qFuzzyCompare(prog.rate, 0.2 * 15728640 + 0.8 * 10485760) );
+    QCOMPARE( prog.permille(), 500 );
+    QCOMPARE( prog.secsLeft(), 4 );
+    QCOMPARE( prog.lastTime, qint64(1425200004) );
+    QCOMPARE( prog.startTime, qint64(1425200000) );
+}
+
+void tst_InstallProgress::fetchDone()
+{
+    InstallProgress prog = replay(4);
+    QCOMPARE( prog.done, prog.total );
+    QCOMPARE( prog.permille(), 1000 );
+    QCOMPARE( prog.secsLeft(), 0 );
+    QVERIFY( !prog.summary().contains("left") );
+}
+
+void tst_InstallProgress::newPhase()
+{
+    InstallProgress prog = replay(5);
+    QCOMPARE( prog.phase, QString("extract") );
+    QCOMPARE( prog.unit, QString("items") );
+    QVERIFY( prog.msg.isEmpty() );
+    QCOMPARE( prog.startTime, qint64(1425200007) );
+    QCOMPARE( prog.rate, 0.0 );
+
+    prog = replay(8);
+    QCOMPARE( prog.done, qint64(2500) );
+    QCOMPARE( prog.permille(), 625 );
+    QVERIFY( qFuzzyCompare(prog.rate, 0.2 * 500 + 0.8 * (0.2 * 1000 + 0.8 * 999)) );
+    QCOMPARE( prog.secsLeft(), 1 );
+    QCOMPARE( prog.summary(), QString("2500/4000, 899.3/s, 0:00:01 left") );
+}
+
+void tst_InstallProgress::newArchive()
+{
+    // Same phase, but the count went back: next archive, the rate starts over
+    InstallProgress prog = replay(9);
+    QCOMPARE( prog.phase, QString("extract") );
+    QCOMPARE( prog.done, qint64(10) );
+    QCOMPARE( prog.total, qint64(500) );
+    QCOMPARE( prog.startTime, qint64(1425200020) );
+    QCOMPARE( prog.rate, 0.0 );
+    QCOMPARE( prog.permille(), 20 );
+    QCOMPARE( prog.secsLeft(), -1 );
+}
+
+void tst_InstallProgress::messageWithSpaces()
+{
+    InstallProgress prog = replay(10);
+    QCOMPARE( prog.phase, QString("packages") );
+    QCOMPARE( prog.msg, QString("Installing xorg-server-1.14.7_5") );
+    QCOMPARE( prog.done, qint64(3) );
+    QCOMPARE( prog.permille(), 300 );
+}
+
+void tst_InstallProgress::otherLines()
+{
+    InstallProgress prog = replay(2);
+    QVERIFY( !prog.parseLine("") );
+    QVERIFY( !prog.parseLine("FETCH: base.txz") );
+    QVERIFY( !prog.parseLine("PROGRESS: phase=fetch") ); // no count/time
+    QVERIFY( !prog.parseLine("PROGRESS: done=5 time=1425200003") ); // no phase
+    QVERIFY( !prog.parseLine("Extracting PROGRESS: phase=fetch done=1 time=1") );
+    QCOMPARE( prog.done, qint64(20971520) );
+    QCOMPARE( prog.lastTime, qint64(1425200002) );
+    // Leading/trailing blanks and unknown fields are fine
+    QVERIFY( prog.parseLine("  PROGRESS: phase=fetch done=31457280 total=104857600 unit=bytes eta=4 time=1425200003\n") );
+    QCOMPARE( prog.done, qint64(31457280) );
+    QCOMPARE( prog.msg, QString("base.txz") ); // kept until a new one is given
+}
+
+void tst_InstallProgress::display()
+{
+    QCOMPARE( InstallProgress::bytesToDisplay(512), QString("512B") );
+    QCOMPARE( InstallProgress::bytesToDisplay(1536), QString("1.5K") );
+    QCOMPARE( InstallProgress::bytesToDisplay(1073741824.0), QString("1G") );
+    QCOMPARE( InstallProgress::timeToDisplay(59), QString("0:00:59") );
+    QCOMPARE( InstallProgress::timeToDisplay(3661), QString("1:01:01") );
+}
+
+QTEST_GUILESS_MAIN(tst_InstallProgress)
+#include "tst_installprogress.moc"
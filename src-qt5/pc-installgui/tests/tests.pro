@@ -0,0 +1,5 @@
+# Unit tests for pc-installgui (run with "qmake && make check")
+TEMPLATE = subdirs
+
+SUBDIRS += diskprobe \
+	installprogress
@@ -19,6 +19,8 @@ void wizardDisk::programInit()
 {
   prevID = 0;
   restoreMode=false;
+  diskProbe = 0;
+  diskReloadPending = false;
 
   populateDiskInfo();
 
@@ -71,18 +73,66 @@ void wizardDisk::programInit()
 void wizardDisk::populateDiskInfo()
 {
   qDebug() << "Loading Disk Info";
-  sysDisks = Scripts::Backend::hardDrives();
+  sysDisks.clear();
+  comboDisk->clear();
+
+  // The drives are added as they get probed
+  diskProbe = new Scripts::DiskProbe(this);
+  connect(diskProbe, SIGNAL(diskProbed(QString, QList<QStringList>)), this, SLOT(slotDiskProbed(QString, QList<QStringList>)));
+  connect(diskProbe, SIGNAL(finished()), this, SLOT(slotDisksProbed()));
+  diskProbe->start();
+}
+
+void wizardDisk::slotDiskProbed(QString disk, QList<QStringList> info)
+{
+  qDebug() << "Probed Disk:" << disk;
+  sysDisks << info;
 
   // load drives
-  comboDisk->clear();
-  for (int i=0; i < sysDisks.count(); ++i) {
+  for (int i=0; i < info.count(); ++i) {
     // Make sure to only add the drives to the comboDisk
-    if ( sysDisks.at(i).at(0) == "DRIVE" )
-      comboDisk->addItem(sysDisks.at(i).at(1) + " - " + sysDisks.at(i).at(2) + "MB " + sysDisks.at(i).at(3));
+    if ( info.at(i).at(0) == "DRIVE" )
+      comboDisk->addItem(info.at(i).at(1) + " - " + info.at(i).at(2) + "MB " + info.at(i).at(3));
   }
 
-  // Reload the slice list box
-  slotChangedDisk();
+  // Reload the slice list box once the first disk shows up (or the one which was selected before a reload)
+  if ( comboDisk->count() == 1 )
+    slotChangedDisk();
+  if ( ! reselectDisk.isEmpty() && comboDisk->currentText().section(" - ", 0, 0) != reselectDisk ) {
+    for (int i=0; i < comboDisk->count(); ++i) {
+      if ( comboDisk->itemText(i).section(" - ", 0, 0) == reselectDisk ) {
+        comboDisk->setCurrentIndex(i); // also reloads the slice list
+        break;
+      }
+    }
+  }
+}
+
+void wizardDisk::slotDisksProbed()
+{
+  diskProbe->deleteLater();
+  diskProbe = 0;
+  reselectDisk.clear();
+  if ( diskReloadPending ) {
+    diskReloadPending = false;
+    slotDisksChanged();
+    return;
+  }
+  slotCheckComplete();
+}
+
+void wizardDisk::slotDisksChanged()
+{
+  // Only the disk selection pages use the list directly, later pages keep the layout made from it
+  if ( currentId() != Page_Intro && currentId() != Page_BasicDisk )
+    return;
+  if ( diskProbe != 0 ) {
+    diskReloadPending = true;
+    return;
+  }
+  reselectDisk = comboDisk->currentText().section(" - ", 0, 0);
+  populateDiskInfo();
+  slotCheckComplete();
 }
 
 void wizardDisk::slotChangedDisk()
@@ -296,7 +346,12 @@ bool wizardDisk::validatePage()
          button(QWizard::NextButton)->setEnabled(true);
          return true;
      case Page_BasicDisk:
-	
+	 // Wait for all the disks to be probed
+	 if ( diskProbe != 0 ) {
+	   button(QWizard::NextButton)->setEnabled(false);
+	   return false;
+	 }
+
 	 if ( ! radioAdvanced->isChecked() ) {
 	   radioGPT->setChecked(true);
 	   groupScheme->setVisible(false);
@@ -23,6 +23,7 @@ public:
     virtual int nextId() const;
 
 public slots:
+    void slotDisksChanged(); // devd reported a disk change, probe the disks again
 
 protected:
 
@@ -40,6 +41,8 @@ private slots:
     void slotTerminal();
     void slotSwapSize();
     void slotUEFIClicked();
+    void slotDiskProbed(QString, QList<QStringList>);
+    void slotDisksProbed();
  
     // QMenu slots
     void slotZCMON();
@@ -81,6 +84,9 @@ private:
      int systemMemory;
      int swapsize;
     QList<QStringList> sysDisks; // Our lists which contains disk info
+    Scripts::DiskProbe *diskProbe; // Fills sysDisks while the disks are being probed
+    bool diskReloadPending; // The disks changed while they were being probed
+    QString reselectDisk; // Disk to select again once it shows up after a reload
     QList<QStringList> sysPartitions; // Our lists which contains partition info
     QList<QStringList> sysFinalDiskLayout; // The final disk layout
     QString addingMount;
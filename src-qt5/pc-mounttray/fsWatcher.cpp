@@ -1,10 +1,15 @@
 #include "fsWatcher.h"
 
+#include <sys/param.h>
+#include <sys/ucred.h>
+#include <sys/mount.h>
+
 FSWatcher::FSWatcher() : QObject(){
   //setup the timer
   timer = new QTimer();
   timer->setSingleShot(true);
-  QObject::connect(timer, SIGNAL(timeout()), this, SLOT(checkFS()));
+  QObject::connect(timer, SIGNAL(timeout()), this, SLOT(pollFS()));
+  maxMS = 3600000;
 }
 
 FSWatcher::~FSWatcher(){
@@ -12,7 +17,8 @@ FSWatcher::~FSWatcher(){
 
 void FSWatcher::start(int ms){ 
     timer->stop();
-    timer->setInterval(ms); //max time between system checks
+    maxMS = ms; //max time between system checks
+    timer->setInterval(ms);
     timer->start(); 
     QTimer::singleShot(2000,this,SLOT(checkFS()) ); //make sure to perform a check when it starts up
 }
@@ -24,61 +30,59 @@ void FSWatcher::stop(){
 QStringList FSWatcher::getFSmountpoints(){
   //output line format: name::filesystem::totalspace::usedspace::percent
   // -- sizes all in K
-  QStringList output; 
-  //ZFS Checks
-  QStringList zpools = runCMD("zpool list -o name");
-  if(zpools.length() > 1){ 
-    //Then there are ZFS pools available
-    for(int i=1; i<zpools.length(); i++){ //skip the header line
-      QStringList tmp = runCMD("zfs list -o available,used "+zpools[i]);
-      //second line contains the data
-      tmp[1] = tmp[1].replace("\t"," "); //ensure no tab characters in the output
-      QString avail = tmp[1].section(" ",0,0,QString::SectionSkipEmpty);
-      QString used = tmp[1].section(" ",1,1,QString::SectionSkipEmpty);
-      double iUsed = floor(displayToDouble(used));
-      double iTotal = floor(displayToDouble(avail)) + iUsed;
-      if(iUsed <=0 || iTotal <=0){ continue; } //skip this line - error getting values
-      int percent = calculatePercentage(iUsed, iTotal);
-      //qDebug() << "Percent calc: tot:"<<iTotal<<"used"<<iUsed<<"percent"<<percent;
-      //format the output string and add it in
-      output << zpools[i]+"::zfs::"+QString::number(iTotal)+"::"+QString::number(iUsed)+"::"+QString::number(percent);
-    }
+  return getUsage( listMounts() );
+}
+
+QStringList FSWatcher::listMounts(){
+  //output line format: mountpoint::filesystem (a single "::zfs" entry for all the ZFS pools)
+  QStringList output;
+  struct statfs *mnt;
+  int num = getmntinfo(&mnt, MNT_NOWAIT); //kernel mount table - no disk access
+  bool zfs = false;
+  QStringList ignore; ignore << "devfs" << "procfs" << "linprocfs" << "linsysfs" << "fdescfs" << "cd9660" << "nullfs" << "fusefs" << "autofs";
+  for(int i=0; i<num; i++){
+    QString fs = QString(mnt[i].f_fstypename);
+    QString name = QString::fromLocal8Bit(mnt[i].f_mntonname);
+    if(fs=="zfs"){ zfs = true; } //pools are checked as a whole (not per dataset)
+    else if(ignore.contains(fs) || name.contains("/boot/efi")){} //ignore certain filesystems
+    else{ output << name+"::"+fs; }
   }
-  //Now get all the rest of the mounted filesystems
-  QStringList dfout = runCMD("df -h -T");
-  //Format: name, filesystem, size, used, available, percent, mountpoint 
-  for(int i=1; i<dfout.length(); i++){
-    //ignore certain filesystems
-    if(dfout[i].startsWith("devfs")){}
-    else if(dfout[i].startsWith("procfs")){}
-    else if(dfout[i].startsWith("linprocfs")){}
-    else if(dfout[i].startsWith("linsysfs")){}
-    else if(dfout[i].startsWith("fdescfs")){}
-    else if(dfout[i].contains("/boot/efi")){}
-    else{
-      //Now parse out the info  
-      dfout[i].replace("\t"," ");
-      QString fs = dfout[i].section("  ",1,1,QString::SectionSkipEmpty).simplified();
-      if(fs != "zfs" && fs!="cd9660" && fs!="nullfs" && fs!="fusefs" && fs!="autofs"){  //ignore zfs filesystems (already taken care of)
-        QString name = dfout[i].section("  ",6,6,QString::SectionSkipEmpty).simplified();
-        QString total = dfout[i].section("  ",2,2,QString::SectionSkipEmpty).simplified();
-        QString used = dfout[i].section("  ",3,3,QString::SectionSkipEmpty).simplified();
-        //Calculate the percent
-        double iUsed = displayToDouble(used);
-        double iTotal = displayToDouble(total);
-	if(iUsed <=0 || iTotal <=0){ continue; } //skip this line - error getting values
+  if(zfs){ output.prepend("::zfs"); }
+  return output;
+}
+
+QStringList FSWatcher::getUsage(QStringList mountlist){
+  QStringList output; 
+  for(int i=0; i<mountlist.length(); i++){
+    QString name = mountlist[i].section("::",0,0);
+    QString fs = mountlist[i].section("::",1,1);
+    if(fs=="zfs"){
+      //ZFS Checks (exact byte counts for the root dataset of every pool)
+      QStringList zpools = runCMD("zfs list -H -p -d 0 -o name,available,used");
+      for(int j=0; j<zpools.length(); j++){
+        QStringList info = zpools[j].split("\t");
+        if(info.length() < 3){ continue; }
+        double iUsed = floor(info[2].toDouble()/1024);
+        double iTotal = floor(info[1].toDouble()/1024) + iUsed;
+        if(iUsed <=0 || iTotal <=0){ continue; } //skip this line - error getting values
         int percent = calculatePercentage(iUsed, iTotal);
-        //qDebug() << "df Item:" << dfout[i];
-        //qDebug() << " - Detected:" << name << fs << iTotal << iUsed << percent;
-        //format the output string and add it in
-        output << name+"::"+fs+"::"+QString::number(iTotal)+"::"+QString::number(iUsed)+"::"+QString::number(percent);
+        output << info[0]+"::zfs::"+QString::number(iTotal,'f',0)+"::"+QString::number(iUsed,'f',0)+"::"+QString::number(percent);
       }
+      continue;
     }
+    //All other filesystems: ask the kernel directly
+    struct statfs sfs;
+    if( statfs(name.toLocal8Bit().constData(), &sfs) != 0 ){ continue; }
+    double iTotal = ((double) sfs.f_blocks) * sfs.f_bsize / 1024;
+    double iUsed = ((double) sfs.f_blocks - sfs.f_bfree) * sfs.f_bsize / 1024;
+    if(iUsed <=0 || iTotal <=0){ continue; } //skip this line - error getting values
+    int percent = calculatePercentage(iUsed, iTotal);
+    //format the output string and add it in
+    output << name+"::"+fs+"::"+QString::number(iTotal,'f',0)+"::"+QString::number(iUsed,'f',0)+"::"+QString::number(percent);
   }
   //Return the results
   //qDebug() << "FS output:" << output;
   return output;
-  
 }
 
 int FSWatcher::displayToDouble(QString entry){
@@ -121,14 +125,34 @@ QString FSWatcher::doubleToDisplay(double K){
 
 //====== Public Slot =======
 void FSWatcher::checkFS(){
-  QStringList devList = getFSmountpoints();
+  scanFS(true);
+}
+
+//====== Private Slot =======
+void FSWatcher::pollFS(){
+  scanFS(false);
+}
+
+void FSWatcher::scanFS(bool rescan){
+  //Only re-read the mounts (and the ZFS pools) when something was mounted/unmounted
+  QString table = mountTable();
+  if(rescan || table != mountTab){
+    mountTab = table;
+    mounts = listMounts();
+    if(mounts.removeAll("::zfs") > 0){ readZfsPools(); }
+    else{ zfsTotal.clear(); zfsUsed.clear(); zfsPath.clear(); }
+  }
+  QStringList devList = getUsage(mounts) + zfsUsage();
   QStringList badDevs;
+  int headroom = 100; //smallest distance to the warning level
   for(int i=0; i<devList.length(); i++){
     int percent = devList[i].section("::",4,4).toInt();
-    if(percent > 90){
+    if(percent > FS_WARN_PERCENT){
       //Device greater than 90% full, warn the user
       badDevs << devList[i].section("::",0,0); //list the mountpoint
       qDebug() << "WARNING: Device almost full:" << devList[i].section("::",0,0)+": "+QString::number(percent)+"% full: Time: "+QTime::currentTime().toString();
+    }else if(FS_WARN_PERCENT - percent < headroom){
+      headroom = FS_WARN_PERCENT - percent;
     }
   }
   if(!badDevs.isEmpty()){
@@ -145,8 +169,70 @@ void FSWatcher::checkFS(){
   }
   //Save the current badDevs as the old list
   oldBadDevs = badDevs;
-  //Reset the timer for the next time this function is to be called
-  timer->start(); //reset the timer again
+  //Reset the timer for the next check: the closer a filesystem is to the warning level, the sooner
+  int ms = maxMS;
+  if(headroom < 50){ ms = qMax(FS_MIN_CHECK_MS, (int) ((qint64) maxMS * headroom / 50) ); }
+  if(ms > maxMS){ ms = maxMS; }
+  timer->start(ms);
+}
+
+QString FSWatcher::mountTable(){
+  //Sorted "mountpoint<tab>device" list of the kernel mount table (no disk access)
+  QStringList table;
+  struct statfs *mnt;
+  int num = getmntinfo(&mnt, MNT_NOWAIT);
+  for(int i=0; i<num; i++){
+    table << QString::fromLocal8Bit(mnt[i].f_mntonname)+"\t"+QString::fromLocal8Bit(mnt[i].f_mntfromname);
+  }
+  table.sort();
+  return table.join("\n");
+}
+
+void FSWatcher::readZfsPools(){
+  zfsTotal.clear(); zfsUsed.clear(); zfsPath.clear();
+  //Exact sizes for the root dataset of every pool
+  QStringList zpools = runCMD("zfs list -H -p -d 0 -o name,available,used");
+  for(int i=0; i<zpools.length(); i++){
+    QStringList info = zpools[i].split("\t");
+    if(info.length() < 3){ continue; }
+    double iUsed = floor(info[2].toDouble()/1024);
+    double iTotal = floor(info[1].toDouble()/1024) + iUsed;
+    if(iUsed <=0 || iTotal <=0){ continue; } //skip this line - error getting values
+    zfsTotal.insert(info[0], iTotal);
+    zfsUsed.insert(info[0], iUsed);
+  }
+  //The space left in a pool can be read from any of its mounted datasets (the closest one to the root is used)
+  QHash<QString, QString> datasets;
+  struct statfs *mnt;
+  int num = getmntinfo(&mnt, MNT_NOWAIT);
+  for(int i=0; i<num; i++){
+    if(QString(mnt[i].f_fstypename) != "zfs"){ continue; }
+    QString dataset = QString::fromLocal8Bit(mnt[i].f_mntfromname);
+    QString pool = dataset.section("/",0,0);
+    if(!zfsTotal.contains(pool)){ continue; }
+    if(!datasets.contains(pool) || dataset.count("/") < datasets[pool].count("/")){
+      datasets.insert(pool, dataset);
+      zfsPath.insert(pool, QString::fromLocal8Bit(mnt[i].f_mntonname));
+    }
+  }
+}
+
+QStringList FSWatcher::zfsUsage(){
+  //output line format: pool::zfs::totalspace::usedspace::percent
+  QStringList output;
+  QHash<QString, double>::const_iterator it;
+  for(it = zfsTotal.constBegin(); it != zfsTotal.constEnd(); ++it){
+    double iTotal = it.value();
+    double iUsed = zfsUsed.value(it.key()); //numbers from the last "zfs list" if no dataset is mounted
+    struct statfs sfs;
+    if( zfsPath.contains(it.key()) && statfs(zfsPath[it.key()].toLocal8Bit().constData(), &sfs) == 0 ){
+      iUsed = iTotal - ((double) sfs.f_bavail) * sfs.f_bsize / 1024;
+    }
+    if(iUsed <=0 || iTotal <=0){ continue; }
+    int percent = calculatePercentage(iUsed, iTotal);
+    output << it.key()+"::zfs::"+QString::number(iTotal,'f',0)+"::"+QString::number(iUsed,'f',0)+"::"+QString::number(percent);
+  }
+  return output;
 }
 
 //===== Calculate Percentages =====
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QHash>
 #include <QTimer>
 #include <QProcess>
 #include <QProcessEnvironment>
@@ -13,6 +14,9 @@
 
 #include <math.h>
 
+#define FS_WARN_PERCENT 90 //warn the user above this usage
+#define FS_MIN_CHECK_MS 60000 //fastest polling rate (for filesystems right below the warning level)
+
 class FSWatcher : public QObject
 {
 	Q_OBJECT
@@ -24,19 +28,33 @@ public:
   void start(int); //input in milliseconds
   void stop();
   
-  static QStringList getFSmountpoints();
+  static QStringList getFSmountpoints(); //reads the mount table and the current usage
   static QString doubleToDisplay(double);
   static int displayToDouble(QString); 
   
 private:
   QTimer *timer;
   QStringList oldBadDevs;
+  int maxMS; //slowest polling rate (user setting)
+  QString mountTab; //sorted kernel mount table at the last scan
+  QStringList mounts; //non-ZFS filesystems to watch: mountpoint::filesystem
+  QHash<QString, double> zfsTotal, zfsUsed; //pool -> size/used (K) from the last "zfs list"
+  QHash<QString, QString> zfsPath; //pool -> mountpoint of one of its datasets (for statfs)
   
   static QStringList runCMD(QString);
   static int calculatePercentage(double,double);
+  static QStringList listMounts();
+  static QStringList getUsage(QStringList);
+  static QString mountTable();
+  void readZfsPools();
+  QStringList zfsUsage();
+  void scanFS(bool rescan);
   
 public slots:
-  void checkFS(); //function in a timer loop
+  void checkFS(); //re-read the mount table and check the usage
+
+private slots:
+  void pollFS(); //timer - only re-reads the mount table if it changed
 
 signals:
   void FSWarning(QString, QString);
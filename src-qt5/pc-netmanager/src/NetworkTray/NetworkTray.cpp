@@ -5,20 +5,39 @@
 #include <QImage>
 #include <QMenu>
 #include <QProcess>
+#include <QSocketNotifier>
 #include <QToolTip>
 #include <QTextStream>
 #include <QTimer>
 #include <QTranslator>
 #include <iostream>
 
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <net/if_media.h>
+#include <net/route.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "NetworkTray.h"
 #include <pcbsd-netif.h>
 #include <pcbsd-utils.h>
 #include "../../../config.h"
 
 
-/* Update interval in ms */
+/* Update interval in ms (only used if the routing socket cannot be opened) */
 #define  UPDATE_MSEC 15000
+/* Delay used to merge a burst of routing messages into one refresh */
+#define  EVENT_MSEC 250
+/* Wifi signal sampling interval bounds in ms, and the change which resets it */
+#define  WIFI_MIN_MSEC 5000
+#define  WIFI_MAX_MSEC 60000
+#define  WIFI_SIGNAL_STEP 10
 
 // Public Variables
 QString DeviceName;
@@ -56,13 +75,18 @@ void NetworkTray::programInit(QString Device)
     usingLagg = false;
   
 
+  routeNotifier = 0;
+  trayIconMenu = 0;
+  wifiInterval = WIFI_MIN_MSEC;
+  linkEvent = false;
+
   // Get the username of the person we are running as
   username = QString::fromLocal8Bit(getenv("LOGNAME"));
   
   // Confirm this is a legit device
   confirmDevice(DeviceName); 
 
-  // Update the ifconfig line we will be parsing
+  // Update the ifconfig line we will be parsing (media / SSID text)
   slotUpdateIfStatus();
 
   // Get the MAC for this device
@@ -93,12 +117,114 @@ void NetworkTray::programInit(QString Device)
   //Display a message about the wireless status
   QTimer::singleShot(5000,this,SLOT(slotCheckWifiAvailability() ));
 
-  // Create the tooltip popup now
-  displayTooltip();
+  // Read the current state and create the tooltip popup now
+  monitorStatus();
+
+  // Wait for link / address changes from the kernel instead of polling ifconfig
+  eventTimer = new QTimer(this);
+  eventTimer->setSingleShot(true);
+  connect(eventTimer, SIGNAL(timeout()), this, SLOT(slotLinkChanged()) );
+  if ( ! openRouteSocket() ) {
+    qDebug() << "Could not open routing socket, polling" << DeviceName << "every" << UPDATE_MSEC << "ms";
+    linkEvent = true;
+    eventTimer->setSingleShot(false);
+    eventTimer->start(UPDATE_MSEC);
+  }
+
+  // Only the wifi signal strength / network list still needs sampling
+  wifiTimer = new QTimer(this);
+  wifiTimer->setSingleShot(true);
+  connect(wifiTimer, SIGNAL(timeout()), this, SLOT(slotSampleWifi()) );
+  scanner = WifiScanner::forDevice(DeviceName);
+  connect(scanner, SIGNAL(scanFinished(bool)), this, SLOT(slotScanFinished()) );
+  updateWifiNetworks();
+  if ( DeviceType == "Wireless" )
+    slotSampleWifi();
+
+}
 
-  // Start the monitor service on a refresh loop
+NetworkTray::~NetworkTray()
+{
+  if ( routeSock != -1 )
+    close(routeSock);
+}
+
+bool NetworkTray::openRouteSocket()
+{
+  routeSock = socket(PF_ROUTE, SOCK_RAW, 0);
+  if ( routeSock == -1 )
+    return false;
+  fcntl(routeSock, F_SETFL, fcntl(routeSock, F_GETFL) | O_NONBLOCK);
+  routeNotifier = new QSocketNotifier(routeSock, QSocketNotifier::Read, this);
+  connect(routeNotifier, SIGNAL(activated(int)), this, SLOT(slotRouteEvent()) );
+  return true;
+}
+
+// Drain the routing socket, and schedule a refresh if one of the messages is for our device
+void NetworkTray::slotRouteEvent()
+{
+  unsigned int devIndex = if_nametoindex(DeviceName.toLatin1());
+  unsigned int laggIndex = usingLagg ? if_nametoindex("lagg0") : 0;
+  char buf[2048];
+  ssize_t len;
+  bool changed = false;
+
+  while ( (len = read(routeSock, buf, sizeof(buf))) > 0 ) {
+    // Every message starts with the same length / version / type fields
+    struct rt_msghdr *rtm = (struct rt_msghdr *) buf;
+    if ( len < 4 || rtm->rtm_version != RTM_VERSION )
+      continue;
+
+    unsigned int index = 0;
+    bool link = false;
+    switch ( rtm->rtm_type ) {
+      case RTM_IFINFO:
+        if ( len >= (ssize_t) sizeof(struct if_msghdr) )
+          index = ((struct if_msghdr *) buf)->ifm_index;
+        link = true;
+        break;
+      case RTM_NEWADDR:
+      case RTM_DELADDR:
+        if ( len >= (ssize_t) sizeof(struct ifa_msghdr) )
+          index = ((struct ifa_msghdr *) buf)->ifam_index;
+        break;
+      case RTM_IFANNOUNCE:
+      case RTM_IEEE80211:
+        if ( len >= (ssize_t) sizeof(struct if_announcemsghdr) )
+          index = ((struct if_announcemsghdr *) buf)->ifan_index;
+        link = true;
+        break;
+      default:
+        continue;
+    }
+
+    if ( index == 0 || ( index != devIndex && index != laggIndex ) )
+      continue;
+    changed = true;
+    if ( link )
+      linkEvent = true;
+  }
+
+  if ( changed )
+    eventTimer->start(EVENT_MSEC);
+}
+
+void NetworkTray::slotLinkChanged()
+{
+  // The media / SSID text only changes with the link state, addresses are read directly
+  if ( linkEvent )
+    slotUpdateIfStatus();
+  if ( routeSock != -1 )
+    linkEvent = false;
+
+  QString oldStatus = DeviceStatus;
   monitorStatus();
 
+  // Sample the signal right away after an association change
+  if ( DeviceType == "Wireless" && oldStatus != DeviceStatus ) {
+    wifiInterval = WIFI_MIN_MSEC;
+    slotSampleWifi();
+  }
 }
 
 
@@ -146,36 +272,6 @@ QString NetworkTray::getNameForIdent( QString ident )
 }
 
 
-QString NetworkTray::getIpForIdent()
-{
-  QString inputLine = ifconfigOutput;
-  QString ip= "";
-  QString tDev;
-  if ( usingLagg ) {
-    tDev = "lagg0";
-    QString cmd = IFCONFIG + " " + tDev + " | grep " + DeviceName;
-    QString checkLagg = getLineFromCommandOutput(cmd.toLatin1());
-    if ( ! checkLagg.isEmpty() ) {
-      cmd = IFCONFIG + " " + tDev + " | grep 'inet ' ";
-      inputLine = getLineFromCommandOutput(cmd.toLatin1());
-    }
-
-    if (inputLine != "" && inputLine.indexOf("inet ") != -1){
-      ip = inputLine.remove(0, inputLine.indexOf("inet ") + 5);
-      ip.truncate(inputLine.indexOf(" "));
-    }
-    return ip;
-  }
-
-  if (inputLine != "" && inputLine.indexOf("inet ") != -1){
-    ip = inputLine.remove(0, inputLine.indexOf("inet ") + 5);
-    ip.truncate(inputLine.indexOf(" "));
-  }
-	
-  return ip;
-}
-
-
 QString NetworkTray::getMacForIdent( QString ident )
 {
   NetworkInterface ifr(ident);
@@ -195,88 +291,6 @@ QString NetworkTray::getSSIDForIdent()
   return SSID;
 }
 
-QString NetworkTray::getNetmaskForIdent()
-{
-  QString inputLine = ifconfigOutput;
-  QString netmask= "";
-	
-  if (inputLine != "" && inputLine.indexOf("netmask ") != -1){
-    netmask = inputLine.remove(0, inputLine.indexOf("netmask ") + 8);
-    netmask.truncate(netmask.indexOf(" "));
-  }
-	
-  return netmask;
-}
-
-QString NetworkTray::getSignalStrengthForIdent( QString ident )
-{
-  // Get the signal strength of this device
-  QString command = IFCONFIG + " " + ident + " list scan | grep " + DeviceSSID;
-  QString line = getLineFromCommandOutput(command);
-  QString tmp, sig, noise;
-  bool ok, ok2;
-  int isig, inoise, percent;
-	
-  tmp = line.simplified();
-
-  // Lets find the signal strength / noise variables now
-  tmp.remove(0, tmp.indexOf(":"));
-  tmp.remove(0, tmp.indexOf(" "));
-
-  // Get the noise
-  noise = tmp.simplified();
-  noise.remove(0, noise.lastIndexOf(":") + 1);
-  noise.remove(noise.indexOf(" "), noise.size());
-  noise = noise.simplified();
-  if ( noise.indexOf("-") == 0)
-	noise.remove(0, 1);
-
-  // Get the signal
-  sig = tmp.simplified();
-  sig.remove(sig.indexOf(":"), sig.size());
-  sig.remove(0, sig.lastIndexOf(" "));
-  sig = sig.simplified();
-  if ( sig.indexOf("-") == 0)
-	sig.remove(0, 1);
-
-  //qDebug() << "Signal:" << sig << " Noise:" << noise;
-
-  // Now figure out the percentage
-  isig = sig.toInt(&ok);
-  inoise = noise.toInt(&ok2);
-  if ( ok && ok2 ) {
-     percent = (inoise - isig) * 4;
-     // Sanity check
-     if ( percent > 100 )
-	percent = 100;
-     if ( percent < 0 )
-	percent = 0;
-     tmp.setNum(percent);
-  } else {
-     tmp = "";
-  }
-
-  return tmp;	
-}
-
-QString NetworkTray::getWirelessSpeedForIdent( QString ident )
-{
-  QString command = IFCONFIG + " " + ident + " list scan | grep " + DeviceSSID;
-  QString line = getLineFromCommandOutput(command);
-  QString tmp;
-
-  // Get the signal strength of this device
-  tmp = line;
-  tmp = tmp.simplified();
-
-  // First remove the SSID which may have spaces in it
-  tmp.remove(0, tmp.indexOf(":"));
-
-  // Now find the Speed section
-  tmp = tmp.section(" ", 2, 2);
-  return tmp;
-}
-
 void NetworkTray::slotTrayActivated(QSystemTrayIcon::ActivationReason reason) {
    if(reason == QSystemTrayIcon::Trigger) {
       //openNetManager();
@@ -368,38 +382,91 @@ void NetworkTray::slotQuit() {
 void NetworkTray::slotTriggerFileChanged() {
 }
 
-void NetworkTray::monitorStatus(bool noloop) {
-  // Start checking to see if the device has changed, and if it has inform the user
-  QString tmp;  
-  QIcon Icon;
-  QString NotifyText = "";
+void NetworkTray::monitorStatus() {
+  // Check to see if the device has changed, and update the tray to match
+  readInterfaceState();
 
   // Check the media status of this device
   DeviceMedia = getMediaForIdent();
 
-  // Check for IPv6 Changes
-  DeviceIPv6 = getIPv6ForIdent();
-
-  // Get the device up status
-  DeviceUpStatus = getUpStatusForIdent();
+  // Now check the SSID for changes
+  if ( DeviceType == "Wireless" && DeviceStatus == "associated" )
+    DeviceSSID = getSSIDForIdent();
 
+  updateTrayIcon();
+}
 
-  if ( DeviceType == "Ethernet" )
-  {
-    if ( (DeviceStatus == "active" || DeviceStatus == "")  && tmp == "UP")
-      Icon = iconWiredConnect;
-    else
-      Icon = iconWiredDisconnect;
-  } else {
-    if ( DeviceStatus == "associated" && tmp == "UP" )
-      Icon = iconWifiConnect;
-    else
-      Icon = iconWifiDisconnect;
+// Read the flags, addresses and link state of the device straight from the kernel
+void NetworkTray::readInterfaceState()
+{
+  QString ipDev = DeviceName;
+  if ( usingLagg )
+    ipDev = "lagg0";
+
+  DeviceUpStatus = "DOWN";
+  DeviceIP = "";
+  DeviceNetmask = "";
+  DeviceIPv6 = "";
+  QString linkLocal;
+
+  struct ifaddrs *ifap;
+  if ( getifaddrs(&ifap) == 0 ) {
+    for ( struct ifaddrs *ifa = ifap; ifa != NULL; ifa = ifa->ifa_next ) {
+      if ( ifa->ifa_addr == NULL )
+        continue;
+      QString name = QString::fromLocal8Bit(ifa->ifa_name);
+      if ( name == DeviceName && (ifa->ifa_flags & IFF_UP) )
+        DeviceUpStatus = "UP";
+      if ( name != ipDev )
+        continue;
+
+      if ( ifa->ifa_addr->sa_family == AF_INET && DeviceIP.isEmpty() ) {
+        DeviceIP = inet_ntoa(((struct sockaddr_in *) ifa->ifa_addr)->sin_addr);
+        if ( ifa->ifa_netmask != NULL )
+          DeviceNetmask = inet_ntoa(((struct sockaddr_in *) ifa->ifa_netmask)->sin_addr);
+      } else if ( ifa->ifa_addr->sa_family == AF_INET6 ) {
+        struct in6_addr addr = ((struct sockaddr_in6 *) ifa->ifa_addr)->sin6_addr;
+        bool local = IN6_IS_ADDR_LINKLOCAL(&addr);
+        // Link-local addresses carry the scope id inside the address, drop it
+        if ( local ) {
+          addr.s6_addr[2] = 0;
+          addr.s6_addr[3] = 0;
+        }
+        char buf[INET6_ADDRSTRLEN];
+        if ( inet_ntop(AF_INET6, &addr, buf, sizeof(buf)) == NULL )
+          continue;
+        if ( local && linkLocal.isEmpty() )
+          linkLocal = buf;
+        else if ( ! local && DeviceIPv6.isEmpty() )
+          DeviceIPv6 = buf;
+      }
+    }
+    freeifaddrs(ifap);
+  }
+  if ( DeviceIPv6.isEmpty() )
+    DeviceIPv6 = linkLocal;
+
+  // Get the link status of the device
+  DeviceStatus = "DOWN";
+  struct ifmediareq ifm;
+  memset(&ifm, 0, sizeof(struct ifmediareq));
+  strncpy(ifm.ifm_name, DeviceName.toLocal8Bit(), IFNAMSIZ);
+  int s = socket(AF_INET, SOCK_DGRAM, 0);
+  if ( s != -1 ) {
+    if ( ioctl(s, SIOCGIFMEDIA, &ifm) == 0 && (ifm.ifm_status & IFM_AVALID) && (ifm.ifm_status & IFM_ACTIVE) ) {
+      if ( IFM_TYPE(ifm.ifm_active) == IFM_IEEE80211 )
+        DeviceStatus = "associated";
+      else
+        DeviceStatus = "active";
+    }
+    close(s);
   }
+}
 
+void NetworkTray::updateTrayIcon()
+{
+  QIcon Icon;
 
-  // First check the status of the device
-  DeviceStatus = getStatusForIdent();
   if ( DeviceType == "Ethernet" )
   {
     if ( (DeviceStatus == "active" || DeviceStatus == "")  && DeviceUpStatus == "UP")
@@ -414,62 +481,69 @@ void NetworkTray::monitorStatus(bool noloop) {
       Icon = iconWifiDisconnect;
   }
 
-  // Now check the IP Address for changes
-  DeviceIP = getIpForIdent();
-  DeviceNetmask = getNetmaskForIdent();
-
-  if ( DeviceType == "Wireless" && DeviceStatus == "associated" )
+  if ( DeviceType == "Wireless" && DeviceStatus == "associated" && ! DeviceSSID.isEmpty() )
   {
-    // Now check the SSID Address for changes
-    DeviceSSID = getSSIDForIdent();
-
-    if (! DeviceSSID.isEmpty() )
-    {
-       int newStrength = 0;
-       int iconStrength = 0;
-       QString FileLoad;
-       bool ok;
-       // Get the strength of the signal
-       tmp = getSignalStrengthForIdent( DeviceName );
-       DeviceSignalStrength = tmp;
-       // Figure out if we need to change the strength icon
-       tmp.toInt(&ok);
-       if ( ok ) {
-         newStrength = tmp.toInt(&ok);
-	 if ( newStrength < 5 )
-         {	
-	   iconStrength = 0;
-           Icon = iconWifiConnect;
-         } else if ( newStrength < 50 ) {
-	   iconStrength = 30;
-           Icon = iconWifiConnect30;
-	 } else if ( newStrength < 75 ) {
-	   iconStrength = 60;
-           Icon = iconWifiConnect60;
-         } else {
-	   iconStrength = 85;
-           Icon = iconWifiConnect85;
-	 }
-       } else {
-	  DeviceSignalStrength = tr("Unknown");
-       }
-       // Get the connection speed being used
-       DeviceWirelessSpeed = getWirelessSpeedForIdent( DeviceName );
-     }
-
+    // Figure out if we need to change the strength icon
+    bool ok;
+    int newStrength = DeviceSignalStrength.toInt(&ok);
+    if ( ok ) {
+      if ( newStrength < 5 )
+        Icon = iconWifiConnect;
+      else if ( newStrength < 50 )
+        Icon = iconWifiConnect30;
+      else if ( newStrength < 75 )
+        Icon = iconWifiConnect60;
+      else
+        Icon = iconWifiConnect85;
+    }
   }
 
   // Set the tray icon now
   trayIcon->setIcon(Icon);
 
-
   displayTooltip();
-  updateWifiNetworks();
-  
-  if(!noloop){
-    QTimer::singleShot(UPDATE_MSEC,  this,  SLOT(monitorStatus()));
+}
+
+// Sample the signal strength and the list of networks with one background scan
+void NetworkTray::slotSampleWifi()
+{
+  // Sample again later even if this scan never reports back (slotScanFinished() sets the real interval)
+  wifiTimer->start(WIFI_MAX_MSEC);
+  scanner->scan();
+}
+
+// A scan finished, pick up the signal for our network and sample again later (more often while it is moving)
+void NetworkTray::slotScanFinished()
+{
+  bool ok = false;
+  int newStrength = 0;
+  if ( DeviceStatus == "associated" && ! DeviceSSID.isEmpty() )
+  {
+    WifiAccessPoint ap;
+    ok = scanner->accessPoint(DeviceSSID, &ap);
+    if ( ok ) {
+      newStrength = ap.strength;
+      DeviceSignalStrength = QString::number(newStrength);
+      // Get the connection speed being used
+      DeviceWirelessSpeed = ap.rate;
+    } else {
+      DeviceSignalStrength = tr("Unknown");
+      DeviceWirelessSpeed = "";
+    }
   }
 
+  if ( DeviceStatus != "associated" )
+    wifiInterval = WIFI_MAX_MSEC;
+  else if ( ! ok || qAbs(newStrength - DeviceSavedStrength) >= WIFI_SIGNAL_STEP )
+    wifiInterval = WIFI_MIN_MSEC;
+  else
+    wifiInterval = qMin(wifiInterval * 2, WIFI_MAX_MSEC);
+  DeviceSavedStrength = newStrength;
+
+  updateTrayIcon();
+  updateWifiNetworks();
+
+  wifiTimer->start(wifiInterval);
 }
 
 // If the user wants to restart the network, do so
@@ -506,36 +580,6 @@ QString NetworkTray::getTypeForIdent( QString ident )
    return "Ethernet";
 }
 
-QString NetworkTray::getStatusForIdent()
-{
-  QString inputLine = ifconfigOutput;
-  QString status = "";
-	
-  if (inputLine != "" && inputLine.indexOf("associated") != -1)
-    status = "associated";
-  else if (inputLine != "" && inputLine.indexOf("active") != -1)
-    status = "active";
-  else
-    status = "DOWN";  
-	
-  return status;
-    
-}
-
-QString NetworkTray::getUpStatusForIdent()
-{
-  QString inputLine = ifconfigOutput;
-  QString status = "";
-	
-  if (inputLine != "" && inputLine.indexOf("<UP") != -1)
-    status = "UP";
-  else
-    status = "DOWN";  
-	
-  return status;
-    
-}
-
 QString NetworkTray::getMediaForIdent()
 {
   QString inputLine = ifconfigOutput;
@@ -549,19 +593,6 @@ QString NetworkTray::getMediaForIdent()
   return status;
 }
 
-QString NetworkTray::getIPv6ForIdent()
-{
-  QString inputLine = ifconfigOutput;
-  QString ip= "";
-	
-  if (inputLine != "" && inputLine.indexOf("inet6 ") != -1){
-    ip = inputLine.remove(0, inputLine.indexOf("inet6 ") + 5);
-    ip.truncate(ip.indexOf("%"));
-  }
-	
-  return ip;
-}
-
 void NetworkTray::slotUpdateIfStatus()
 {
    QProcess *getIfProc = new QProcess();
@@ -578,14 +609,10 @@ void NetworkTray::slotUpdateIfStatus()
 
    getIfProc->kill();
    delete getIfProc;
-
-   QTimer::singleShot(UPDATE_MSEC, this,  SLOT(slotUpdateIfStatus()) );
 }
 
 void NetworkTray::slotCheckWifiAvailability(){
   if(DeviceType == "Wireless"){
-    // Get the device up status
-    DeviceStatus = getStatusForIdent();
     //Show a message if the wifi is down
     if(DeviceStatus == "DOWN"){
       trayIcon->showMessage( tr("No Wireless Network Connection"),tr("Click here to configure wireless connections"),QSystemTrayIcon::NoIcon,15000);
@@ -595,68 +622,40 @@ void NetworkTray::slotCheckWifiAvailability(){
 
 void NetworkTray::updateWifiNetworks(){
   // Change the right-click of the tray icon to show all available wireless networks
-  
-  //update the list of wifi networks available
-  QString cmd = "ifconfig "+DeviceName+" list scan";
-  QStringList wifinet = pcbsd::Utils::runShellCommand(cmd);
+  // (from the last scan, only the strongest access point of each SSID)
+  QList<WifiAccessPoint> wifinet = scanner->accessPoints(true);
  
  //Redo the tray menu
+  if ( trayIconMenu != 0 )
+    trayIconMenu->deleteLater();
   trayIconMenu = new QMenu(this);
-  trayActionGroup = new QActionGroup(this);
+  trayActionGroup = new QActionGroup(trayIconMenu);
   trayIconMenu->clear();
   //QAction *act = trayIconMenu->addAction( tr("Wifi Quick-Connect") );
   //act->setEnabled(false);
   trayIconMenu->addSeparator();
   QIcon ssidIcon;
  //add an entry for each wifi network detected
-  for(int i=1; i<wifinet.length(); i++){ //skip the first line (labels)
-    //Get the ssid and Security for this network
-    QStringList wdata = NetworkInterface::parseWifiScanLine(wifinet[i],false);
-    QString ssid = wdata[0];
-    QString strength = wdata[4];
+  for(int i=0; i<wifinet.length(); i++){
+    QString ssid = wifinet[i].ssid;
+    //Make sure there is an ssid (don't show blank entry points)
+    if( ssid.isEmpty() ){ continue; }
     //Add this network to the list
-    QString entry = ssid+" ("+strength+")"; // SSID (%Strength)
+    QString entry = ssid+" ("+QString::number(wifinet[i].strength)+"%)"; // SSID (%Strength)
     //Get the proper "locked" or "unlocked" icon for the network
-    if(wdata[6].contains("None")){
+    if(wifinet[i].security.contains("None")){
       ssidIcon = iconUnlocked;
     }else{
       ssidIcon = iconLocked;
     }
-    //Make sure there is an ssid (don't show blank entry points)
-    if( !ssid.isEmpty() ){
-
-    //Check for duplicate SSID entries
-    bool duplicateSSID = false;
-    int dupRow;
-    for ( int z = 0 ; z < trayIconMenu->actions().count() ; z++){
-      //qDebug() << listWifi->item(z)->text() << ssid;
-      if ( trayIconMenu->actions()[z]->text().contains(ssid+" (") ){
-        duplicateSSID = true;
-        dupRow = z;
-        break;
-      }
-    }
-    if(!duplicateSSID){
-      //Create the action
-      QAction* tempAct = new QAction(entry, this); //set the label for the action on creation
-      tempAct->setObjectName(wdata[0]); //set the action name as the SSID
-      tempAct->setIcon(ssidIcon); //set the action icon
-      //add the action to the action group
-      trayActionGroup->addAction(tempAct); 
-      //Add the action to the menu
-      trayIconMenu->addAction(tempAct);
-    }else{
-      //Check if the new signal strength is greater, replace if it is
-      QString oldStrength = trayIconMenu->actions()[dupRow]->text();
-      oldStrength = oldStrength.section("(",1,1).section("%)",0,0).simplified();
-      if( strength.section("%",0,0).toInt() > oldStrength.toInt() ){
-        //New signal strength is greater - replace the string
-        //qDebug() << "Changing signal strength for "+ssid+" to reflect a stronger signal found";
-        //qDebug() << strength << oldStrength;
-        trayIconMenu->actions()[dupRow]->setText( ssid+" ("+strength+")" );
-      }
-    }
-    } //end of the empty ssid check
+    //Create the action
+    QAction* tempAct = new QAction(entry, trayIconMenu); //set the label for the action on creation
+    tempAct->setObjectName(ssid); //set the action name as the SSID
+    tempAct->setIcon(ssidIcon); //set the action icon
+    //add the action to the action group
+    trayActionGroup->addAction(tempAct); 
+    //Add the action to the menu
+    trayIconMenu->addAction(tempAct);
   }
   //Connect the actionGroup signal with slotQuickConnect
   QObject::connect(trayActionGroup, SIGNAL(triggered(QAction*)),this,SLOT(slotGetNetKey(QAction*)));
@@ -673,18 +672,11 @@ void NetworkTray::updateWifiNetworks(){
 }
 
 void NetworkTray::slotGetNetKey(QAction* act){
-  //Get the small SSID from the action 
-  QString smSSID = act->objectName();
-  //trim the small ssid to remove any dots at the end
-  smSSID = smSSID.section(".",0,0,QString::SectionSkipEmpty);
-  
-  //get the full SSID string
-  QString dat = pcbsd::Utils::runShellCommandSearch("ifconfig -v "+DeviceName+" list scan",smSSID);
-  QStringList wdat = NetworkInterface::parseWifiScanLine(dat,true);
-  QString SSID = wdat[0];
-  
-  //Get the Security Type
-  QString sectype = wdat[6];
+  //Get the SSID from the action, and the security type from the last scan
+  QString SSID = act->objectName();
+  WifiAccessPoint ap;
+  scanner->accessPoint(SSID, &ap);
+  QString sectype = ap.security;
   
   if(sectype == "None"){
     //run the Quick-Connect slot without a key
@@ -5,7 +5,10 @@
 #include <QFileSystemWatcher>
 #include <QSystemTrayIcon>
 #include <QMenu>
+#include <QSocketNotifier>
+#include <QTimer>
 
+#include <pcbsd-wifiscan.h>
 #include "netKey.h"
 
 #define PROGPATH QString("/usr/local/share/pcbsd/pc-netmanager")
@@ -20,17 +23,17 @@ class NetworkTray : public QDialog {
 public:
    NetworkTray() : QDialog()
    {
-
+      routeSock = -1;
    }
    void programInit(QString);
    
-   virtual ~NetworkTray() {};
+   virtual ~NetworkTray();
    
 private slots:
    void openNetManager();
    void openDeviceInfo();
    void openConfigDlg();
-   void monitorStatus(bool noloop=false);
+   void monitorStatus();
    void slotRestartNetwork();
    void slotTrayActivated(QSystemTrayIcon::ActivationReason);
    void slotQuit();
@@ -39,30 +42,36 @@ private slots:
    void slotQuickConnect(QString key, QString SSID, bool hexkey);
    void slotCheckWifiAvailability();
    void slotUpdateIfStatus();
+   void slotRouteEvent();
+   void slotLinkChanged();
+   void slotSampleWifi();
+   void slotScanFinished();
    
 private:
    void displayTooltip();
+   void updateTrayIcon();
+   bool openRouteSocket();
+   void readInterfaceState();
    void confirmDevice( QString device );
    void loadIcons();
    void updateWifiNetworks();   
    QFileSystemWatcher *fileWatcherClosed;
    QString getLineFromCommandOutput( QString command );
    QString getNameForIdent( QString ident );
-   QString getIpForIdent();
    QString getMacForIdent( QString ident );
    QString getSSIDForIdent();
-   QString getNetmaskForIdent();
-   QString getSignalStrengthForIdent( QString ident );
-   QString getWirelessSpeedForIdent( QString ident );
-   QString getUpStatusForIdent();
-   QString getStatusForIdent();
    QString getMediaForIdent();
-   QString getIPv6ForIdent();
    QString getWifiParent( QString dev );
    QString getTypeForIdent( QString ident );
    QString ifconfigOutput;
    QProcess *runCommandProc;
-   QProcess *getIfProc;
+   int routeSock;
+   QSocketNotifier *routeNotifier;
+   QTimer *eventTimer;
+   QTimer *wifiTimer;
+   WifiScanner *scanner;
+   int wifiInterval;
+   bool linkEvent;
    QIcon iconWiredConnect;
    QIcon iconWiredDisconnect;
    QIcon iconWifiConnect;
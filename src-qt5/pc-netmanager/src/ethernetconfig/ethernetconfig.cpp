@@ -274,11 +274,13 @@ void ethernetconfig::loadInfo()
   tmp.truncate(20);
   textMedia->setText(tmp);
 
-  // Get the packet status for this device
-  textPacketsIn->setText(getInPacketsForIdent( DeviceName) );
-  textPacketsInErrors->setText( getInErrorsForIdent( DeviceName) );
-  textPacketsOut->setText(getOutPacketsForIdent( DeviceName) );
-  textPacketsOutErrors->setText(getOutErrorsForIdent( DeviceName) );
+  // Get the packet status for this device (one sysctl for all the counters)
+  ifStats.update();
+  NetworkInterfaceStats st = ifStats.stats(DeviceName);
+  textPacketsIn->setText(QString::number(st.packetsRx) );
+  textPacketsInErrors->setText(QString::number(st.errorsRx) );
+  textPacketsOut->setText(QString::number(st.packetsTx) );
+  textPacketsOutErrors->setText(QString::number(st.errorsTx) );
 
   // Connect the slot to refresh
   QTimer::singleShot(3000,  this,  SLOT(loadInfo()));
@@ -308,30 +310,6 @@ QString ethernetconfig::getStatusForIdent( QString ident )
    return ifr.mediaStatusAsString();
 }
 
-QString ethernetconfig::getInPacketsForIdent(QString ident)
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.packetsRx());
-}
-
-QString ethernetconfig::getInErrorsForIdent(QString ident)
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.errorsRx());
-}
-
-QString ethernetconfig::getOutPacketsForIdent(QString ident)
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.packetsTx());
-}
-
-QString ethernetconfig::getOutErrorsForIdent(QString ident)
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.errorsTx());
-}
-
 QString ethernetconfig::getNetmaskForIdent( QString ident )
 {
    NetworkInterface ifr(ident);
@@ -23,6 +23,7 @@
  ***************************************************************************/
 #include <qdialog.h>
 #include <qwidget.h>
+#include <pcbsd-netif.h>
 #include "ui_ethernetconfig.h"
 
 #ifndef _ETHERNETCONFIG_H_
@@ -56,10 +57,6 @@ public slots:
 private:
     void runCommand( QString command );
     QString getNetmaskForIdent( QString ident );
-    QString getOutErrorsForIdent(QString ident);
-    QString getOutPacketsForIdent(QString ident);
-    QString getInErrorsForIdent(QString ident);
-    QString getInPacketsForIdent(QString ident);
     QString getStatusForIdent( QString ident );
     QString getMacForIdent( QString ident );
     QString getIpForIdent( QString ident );
@@ -72,6 +69,7 @@ private:
     void saveLaggLine(QString dev, QString config);
     void setupEthLagg(QString dev);
     bool useLagg;
+    NetworkStatistics ifStats;
 
 private slots:
     void loadInfo();
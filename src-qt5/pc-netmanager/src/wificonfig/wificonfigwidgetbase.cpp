@@ -292,6 +292,10 @@ void wificonfigwidgetbase::setDevice( QString Device )
   // Save the device name for later
   DeviceName = Device;
 
+  // Scan in the background, the list is refreshed whenever a scan finishes
+  scanner = WifiScanner::forDevice(DeviceName);
+  connect( scanner, SIGNAL( scanFinished(bool) ), this, SLOT( slotScanFinished() ) );
+
   // Center the dialog window
   QDesktopWidget *d = QApplication::desktop();
   move(d->width() / 3, d->height() / 4);
@@ -350,66 +354,46 @@ void wificonfigwidgetbase::loadCountryCodes()
 
 void wificonfigwidgetbase::slotRescan()
 {
-    QString strength, ssid, security, FileLoad;
-    QStringList ifconfout, ifline;    
+    // Show the cached networks right away, the list is updated when the scan finishes
+    slotScanFinished();
+    scanner->scan(true);
+}
+
+void wificonfigwidgetbase::slotScanFinished()
+{
+    QString FileLoad;
     int foundItem = 0;
 
+    // Keep the selected network selected across refreshes
+    QString selected;
+    if ( listNewWifi->currentItem() != 0 )
+      selected = listNewWifi->currentItem()->text().section(" (signal:", 0, 0);
+
     // Clear the list box and disable the add button
     listNewWifi->clear();
     pushAddWifi->setEnabled(false);
-            
-    // Start the scan and get the output
-    ifconfout = pcbsd::Utils::runShellCommand("ifconfig -v " + DeviceName + " up list scan");
-
-    //display the info for each wifi access point
-    for(int i=1; i<ifconfout.size(); i++){    //Skip the header line by starting at 1
-      ifline = NetworkInterface::parseWifiScanLine(ifconfout[i],true); //get a single line
-      //save the info for this wifi
-      //qDebug() << "ifconfig run";
-      ssid = ifline[0];
-      strength = ifline[4];
+
+    //display the info for each wifi access point (only the strongest for each SSID)
+    QList<WifiAccessPoint> aps = scanner->accessPoints(true);
+    for(int i=0; i<aps.size(); i++){
+      //Make sure we do not display blank ssid entry points
+      if( aps[i].ssid.isEmpty() ){ continue; }
       //determine the icon based on if there is security encryption
-      security = ifline[6]; //NetworkInterface::getWifiSecurity(ssid,DeviceName);
-      if(security.contains("None")){
+      if(aps[i].security.contains("None")){
 	FileLoad = ":object-unlocked.png";
       }else{
 	FileLoad = ":object-locked.png";
       }
-      //qDebug() << "ssid check";
-      //Make sure we do not display blank ssid entry points
-      if( !ssid.isEmpty() ){
-
-      // qDebug()<<"Checking for duplicate SSID's";
-      bool duplicateSSID = false;
-      int dupRow;
-      for ( int z = 0 ; z < listNewWifi->count() ; z++){
-        //qDebug() << listNewWifi->item(z)->text() << ssid;
-	if ( listNewWifi->item(z)->text().contains(ssid+" (") ){
-          dupRow = z;
-          duplicateSSID = true;
-          break;
-	}
-      }
-      if( !duplicateSSID ){
-        //Add the wifi access point to the list
-        listNewWifi->addItem(new QListWidgetItem(QIcon(FileLoad), ssid + " (signal: " +strength + ")") );
-        foundItem = 1; //set the flag for wifi signals found 
-      }else{
-        //Check if the new signal strength is greater, replace if it is
-        QString oldStrength = listNewWifi->item(dupRow)->text();
-        oldStrength = oldStrength.section("(signal:",1,1).section("%)",0,0).simplified();
-        if( strength.section("%",0,0).toInt() > oldStrength.toInt() ){
-          //New signal strength is greater - replace the string
-          qDebug() << "Changing signal strength for "+ssid+" to reflect a stronger signal found";
-          //qDebug() << strength << oldStrength;
-          listNewWifi->item(dupRow)->setText( ssid+" (signal: "+strength+")" );
-	}
-      }
-      } //End of check for empty SSID entry points 
+      //Add the wifi access point to the list
+      listNewWifi->addItem(new QListWidgetItem(QIcon(FileLoad), aps[i].ssid + " (signal: " + QString::number(aps[i].strength) + "%)") );
+      if ( aps[i].ssid == selected )
+        listNewWifi->setCurrentRow(listNewWifi->count() - 1);
+      foundItem = 1; //set the flag for wifi signals found 
     }
     
     if ( foundItem == 1 ){
-      listNewWifi->setCurrentRow(-1);
+      if ( selected.isEmpty() )
+        listNewWifi->setCurrentRow(-1);
       pushAddWifi->setEnabled(true);
     } else {
       pushAddWifi->setEnabled(false);
@@ -719,8 +703,13 @@ void wificonfigwidgetbase::slotAddNewProfileSSID(QString ssidc){
   /*  ssidc - SSID of the network to add
   */
 
-    //Get the Security Type
-    QString sec = NetworkInterface::getWifiSecurity(ssidc,DeviceName);
+    //Get the Security Type (from the last scan if it saw this network)
+    QString sec;
+    WifiAccessPoint ap;
+    if ( scanner->accessPoint(ssidc, &ap) )
+      sec = ap.security;
+    else
+      sec = NetworkInterface::getWifiSecurity(ssidc,DeviceName);
 
     //Save the SSID for the future save slots
     saveSSID = ssidc;
@@ -1010,34 +999,6 @@ QString wificonfigwidgetbase::getNetmaskForIdent( QString ident )
 }
 
 
-QString wificonfigwidgetbase::getOutErrorsForIdent( QString ident )
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.errorsRx());
-}
-
-
-QString wificonfigwidgetbase::getOutPacketsForIdent( QString ident )
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.packetsRx());
-}
-
-
-QString wificonfigwidgetbase::getInErrorsForIdent( QString ident )
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.errorsTx());
-}
-
-
-QString wificonfigwidgetbase::getInPacketsForIdent( QString ident )
-{
-   NetworkInterface ifr(ident);
-   return QString::number(ifr.packetsTx());
-}
-
-
 QString wificonfigwidgetbase::getStatusForIdent( QString ident )
 {
    NetworkInterface ifr(ident);
@@ -1109,11 +1070,13 @@ void wificonfigwidgetbase::loadInfo()
   tmp.truncate(20);
   textMedia->setText(tmp);
   
-  // Get the packet status for this device
-  textPacketsIn->setText(getInPacketsForIdent( DeviceName) );
-  textPacketsInErrors->setText( getInErrorsForIdent( DeviceName) );
-  textPacketsOut->setText(getOutPacketsForIdent( DeviceName) );
-  textPacketsOutErrors->setText(getOutErrorsForIdent( DeviceName) );
+  // Get the packet status for this device (one sysctl for all the counters)
+  ifStats.update();
+  NetworkInterfaceStats st = ifStats.stats(DeviceName);
+  textPacketsIn->setText(QString::number(st.packetsRx) );
+  textPacketsInErrors->setText(QString::number(st.errorsRx) );
+  textPacketsOut->setText(QString::number(st.packetsTx) );
+  textPacketsOutErrors->setText(QString::number(st.errorsTx) );
 
   // Connect the slot to refresh
   QTimer::singleShot(3000,  this,  SLOT(loadInfo() ) );
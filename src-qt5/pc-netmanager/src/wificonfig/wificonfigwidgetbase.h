@@ -8,6 +8,7 @@
 #include <pcbsd-netif.h>
 #include <pcbsd-utils.h>
 #include <pcbsd-ui.h>
+#include <pcbsd-wifiscan.h>
 #include "wifiselectiondialog.h"
 #include "wepconfig.h"
 #include "dialogwpapersonal.h"
@@ -76,16 +77,13 @@ private slots:
     void slotMoveUp();
     void slotMoveDown();
     void slotRescan();
+    void slotScanFinished();
     void slotWEPSave(QString newkey, int newIndex, bool hexkey );
     void slotWPAPSave(QString newkey);
 
 private:
     QString getLineFromCommandOutput( QString command );
     QString getNetmaskForIdent( QString ident );
-    QString getOutErrorsForIdent( QString ident );
-    QString getOutPacketsForIdent( QString ident );
-    QString getInErrorsForIdent( QString ident );
-    QString getInPacketsForIdent( QString ident );
     QString getStatusForIdent( QString ident );
     QString getMacForIdent( QString ident );
     QString getIpForIdent( QString ident );
@@ -99,6 +97,7 @@ private:
     void updateWPASupp();
     QString DeviceName;
     QString Country;
+    WifiScanner *scanner;
     
     dialogWPAPersonal *dialogWPA;
     wepConfig *dialogWEP;
@@ -124,6 +123,7 @@ private:
     int WPAEType[150];
     bool usingLagg;
     bool WPAONLY;
+    NetworkStatistics ifStats;
 
 signals:
 
@@ -11,6 +11,10 @@ void wifiscanssid::init(QString device)
 {
    DeviceName = device;
    pushSelect->setEnabled(false);
+
+   // The scanner is shared with the rest of the program, so it may already have results
+   scanner = WifiScanner::forDevice(DeviceName);
+   connect( scanner, SIGNAL( scanFinished(bool) ), this, SLOT(slotScanFinished()) );
     
    QTimer::singleShot(500,  this,  SLOT(slotRescan()));
 
@@ -21,56 +25,40 @@ void wifiscanssid::init(QString device)
    
 void wifiscanssid::scanWifi()
 {
-    QString strength, ssid, tmp, FileLoad;
-    QStringList ifconfout, ifline;    
+    // Show what we already know, and update once the new scan is done
+    fillList();
+    textTop->setText(tr("Scanning for wireless networks...") );
+    scanner->scan(true);
+}
+
+void wifiscanssid::fillList()
+{
+    QString FileLoad;
     int newStrength;
     int foundItem = 0;
 
     // Clear the list box
     listWifi->clear();
-    textTop->setText(tr("Scanning for wireless networks...") );
-            
-    // Start the scan and get the output
-    ifconfout = pcbsd::Utils::runShellCommand("ifconfig -v " + DeviceName + " up list scan");
-
-    //display the info for each wifi access point
-    for(int i=1; i<ifconfout.size(); i++){    //Skip the header line by starting at 1
-      ifline = NetworkInterface::parseWifiScanLine(ifconfout[i],true); //get a single line
-      //save the info for this wifi
-      ssid = ifline[0];
-      strength = ifline[4];
-      //determine the icon based on the signal strength
-      tmp = strength.section("%",0,0,QString::SectionSkipEmpty); //remove the % from the end
-      newStrength = tmp.toInt(); //integer strength value 
-      bool duplicateSSID = false;
-      for ( int z = 0 ; z < listWifi->count() ; z++){
-        qDebug() << listWifi->item(z)->text() << ssid;
-	if ( listWifi->item(z)->text().contains(ssid+" (") ){
-          duplicateSSID = true;
-          break;
-	}
-      }
 
-      if( !duplicateSSID ){
-        if ( newStrength < 25 ){	
-	  FileLoad= PROGPATH + "/pics/tray_wifi.png";
-        } else if ( newStrength < 50 ) {
-	  FileLoad= PROGPATH + "/pics/tray_wifi30.png";
-        }  else if ( newStrength < 75 ) {
-	  FileLoad= PROGPATH + "/pics/tray_wifi60.png";
-        } else {
-  	  FileLoad= PROGPATH + "/pics/tray_wifi85.png";
-        }
-        QImage *Icon = new QImage(FileLoad);
-        QPixmap PixmapIcon;
-        PixmapIcon.fromImage(Icon->scaled(22,22));
-        //Add the wifi access point to the list
-        listWifi->addItem(new QListWidgetItem(PixmapIcon, ssid + " (signal strength: " +strength + ")") );
-        foundItem = 1; //set the flag for wifi signals found 
-      }else{
-        //if the new signal is stronger, change the current label to reflect it
-
-      } 
+    //display the info for each wifi access point (only the strongest for each SSID)
+    QList<WifiAccessPoint> aps = scanner->accessPoints(true);
+    for(int i=0; i<aps.size(); i++){
+      newStrength = aps[i].strength;
+      if ( newStrength < 25 ){	
+        FileLoad= PROGPATH + "/pics/tray_wifi.png";
+      } else if ( newStrength < 50 ) {
+        FileLoad= PROGPATH + "/pics/tray_wifi30.png";
+      }  else if ( newStrength < 75 ) {
+        FileLoad= PROGPATH + "/pics/tray_wifi60.png";
+      } else {
+        FileLoad= PROGPATH + "/pics/tray_wifi85.png";
+      }
+      QImage *Icon = new QImage(FileLoad);
+      QPixmap PixmapIcon;
+      PixmapIcon.fromImage(Icon->scaled(22,22));
+      //Add the wifi access point to the list
+      listWifi->addItem(new QListWidgetItem(PixmapIcon, aps[i].ssid + " (signal strength: " + QString::number(newStrength) + "%)") );
+      foundItem = 1; //set the flag for wifi signals found 
     }
     
     if ( foundItem == 1 ){
@@ -84,6 +72,21 @@ void wifiscanssid::scanWifi()
 
 }
 
+void wifiscanssid::slotScanFinished()
+{
+    // Keep the selection if the same network is still listed
+    QString selected;
+    if ( listWifi->currentItem() != 0 )
+      selected = listWifi->currentItem()->text().section(" (signal strength:", 0, 0);
+    fillList();
+    for ( int z = 0 ; z < listWifi->count() && ! selected.isEmpty() ; z++){
+      if ( listWifi->item(z)->text().startsWith(selected + " (") ){
+        listWifi->setCurrentRow(z);
+        break;
+      }
+    }
+}
+
 
 void wifiscanssid::slotCancel()
 {
@@ -6,6 +6,7 @@
 #include <qfile.h>
 #include <qmessagebox.h>
 #include <qdialog.h>
+#include <pcbsd-wifiscan.h>
 #include "ui_wifiscanssid.h"
 
 class wifiscanssid : public QDialog, private Ui::wifiscanssid
@@ -28,9 +29,12 @@ private slots:
     void slotCancel();
     void slotConnect();
     void slotRescan();
+    void slotScanFinished();
 
 private:
     QString DeviceName;
+    WifiScanner *scanner;
+    void fillList();
     QString getLineFromCommandOutput( QString command );
     QString getSignalStrengthForIdent( QString ifoutput );
 
@@ -0,0 +1,145 @@
+#include "PrintJob.h"
+
+#include <QCoreApplication>
+#include <QPainter>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <poppler-qt5.h>
+
+// Highest resolution used for rendering the pages (a 1200 DPI page would take ~500MB of memory)
+const static int MAXPRINTDPI = 300;
+// Most render threads to use at once
+const static int MAXPRINTTHREADS = 4;
+
+namespace{
+
+class RenderTask : public QRunnable{
+public:
+  RenderTask(PrintJob::Queue *queue){ Q = queue; }
+  void run(){
+    //Poppler documents are not thread-safe: use a separate copy in each thread
+    Poppler::Document *doc = Poppler::Document::loadFromData(Q->data);
+    if(doc==0 || doc->isLocked()){
+      if(doc!=0){ delete doc; }
+      QMutexLocker locker(&Q->lock);
+      Q->cancelled = true; //cannot print anything
+      Q->changed.wakeAll();
+      return;
+    }
+    doc->setRenderHint(Poppler::Document::Antialiasing, true);
+    doc->setRenderHint(Poppler::Document::TextAntialiasing, true);
+    while(true){
+      Q->lock.lock();
+      //Wait until the painter has caught up
+      while( !Q->cancelled && Q->nextRender < Q->order.length() && Q->nextRender >= Q->painted + Q->window ){
+        Q->changed.wait(&Q->lock);
+      }
+      if(Q->cancelled || Q->nextRender >= Q->order.length()){ Q->lock.unlock(); break; }
+      int page = Q->order[Q->nextRender];
+      Q->nextRender++;
+      Q->lock.unlock();
+      //Render this page
+      QImage img;
+      Poppler::Page *DOCPAGE = doc->page(page);
+      if(DOCPAGE!=0){
+        img = DOCPAGE->renderToImage(Q->dpi, Q->dpi);
+        delete DOCPAGE;
+      }
+      Q->lock.lock();
+      Q->ready.insert(page, img);
+      Q->changed.wakeAll();
+      Q->lock.unlock();
+    }
+    delete doc;
+  }
+private:
+  PrintJob::Queue *Q;
+};
+
+} //end of anonymous namespace
+
+PrintJob::PrintJob(QByteArray pdfData, QPrinter *printer, int fromPage, int toPage, QObject *parent) : QObject(parent){
+  PRINTER = printer;
+  Q.data = pdfData;
+  if(fromPage <= toPage){
+    for(int i=fromPage; i<=toPage; i++){ Q.order << i; }
+  }else{
+    for(int i=fromPage; i>=toPage; i--){ Q.order << i; }
+  }
+  Q.nextRender = 0;
+  Q.painted = 0;
+  Q.cancelled = false;
+  Q.dpi = qMin(PRINTER->resolution(), MAXPRINTDPI);
+  Q.window = qMax(1, qMin(QThread::idealThreadCount(), MAXPRINTTHREADS)) + 1;
+}
+
+PrintJob::~PrintJob(){
+}
+
+bool PrintJob::wasCancelled(){
+  QMutexLocker locker(&Q.lock);
+  return Q.cancelled;
+}
+
+void PrintJob::run(){
+  bool guithread = (QThread::currentThread() == QCoreApplication::instance()->thread());
+  int total = Q.order.length();
+  //Start the render threads
+  QThreadPool pool;
+  pool.setMaxThreadCount(Q.window - 1);
+  for(int i=0; i<pool.maxThreadCount(); i++){ pool.start(new RenderTask(&Q)); }
+  //Now paint the pages in order as they become available
+  QRect target = PRINTER->pageRect(); //device pixels
+  QPainter painter(PRINTER);
+  int done = 0;
+  for(int i=0; i<total; i++){
+    QImage img;
+    Q.lock.lock();
+    while( !Q.cancelled && !Q.ready.contains(Q.order[i]) ){
+      if(guithread){
+        //Keep the GUI (progress/cancel) alive while waiting
+        Q.changed.wait(&Q.lock, 50);
+        Q.lock.unlock();
+        QCoreApplication::processEvents();
+        Q.lock.lock();
+      }else{
+        Q.changed.wait(&Q.lock);
+      }
+    }
+    bool stop = Q.cancelled;
+    if(!stop){ img = Q.ready.take(Q.order[i]); }
+    Q.lock.unlock();
+    if(stop){ break; }
+    if(i>0){ PRINTER->newPage(); } //this is the start of the next page (not needed for first)
+    if(!img.isNull()){
+      QSize size = img.size().scaled(target.size(), Qt::KeepAspectRatio);
+      painter.drawImage(QRect(QPoint(0,0), size), img);
+    }
+    Q.lock.lock();
+    Q.painted++;
+    Q.changed.wakeAll();
+    Q.lock.unlock();
+    done++;
+    emit progress(done, total);
+    if(guithread){ QCoreApplication::processEvents(); }
+  }
+  //Make sure the render threads stop
+  Q.lock.lock();
+  bool cancelled = Q.cancelled;
+  Q.cancelled = true;
+  Q.changed.wakeAll();
+  Q.lock.unlock();
+  pool.waitForDone();
+  if(cancelled){ PRINTER->abort(); }
+  painter.end();
+  Q.cancelled = cancelled;
+  emit finished(!cancelled);
+}
+
+void PrintJob::cancel(){
+  QMutexLocker locker(&Q.lock);
+  Q.cancelled = true;
+  Q.changed.wakeAll();
+}
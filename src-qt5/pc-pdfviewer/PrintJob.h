@@ -0,0 +1,53 @@
+#ifndef _PCBSD_PDF_VIEWER_PRINT_JOB_H
+#define _PCBSD_PDF_VIEWER_PRINT_JOB_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QPrinter>
+#include <QWaitCondition>
+
+//Renders the pages of a PDF document onto a printer
+// The pages are rendered (at the printer resolution) by a pool of threads, each with its own copy
+// of the document, and painted onto the printer in order. Only a few pages are rendered ahead of
+// the one being painted, so the memory use does not depend on the number of pages.
+class PrintJob : public QObject{
+	Q_OBJECT
+public:
+	//fromPage/toPage: page indexes (0 = first page), printed backwards if fromPage > toPage
+	PrintJob(QByteArray pdfData, QPrinter *printer, int fromPage, int toPage, QObject *parent = 0);
+	~PrintJob();
+
+	bool wasCancelled();
+
+	//Shared with the render threads
+	struct Queue{
+	  QMutex lock;
+	  QWaitCondition changed;
+	  QByteArray data; //the PDF file
+	  QList<int> order; //pages in print order
+	  int nextRender; //position in "order" of the next page to render
+	  int painted; //number of pages painted on the printer
+	  int window; //maximum number of pages rendered ahead of the painter
+	  int dpi;
+	  QHash<int, QImage> ready; //rendered pages waiting to be painted
+	  bool cancelled;
+	};
+
+public slots:
+	void run(); //render and paint all the pages (blocking - events are processed if used in the GUI thread)
+	void cancel(); //thread-safe
+
+private:
+	QPrinter *PRINTER;
+	Queue Q;
+
+signals:
+	void progress(int done, int total);
+	void finished(bool ok);
+};
+
+#endif
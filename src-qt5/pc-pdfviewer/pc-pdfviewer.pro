@@ -8,10 +8,12 @@ LIBS    += -L../libpcbsd -L/usr/local/lib -lpcbsd-utils -lpcbsd-ui -lpoppler-qt5
 
 INCLUDEPATH+= ../libpcbsd/utils ../libpcbsd/ui /usr/local/include /usr/local/include/poppler/qt5
 
-HEADERS	+= pdfUI.h
+HEADERS	+= pdfUI.h \
+	PrintJob.h
 
 SOURCES	+= main.cpp \
-         pdfUI.cpp
+         pdfUI.cpp \
+         PrintJob.cpp
 
 FORMS += pdfUI.ui
 
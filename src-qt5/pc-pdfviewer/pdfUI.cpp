@@ -12,6 +12,7 @@
 #include <QPrintPreviewDialog>
 #include <QPainter>
 #include <QMessageBox>
+#include <QFile>
 
 
 int SCALEFACTOR = 4;
@@ -24,7 +25,10 @@ pdfUI::pdfUI(bool debug, QString file) : QMainWindow(), ui(new Ui::pdfUI()){
   DOC = 0; //initial pointer value
   SDPI = QSize(); //make sure it is empty by default
   presentationLabel = 0; //not initialized yet
-  //PRINTER = new QPrinter();
+  PRINTER = 0;
+  printJob = 0;
+  printThread = 0;
+  printDLG = 0;
   cdir = QDir::homePath(); //initial default
   upTimer = new QTimer(this);
     upTimer->setSingleShot(true);
@@ -114,6 +118,14 @@ pdfUI::pdfUI(bool debug, QString file) : QMainWindow(), ui(new Ui::pdfUI()){
 }
 
 pdfUI::~pdfUI(){
+  //Stop any running print job
+  if(printJob!=0){
+    printJob->cancel();
+    printThread->quit();
+    printThread->wait();
+    delete printJob;
+    delete PRINTER;
+  }
   //Clean up any open document
   if(DOC!=0){
     delete DOC;
@@ -144,7 +156,8 @@ bool pdfUI::OpenPDF(QString filepath){
   DOC = TEMPDOC; //good file - go ahead and use it
   pageimage = -1;
   pageImages.clear();
-  //Save the dir this file is from for later
+  //Save the file/dir for later
+  cfile = filepath;
   cdir = filepath.section("/",0,-2);
   if(DEBUG){ qDebug() << "New cdir:" << cdir; }
   //Grab info about the document and update the widget
@@ -403,11 +416,37 @@ void pdfUI::endPresentation(){
 }
 
 void pdfUI::on_actionPrint_triggered(){
-  QPrintDialog dlg(this);
+  if(printJob!=0){ printDLG->show(); return; } //still printing
+  PRINTER = new QPrinter(QPrinter::HighResolution);
+  QPrintDialog dlg(PRINTER, this);
     dlg.setOption(QAbstractPrintDialog::PrintSelection, false);
-
-    connect(&dlg, SIGNAL(accepted(QPrinter*)), this, SLOT(paintOnPrinter(QPrinter*)));
-  dlg.exec();
+  int fromP, toP;
+  QByteArray data;
+  if(dlg.exec()!=QDialog::Accepted || !printRange(PRINTER, fromP, toP, data) ){
+    delete PRINTER;
+    PRINTER = 0;
+    return;
+  }
+  //Now start the print job in the background
+  printJob = new PrintJob(data, PRINTER, fromP, toP);
+  printThread = new QThread(this);
+  printJob->moveToThread(printThread);
+  connect(printThread, SIGNAL(started()), printJob, SLOT(run()) );
+  connect(printJob, SIGNAL(progress(int,int)), this, SLOT(printProgress(int,int)) );
+  connect(printJob, SIGNAL(finished(bool)), this, SLOT(printFinished(bool)) );
+  if(printDLG==0){
+    printDLG = new QProgressDialog(this);
+      printDLG->setWindowTitle(tr("Printing"));
+      printDLG->setAutoClose(false);
+      printDLG->setAutoReset(false);
+  }
+  printDLG->setLabelText( QString(tr("Printing Document (%1 pages)")).arg(QString::number(qAbs(toP-fromP)+1)) );
+  printDLG->setRange(0, qAbs(toP-fromP)+1);
+  printDLG->setValue(0);
+  //The job is busy in its own thread - cancel it directly
+  connect(printDLG, SIGNAL(canceled()), printJob, SLOT(cancel()), Qt::DirectConnection);
+  printDLG->show();
+  printThread->start();
 }
 
 void pdfUI::on_actionPrint_Preview_triggered(){
@@ -416,46 +455,65 @@ void pdfUI::on_actionPrint_Preview_triggered(){
   dlg.exec();
 }
 
-void pdfUI::paintOnPrinter(QPrinter *PRINTER){
+bool pdfUI::printRange(QPrinter *printer, int &fromP, int &toP, QByteArray &data){
   //Get page range in index-notation (0->X, not page-number notation 1->X+1)
-  int fromP = PRINTER->fromPage()-1;
-  int toP = PRINTER->toPage()-1;
+  fromP = printer->fromPage()-1;
+  toP = printer->toPage()-1;
   //Adjust the page range as necessary
   if(fromP < 0){ fromP = 0; } //start at beginning
   if(toP < 1){ toP = spin_page->maximum()-1; } //full document
   else if(toP >= spin_page->maximum()){ toP = spin_page->maximum()-1; }
-  //Setup the printing variables
-  QRectF size = PRINTER->pageRect(QPrinter::DevicePixel);
-  QPainter painter(PRINTER);
-  QMessageBox wait(QMessageBox::NoIcon, tr("Please Wait"), QString(tr("Preparing Document (%1 pages)")).arg(QString::number(toP-fromP+1)), QMessageBox::Abort, this);
-    wait.setInformativeText(" "); //Make sure the window is the right size before showing it
-    //wait.setStandardButtons(QMessageBox::Abort); //make sure that no buttons are used
-    wait.show();
-  QApplication::processEvents();
-  if(PRINTER->pageOrder()==QPrinter::LastPageFirst){
+  if(printer->pageOrder()==QPrinter::LastPageFirst){
     //Reverse the page order
-    qDebug() << "Print Document: pages "<< fromP+1 << "to" << toP+1;
-    for(int i=toP; i>=fromP; i--){
-      if(!wait.isVisible()){ break; }
-      wait.setInformativeText( QString(tr("Loading Page: %1")).arg(i+1) );
-      QApplication::processEvents();
-      //Now paint this page on the printer
-      if(i!=toP){ PRINTER->newPage(); } //this is the start of the next page (not needed for first)
-      painter.drawImage(0,0,OpenPage(i).scaled(size.width(), size.height(), Qt::KeepAspectRatio,Qt::SmoothTransformation) );
-      QApplication::processEvents();
-    }
-  }else{
-    qDebug() << "Print Document: pages "<< fromP+1 << "to" << toP+1;
-    for(int i=fromP; i<=toP; i++){
-      if(!wait.isVisible()){ break; }
-      //qDebug() << " printing page:" << i+1;
-      wait.setInformativeText( QString(tr("Loading Page: %1")).arg(i+1) );
-      QApplication::processEvents();
-      //Now paint this page on the printer
-      if(i!=fromP){ PRINTER->newPage(); } //this is the start of the next page (not needed for first)
-      painter.drawImage(0,0,OpenPage(i).scaled(size.width(), size.height(), Qt::KeepAspectRatio,Qt::SmoothTransformation) );
-      QApplication::processEvents();
-    }
+    int tmp = fromP; fromP = toP; toP = tmp;
+  }
+  //The print job renders from its own copies of the document
+  QFile file(cfile);
+  if( file.open(QIODevice::ReadOnly) ){
+    data = file.readAll();
+    file.close();
+  }
+  if(data.isEmpty()){
+    QMessageBox::warning(this, tr("Error printing file"), tr("The document could not be read for printing.") );
+    return false;
   }
+  return true;
+}
+
+void pdfUI::paintOnPrinter(QPrinter *printer){
+  int fromP, toP;
+  QByteArray data;
+  if( !printRange(printer, fromP, toP, data) ){ return; }
+  int pages = qAbs(toP-fromP)+1;
+  QProgressDialog wait(QString(tr("Preparing Document (%1 pages)")).arg(QString::number(pages)), tr("Abort"), 0, pages, this);
+    wait.setWindowTitle(tr("Please Wait"));
+    wait.setMinimumDuration(0);
+  //Pages are still rendered in the background, but painted here (the preview needs them when this returns)
+  PrintJob job(data, printer, fromP, toP);
+  connect(&job, SIGNAL(progress(int,int)), &wait, SLOT(setValue(int)) );
+  connect(&wait, SIGNAL(canceled()), &job, SLOT(cancel()) );
+  job.run();
   wait.close();
 }
+
+void pdfUI::printProgress(int done, int total){
+  if(printDLG==0){ return; }
+  printDLG->setMaximum(total);
+  printDLG->setValue(done);
+}
+
+void pdfUI::printFinished(bool ok){
+  printThread->quit();
+  printThread->wait();
+  delete printThread;
+  delete printJob;
+  delete PRINTER;
+  printThread = 0;
+  printJob = 0;
+  PRINTER = 0;
+  printDLG->hide();
+  if(!ok && !printDLG->wasCanceled()){
+    QMessageBox::warning(this, tr("Error printing file"), tr("The document could not be printed.") );
+  }
+  printDLG->reset();
+}
@@ -10,9 +10,13 @@
 #include <QHash>
 #include <QPrinter>
 #include <QShortcut>
+#include <QProgressDialog>
+#include <QThread>
 
 #include <poppler-qt5.h>
 
+#include "PrintJob.h"
+
 namespace Ui{
 	class pdfUI;
 };
@@ -32,7 +36,11 @@ private:
 	QTimer *upTimer;
 	QSize SDPI, PDPI; //current screen/presentation DPI
 	QHash<int,QImage> pageImages; //the list of all loaded pages (instant read later)
-	//QPrinter *PRINTER;
+	QPrinter *PRINTER; //printer used by the background print job
+	PrintJob *printJob; //current background print job (0 if not printing)
+	QThread *printThread;
+	QProgressDialog *printDLG;
+	QString cfile; //the current file (conveniance)
 	int pageimage; //The page number for the saved image
 	QString cdir; //the directory that the current file is exists in (conveniance)
 	QLabel *presentationLabel;
@@ -53,6 +61,9 @@ private:
 	
 	QScreen *getScreen(bool current, bool &cancelled);
 	void startPresentation(bool atStart);
+
+	//Printing support functions
+	bool printRange(QPrinter *printer, int &fromP, int &toP, QByteArray &data);
 	
 private slots:
 	//PDF Viewing Functions
@@ -80,7 +91,9 @@ private slots:
 	//Printing support functions
 	void on_actionPrint_triggered();
 	void on_actionPrint_Preview_triggered();
-	void paintOnPrinter(QPrinter *PRINTER);
+	void paintOnPrinter(QPrinter *printer); //print preview (blocking)
+	void printProgress(int done, int total);
+	void printFinished(bool ok);
 	
 
 
@@ -114,7 +114,7 @@ void MainUI::ProgramInit()
    //Make sure we start on the installed tab
    ui->tabWidget->setCurrentWidget(ui->tab_browse);
 
-   //In the initialization phase, this should already have the installed/repo info available
+   //The repo info is still loading in the background at this point (RepositoryInfoReady refreshes the UI)
    qDebug() << "Set Default Install Option";
    slotUpdateJailList(); //will refresh the entire UI
    //installOptionChanged(); 
@@ -45,6 +45,24 @@ void PBIDBAccess::syncDBInfo(QString jailID, bool localreload, bool allreload){
   syncPbiRepoLists(localreload || allreload || synced); //load the PBI index lists
 }
 
+NGCatalog PBIDBAccess::currentCatalog(){
+  NGCatalog cat;
+  cat.PKGINSTALLED = PKGINSTALLED;
+  cat.PBIAVAIL = PBIAVAIL;
+  cat.PKGAVAIL = PKGAVAIL;
+  cat.CATAVAIL = CATAVAIL;
+  return cat;
+}
+
+void PBIDBAccess::setCatalog(const NGCatalog &cat){
+  PKGINSTALLED = cat.PKGINSTALLED;
+  jailLoaded.clear(); //catalogs are always for the main system
+  if(cat.installedOnly){ return; }
+  PBIAVAIL = cat.PBIAVAIL;
+  PKGAVAIL = cat.PKGAVAIL;
+  CATAVAIL = cat.CATAVAIL;
+}
+
 QHash<QString, NGApp> PBIDBAccess::getRawAppList(){ //PBI-apps that can be installed
   return PBIAVAIL;
 }
@@ -73,6 +91,55 @@ QHash<QString, NGApp> PBIDBAccess::JailPkgList(QString jailID){
   return PKGINSTALLED;
 }
 
+QHash<QString, NGInstallInfo> PBIDBAccess::JailInstallList(QString jailID){
+  QHash<QString, NGInstallInfo> hash;
+  QStringList args; 
+  if( !jailID.isEmpty() ){ args << "-j" << jailID; }
+  args << "query" << "-a" << "APP=%o::::%v::::%sh::::%k::::%t::::%a::::%q";
+  // [origin, installed version, installed size, isLocked, timestamp, isOrphan, arch
+  QStringList out = runCMD("pkg",args).split("APP=");	
+  for(int i=0; i<out.length(); i++){
+    QStringList info = out[i].split("::::");
+    if(info.length() < 7){ continue; } //invalid
+    NGInstallInfo inst;
+      inst.installedversion = info[1];
+      inst.installedsize = info[2];
+      inst.isLocked = (info[3] == "1");
+      inst.installedwhen = QDateTime::fromTime_t( info[4].toLongLong() ).toString(Qt::DefaultLocaleShortDate);
+      inst.isOrphan = (info[5] == "1");
+      inst.installedarch = cleanupArch(info[6]);
+    hash.insert(info[0], inst);
+  }
+  //Now get the reverse dependancy lists
+  args.clear(); 
+  if( !jailID.isEmpty() ){ args << "-j" << jailID; }
+  args << "query" << "-a" << "APP=%o::::%ro";
+  out = runCMD("pkg", args).split("APP=");
+  for(int i=0; i<out.length();i++){
+    QStringList info = out[i].split("::::");
+    if(info.length() < 2 || !hash.contains(info[0]) ){ continue; } //invalid
+    hash[info[0]].rdependency.append( info[1].simplified() );
+  }
+  return hash;
+}
+
+void PBIDBAccess::setInstallInfo(NGApp *app, const NGInstallInfo *info){
+  app->isInstalled = (info!=0);
+  if(info==0){
+    app->installedversion.clear(); app->installedsize.clear(); app->installedwhen.clear(); app->installedarch.clear();
+    app->isLocked = false; app->isOrphan = false;
+    app->rdependency.clear();
+  }else{
+    app->installedversion = info->installedversion;
+    app->installedsize = info->installedsize;
+    app->installedwhen = info->installedwhen;
+    app->installedarch = info->installedarch;
+    app->isLocked = info->isLocked;
+    app->isOrphan = info->isOrphan;
+    app->rdependency = info->rdependency;
+  }
+}
+
 NGApp PBIDBAccess::getLocalPkgDetails(NGApp app){
   //Simply set the proper bits in the container for locally installed apps
   // NOTE: This is dependant upon which jail is being probed
@@ -181,6 +248,14 @@ QStringList PBIDBAccess::basePackageList(){
   return QStringList();
 }
 
+bool PBIDBAccess::pkgUpdatesAvailable(QString jailID){
+  //Run pc-updatemanager pkgcheck to check for updates
+  QString out;
+  if(jailID.isEmpty()){ out  = runCMD("pc-updatemanager pkgcheck"); }
+  else{ out = runCMD("pc-updatemanager -j "+jailID+" pkgcheck"); }
+  return (!out.contains("All packages are up to date!") && out.contains("To start the upgrade run ") );
+}
+
 
 // ========================================
 // =======  PRIVATE ACCESS FUNCTIONS ======
@@ -194,40 +269,14 @@ bool PBIDBAccess::syncPkgInstallList(QString jailID, bool reload){
   bool synced = false;
   if(PKGINSTALLED.isEmpty() || reload || (jailLoaded!=jailID) ){
     PKGINSTALLED.clear();
-    QStringList args; 
-    if( !jailID.isEmpty() ){ args << "-j" << jailID; }
-    args << "query" << "-a" << "APP=%o::::%v::::%sh::::%k::::%t::::%a::::%q";
-    // [origin, installed version, installed size, isLocked, timestamp, isOrphan
-    QStringList out = runCMD("pkg",args).split("APP=");	
-    for(int i=0; i<out.length(); i++){
-      QStringList info = out[i].split("::::");
-      if(info.length() < 7){ continue; } //invalid
-      NGApp app;
-      if(PKGAVAIL.contains(info[0])){ app = PKGAVAIL[info[0]]; } //start from the current remote info
-      app.origin = info[0];
-      app.installedversion = info[1];
-      app.installedsize = info[2];
-      app.isLocked = (info[3] == "1");
-      app.installedwhen = QDateTime::fromTime_t( info[4].toLongLong() ).toString(Qt::DefaultLocaleShortDate);
-      app.isOrphan = (info[5] == "1");
-      app.installedarch = cleanupArch(info[6]);
-      app.isInstalled = true;
-      PKGINSTALLED.insert(info[0], app);
-      //if(!jailID.isEmpty()){ qDebug() << "Installed:" << out[i]; }
-    }
-    //Now get the reverse dependancy lists
-    args.clear(); 
-    if( !jailID.isEmpty() ){ args << "-j" << jailID; }
-    args << "query" << "-a" << "APP=%o::::%ro";
-    out = runCMD("pkg", args).split("APP=");
-    //qDebug() << "Get reverse Deps:" << out;
-    for(int i=0; i<out.length();i++){
-      QStringList info = out[i].split("::::");
+    QHash<QString, NGInstallInfo> installed = JailInstallList(jailID);
+    QHash<QString, NGInstallInfo>::const_iterator it;
+    for(it = installed.constBegin(); it != installed.constEnd(); ++it){
       NGApp app;
-      if(PKGINSTALLED.contains(info[0])){ app = PKGINSTALLED[info[0]]; } //Update existing info
-      else{ continue; } //invalid
-      app.rdependency.append( info[1].simplified() );
-      PKGINSTALLED.insert(info[0], app);
+      if(PKGAVAIL.contains(it.key())){ app = PKGAVAIL[it.key()]; } //start from the current remote info
+      app.origin = it.key();
+      setInstallInfo(&app, &it.value());
+      PKGINSTALLED.insert(it.key(), app);
     }
     jailLoaded = jailID; //keep track of which jail this list is for
     synced = true;
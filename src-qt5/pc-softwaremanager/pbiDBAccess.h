@@ -12,6 +12,7 @@
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QMetaType>
 
 #define PBI_DBDIR QString("/var/db/pbi/index/")
 
@@ -40,6 +41,33 @@ class NGApp{
 	~NGApp(){}
 };
 
+// Installed state of a single pkg (per-jail overlay on top of the shared repo info)
+class NGInstallInfo{
+  public:
+	QString installedversion, installedsize, installedwhen, installedarch;
+	bool isLocked, isOrphan;
+	QStringList rdependency;
+
+	NGInstallInfo(){ isLocked=false; isOrphan=false; }
+	~NGInstallInfo(){}
+};
+
+// Complete copy of the repo/installed info (built in the background by PBIDBWorker)
+class NGCatalog{
+  public:
+	QHash<QString, NGApp> PKGINSTALLED, PBIAVAIL, PKGAVAIL;
+	QHash<QString, NGCat> CATAVAIL;
+	QHash<QString, NGApp> PKGLIST; //PKGAVAIL with the installed entries applied
+	QStringList NEWLIST, HIGHLIST, RECLIST; //AppCafe home page lists
+	bool updavail; //pkg updates available
+	bool reloadAll; //repo info was reloaded from scratch
+	bool installedOnly; //only PKGINSTALLED/updavail are filled in
+  
+	NGCatalog(){ updavail=false; reloadAll=false; installedOnly=false; }
+	~NGCatalog(){}
+};
+Q_DECLARE_METATYPE(NGCatalog)
+
 // Interface class for the system databases (pkg and PBI)
 class PBIDBAccess{
 public:
@@ -51,11 +79,16 @@ public:
 	//  to ensure the internal data is correct for the jail needed (even if no jail);
 	void syncDBInfo(QString jailID = "", bool localreload = false, bool allreload = false); //setup the internal variables to associate with the given jail
 	
+	//Catalog snapshots (the hashes are implicitly shared, so these are cheap)
+	NGCatalog currentCatalog(); //copy of the internal lists
+	void setCatalog(const NGCatalog &cat); //replace the internal lists with ones built elsewhere
+
 	//Main access functions
 	QHash<QString, NGCat> Categories();  //All categories for ports/pbi's (unified)
 	QHash<QString, NGApp> DetailedAppList(); //PBI-apps that can/are installed
 	QHash<QString, NGApp> DetailedPkgList(); //Pkg-apps that can/are installed (Warning - takes a while!)
 	QHash<QString, NGApp> JailPkgList(QString jailID); //Pkg-apps that are installed in jail
+	QHash<QString, NGInstallInfo> JailInstallList(QString jailID); //Installed state only (no repo info)
 
 	//Individual access functions
 	NGApp getLocalPkgDetails(NGApp);
@@ -65,6 +98,9 @@ public:
 	QStringList getRawInstalledPackages(); //all installed packages
 	QHash<QString, NGApp> getRawAppList(); //PBI-apps that can be installed
 	
+	//Apply the installed state to an app (info==0: not installed)
+	static void setInstallInfo(NGApp *app, const NGInstallInfo *info);
+
 	//General item update/info
 	NGApp updateAppStatus(NGApp); //re-update installed info
 	QStringList AppMenuEntries(NGApp); //get available menu *.desktop files
@@ -73,6 +109,7 @@ public:
 		
 	QStringList listJailPackages(QString jailID);
 	QStringList basePackageList();
+	bool pkgUpdatesAvailable(QString jailID = ""); //runs "pc-updatemanager pkgcheck"
 	
 	QString runCMD(QString cmd, QStringList args = QStringList() );
 	
@@ -0,0 +1,34 @@
+#include "pbiDBWorker.h"
+
+PBIDBWorker::PBIDBWorker() : QObject(){
+  DB = 0;
+}
+
+PBIDBWorker::~PBIDBWorker(){
+  if(DB!=0){ delete DB; }
+}
+
+void PBIDBWorker::loadCatalog(bool localreload, bool allreload){
+  if(DB==0){ DB = new PBIDBAccess(); allreload = true; }
+  DB->syncDBInfo("", localreload, allreload);
+  if(RECLIST.isEmpty() || allreload){
+    DB->getAppCafeHomeInfo( &NEWLIST, &HIGHLIST, &RECLIST); //also flags the recommended apps
+  }
+  NGCatalog cat = DB->currentCatalog();
+  cat.PKGLIST = DB->DetailedPkgList();
+  cat.NEWLIST = NEWLIST;
+  cat.HIGHLIST = HIGHLIST;
+  cat.RECLIST = RECLIST;
+  cat.updavail = DB->pkgUpdatesAvailable("");
+  cat.reloadAll = allreload;
+  emit CatalogReady(cat);
+}
+
+void PBIDBWorker::loadInstalled(){
+  if(DB==0){ loadCatalog(true, true); return; } //nothing to update yet
+  NGCatalog cat;
+  cat.installedOnly = true;
+  cat.PKGINSTALLED = DB->JailPkgList(""); //always re-reads the installed list
+  cat.updavail = DB->pkgUpdatesAvailable("");
+  emit CatalogReady(cat);
+}
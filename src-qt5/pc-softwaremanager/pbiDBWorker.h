@@ -0,0 +1,29 @@
+#ifndef _APPCAFE_PBI_DATABASE_WORKER_H
+#define _APPCAFE_PBI_DATABASE_WORKER_H
+
+#include <QObject>
+#include <QStringList>
+
+#include "pbiDBAccess.h"
+
+// Loads the pkg/PBI catalog outside of the GUI thread (see PBIBackend::slotSyncToDatabase)
+//  Uses its own PBIDBAccess, so the GUI copy is never touched while a load is running
+class PBIDBWorker : public QObject{
+	Q_OBJECT
+public:
+	PBIDBWorker();
+	~PBIDBWorker();
+
+public slots:
+	void loadCatalog(bool localreload, bool allreload); //full catalog
+	void loadInstalled(); //only the list of installed pkgs (after an install/remove)
+
+private:
+	PBIDBAccess *DB; //created on first use - within the worker thread
+	QStringList NEWLIST, HIGHLIST, RECLIST;
+
+signals:
+	void CatalogReady(NGCatalog);
+};
+
+#endif
@@ -29,8 +29,11 @@
  //  appID: <name> (of app in repo)
  
  #include <unistd.h>
+ #include <math.h>
  #include "pbiNgBackend.h"
 
+// Number of pkg jobs which may run at the same time (each on a different jail/host)
+const static int maxPkgJobs = 4;
  
  PBIBackend::PBIBackend(QWidget *parent, QSplashScreen *splash) : QObject(){
    parentWidget = parent;
@@ -41,18 +44,22 @@
    sysUser = Extras::getRegularUser();
 	 //qDebug() << "System User:" << sysUser;
    autoDE = false; //automatically create desktop entries after an install
-   PKGRUN.clear(); //make sure this is empty initially
    appAvailable  = -1; //quick default
    pkgAvailable = -1; //quick default
 	 
-   pkgProc = new DLProcess(this);
-     pkgProc->setParentWidget(parentWidget);
-     pkgProc->setDLType("PKG");
-     connect(pkgProc, SIGNAL(UpdateMessage(QString)), this, SLOT(procMessage(QString)) );
-     connect(pkgProc, SIGNAL(UpdatePercent(QString,QString,QString)), this, SLOT(procPercent(QString,QString,QString)) );
-     connect(pkgProc, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(procFinished(int, QProcess::ExitStatus)) );
-     
    sysDB = new PBIDBAccess();
+   //Catalog loading runs in its own thread so the UI is never blocked by pkg queries
+   qRegisterMetaType<NGCatalog>("NGCatalog");
+   syncRunning = false;
+   syncQueued = -1;
+   dbThread = new QThread();
+   dbWorker = new PBIDBWorker();
+     dbWorker->moveToThread(dbThread);
+     connect(this, SIGNAL(requestCatalog(bool,bool)), dbWorker, SLOT(loadCatalog(bool,bool)) );
+     connect(this, SIGNAL(requestInstalled()), dbWorker, SLOT(loadInstalled()) );
+     connect(dbWorker, SIGNAL(CatalogReady(NGCatalog)), this, SLOT(slotCatalogReady(NGCatalog)) );
+     connect(dbThread, SIGNAL(finished()), dbWorker, SLOT(deleteLater()) );
+   dbThread->start();
    //Now startup the syncing process
    UpdateIndexFiles(false); //do not force pbi index redownload on startup
    //Done with initial sync - disable splash screen
@@ -62,11 +69,20 @@
  
 void PBIBackend::shutdown(){
   PENDING.clear();
-  if( pkgProc->isRunning() ){
-    pkgProc->kill();
-    pkgProc->waitForFinished(5000); //give it 5 seconds to stop cleanly
-    if(pkgProc->isRunning()){ pkgProc->terminate(); } //force it to stop
+  QList<PkgJob> jobs = RUNNING.values();
+  for(int i=0; i<jobs.length(); i++){
+    DLProcess *proc = jobs[i].proc;
+    if( proc==0 || !proc->isRunning() ){ continue; }
+    proc->kill();
+    proc->waitForFinished(5000); //give it 5 seconds to stop cleanly
+    if(proc->isRunning()){ proc->terminate(); } //force it to stop
   }
+  if(dbThread==0){ return; } //already shut down
+  dbThread->quit();
+  dbThread->wait(); //let any catalog load finish first (the worker is deleted once the thread is done)
+  delete dbThread;
+  dbThread = 0;
+  dbWorker = 0;
 }
  
  // ==============================
@@ -98,11 +114,11 @@ QStringList PBIBackend::installedList(QString injail, bool raw, bool orphan){
        }
      }
    }else if( JAILPKGS.contains(injail) ){  
-     QHash<QString, NGApp> hash = JAILPKGS[injail];
-     QStringList tmp = hash.keys();
-     for(int i=0; i<tmp.length(); i++){
-       if(hash[tmp[i]].isOrphan && !orphan){ continue; }
-       out << tmp[i];
+     const QHash<QString, NGInstallInfo> &hash = JAILPKGS[injail];
+     QHash<QString, NGInstallInfo>::const_iterator it;
+     for(it = hash.constBegin(); it != hash.constEnd(); ++it){
+       if(it.value().isOrphan && !orphan){ continue; }
+       out << it.key();
      }
    }
    return out; 
@@ -110,22 +126,24 @@ QStringList PBIBackend::installedList(QString injail, bool raw, bool orphan){
  
 QStringList PBIBackend::pendingInstallList(){
   QStringList out;
-  if(PROCTYPE==0 && !PKGRUN.isEmpty() ){ out << PKGRUN; }
+  QList<PkgJob> jobs = RUNNING.values();
+  for(int i=0; i<jobs.length(); i++){
+    if(jobs[i].type==0){ out << jobs[i].origin; }
+  }
   for(int i=0; i<PENDING.length(); i++){
-    if( (PENDING[i].contains("pc-pkg ") && PENDING[i].contains(" install ") ) || PENDING[i].contains("pbi_add ")){
-      out << PENDING[i].section("::::",0,0);
-    }
+    if(PENDING[i].type==0){ out << PENDING[i].origin; }
   }
   return out;
 }
 
 QStringList PBIBackend::pendingRemoveList(){
   QStringList out;
-  if(PROCTYPE==1 && !PKGRUN.isEmpty() ){ out << PKGRUN; }
+  QList<PkgJob> jobs = RUNNING.values();
+  for(int i=0; i<jobs.length(); i++){
+    if(jobs[i].type==1){ out << jobs[i].origin; }
+  }
   for(int i=0; i<PENDING.length(); i++){
-    if((PENDING[i].contains("pc-pkg ") && PENDING[i].contains(" remove ") )  || PENDING[i].contains("pbi_delete ")){
-      out << PENDING[i].section("::::",0,0);
-    }
+    if(PENDING[i].type==1){ out << PENDING[i].origin; }
   }
   return out;	
 }
@@ -171,7 +189,7 @@ QStringList PBIBackend::getNewApps(){ //list new applications
 
 bool PBIBackend::safeToQuit(){
   //returns true if there is no pending/current processes
-  bool ok = ( PENDING.isEmpty() && PKGRUN.isEmpty() );
+  bool ok = ( PENDING.isEmpty() && RUNNING.isEmpty() );
   return ok;
 }
 // ===== Local/Repo Interaction Functions =====
@@ -198,17 +216,29 @@ void PBIBackend::cancelActions(QStringList appID){
   qDebug() << "Cancel Actions requested for:" << appID;
   for(int i=0; i<appID.length(); i++){
     for(int p=0; p<PENDING.length(); p++){
-      if(PENDING[p].startsWith(appID[i]+"::::")){ PENDING.removeAt(p); p--; }
+      if(PENDING[p].origin==appID[i]){ PENDING.removeAt(p); p--; }
     }
-    if( PKGRUN==appID[i] && !PROCCANCELLED ){
+    QHash<QString, PkgJob>::iterator it;
+    for(it = RUNNING.begin(); it != RUNNING.end(); ++it){
+      PkgJob &job = it.value();
+      if( job.origin!=appID[i] || job.cancelled || job.type<0 ){ continue; }
       //Currently running, don't stop the process since this can do damage to the database
-	//Just make sure the next process that runs reverses the current process
-	QString cmd = PKGCMD;
-	if(PROCTYPE==0 ){ cmd =cmd.replace("pbi_add ", "pbi_delete "); }
-	else if(PROCTYPE==0 && cmd.contains("pc-pkg ") ){ cmd = cmd.replace(" install ", " remove "); }
-	else if(PROCTYPE==1 && cmd.contains("pc-pkg ") ){ cmd = cmd.replace(" remove ", " install "); }
-	else if(PROCTYPE==1){ cmd=cmd.replace("pbi_delete ", "pbi_add "); }
-        if(PROCTYPE >= 0){ PENDING.prepend(PKGRUN+"::::"+cmd+"::::"+PKGJAIL); }
+      //Just make sure the next process that runs reverses the current process
+      PkgJob undo = job;
+      undo.proc = 0;
+      undo.log.clear();
+      undo.status.clear();
+      if(job.type==0){
+        undo.type = 1;
+        if(undo.cmd.contains("pc-pkg ")){ undo.cmd.replace(" install ", " remove "); }
+        else{ undo.cmd.replace("pbi_add ", "pbi_delete "); }
+      }else{
+        undo.type = 0;
+        if(undo.cmd.contains("pc-pkg ")){ undo.cmd.replace(" remove ", " install "); }
+        else{ undo.cmd.replace("pbi_delete ", "pbi_add "); }
+      }
+      job.cancelled = true;
+      PENDING.prepend(undo);
     }
   }
 }
@@ -218,13 +248,11 @@ void PBIBackend::removePBI(QStringList appID, QString injail){
   bool jailok = RUNNINGJAILS.contains(injail) && JAILPKGS.contains(injail);
   QStringList cancelList;
   for(int i=0; i<appID.length(); i++){
-    NGApp app;
-    if(APPHASH.contains(appID[i])){ app = APPHASH[appID[i]]; }
-    else if(PKGHASH.contains(appID[i])){ app = PKGHASH[appID[i]]; }
-    else{ continue; }
+    const NGApp *app = lookupApp(appID[i]);
+    if(app==0){ continue; }
     bool jailpkgok = false;
-    if(jailok){ jailpkgok = !JAILPKGS[injail].contains(app.origin); }
-      if( (!app.isInstalled && !jailok) || jailpkgok ){
+    if(jailok){ jailpkgok = !JAILPKGS[injail].contains(app->origin); }
+      if( (!app->isInstalled && !jailok) || jailpkgok ){
 	//Not a fully-installed PBI - cancel it instead (probably pending)
 	qDebug() << jailok << jailpkgok << appID[i];
 	cancelList << appID[i];
@@ -245,16 +273,14 @@ void PBIBackend::installApp(QStringList appID, QString injail){
   qDebug() << "Install App requested for:" << appID;
   bool jailok = RUNNINGJAILS.contains(injail) && JAILPKGS.contains(injail);
   for(int i=0; i<appID.length(); i++){
-    NGApp app;
-    if(APPHASH.contains(appID[i])){ app = APPHASH[appID[i]]; }
-    else if(PKGHASH.contains(appID[i])){ app = PKGHASH[appID[i]]; }
-    else{
+    const NGApp *app = lookupApp(appID[i]);
+    if(app==0){
       qDebug() << appID[i] << "is not a valid application";
       continue; //go to the next item is this one is invalid
     } 
     bool jailpkgok = false;
-    if(jailok){ jailpkgok = !JAILPKGS[injail].contains(app.origin); }
-    if( !app.isInstalled || jailpkgok ){
+    if(jailok){ jailpkgok = !JAILPKGS[injail].contains(app->origin); }
+    if( !app->isInstalled || jailpkgok ){
       queueProcess(appID[i], true, injail);
       emit PBIStatusChange(appID[i]);
     }else{
@@ -268,54 +294,55 @@ void PBIBackend::installApp(QStringList appID, QString injail){
 }
 
 void PBIBackend::installAppIntoJail(QString appID){
-  NGApp app;
-    if(APPHASH.contains(appID)){ app = APPHASH[appID]; }
-    else if(PKGHASH.contains(appID)){ app = PKGHASH[appID]; }
-    else{ qDebug() << "Invalid application ID:" << appID; return; }
-  if(app.pbiorigin.isEmpty()){
+  const NGApp *app = lookupApp(appID);
+  if(app==0){ qDebug() << "Invalid application ID:" << appID; return; }
+  if(app->pbiorigin.isEmpty()){
     qDebug() << "Installing into a new jail only works with PBI's!!";
     return;
   }
-  PENDING << appID+"::::"+"pbi_add -J "+appID+"::::--newjail";
+  PkgJob job;
+    job.origin = appID;
+    job.cmd = "pbi_add -J "+appID;
+    job.jail = "--newjail";
+    job.type = 0;
+  PENDING << job;
   //Now check/start the process
   QTimer::singleShot(0,this,SLOT(checkProcesses()) );
 }
 
 void PBIBackend::lockApp(QStringList appID, QString injail){
-  QHash<QString, NGApp> hash;
-  if(JAILPKGS.contains(injail)){ hash = JAILPKGS[injail]; }
   for(int i=0; i<appID.length(); i++){
-    NGApp app;
-    if(hash.contains(appID[i])){ app = hash[appID[i]]; }
-    else if(APPHASH.contains(appID[i])){ app = APPHASH[appID[i]]; }
-    else if(PKGHASH.contains(appID[i])){ app = PKGHASH[appID[i]]; }
-    else{ continue; }
+    NGApp app = singleAppInfo(appID[i], injail);
+    if(app.origin.isEmpty()){ continue; }
     if(app.isInstalled && !app.isLocked){
       //Run lock/unlock commands ASAP since they take no time at all, but have to be in the pkg queue
       QString cmd;
       if(injail.isEmpty() || !RUNNINGJAILS.contains(injail) ){ cmd = "pc-pkg lock -y "+appID[i]; injail.clear();}
       else{ cmd = "pc-pkg -j "+RUNNINGJAILS[injail]+" lock -y "+appID[i]; }
-      PENDING.prepend(appID[i]+"::::"+cmd+"::::"+injail);
+      PkgJob job;
+        job.origin = appID[i];
+        job.cmd = cmd;
+        job.jail = injail;
+      PENDING.prepend(job);
     }
   }
   QTimer::singleShot(0,this,SLOT(checkProcesses()) );
 }
 
 void PBIBackend::unlockApp(QStringList appID, QString injail){
-  QHash<QString, NGApp> hash;
-  if(JAILPKGS.contains(injail)){ hash = JAILPKGS[injail]; }
   for(int i=0; i<appID.length(); i++){
-    NGApp app;
-    if(hash.contains(appID[i])){ app = hash[appID[i]]; }
-    else if(APPHASH.contains(appID[i])){ app = APPHASH[appID[i]]; }
-    else if(PKGHASH.contains(appID[i])){ app = PKGHASH[appID[i]]; }
-    else{ continue; }
+    NGApp app = singleAppInfo(appID[i], injail);
+    if(app.origin.isEmpty()){ continue; }
     if(app.isInstalled && app.isLocked){
       //Run lock/unlock commands ASAP since they take no time at all, but have to be in the pkg queue
       QString cmd;
       if(injail.isEmpty() || !RUNNINGJAILS.contains(injail) ){ cmd = "pc-pkg unlock -y "+appID[i]; injail.clear();}
       else{ cmd = "pc-pkg -j "+RUNNINGJAILS[injail]+" unlock -y "+appID[i]; }
-      PENDING.prepend(appID[i]+"::::"+cmd+"::::"+injail);
+      PkgJob job;
+        job.origin = appID[i];
+        job.cmd = cmd;
+        job.jail = injail;
+      PENDING.prepend(job);
     }
   }
   QTimer::singleShot(0,this,SLOT(checkProcesses()) );	
@@ -358,14 +385,12 @@ void PBIBackend::rmDesktopIcons(QStringList pbiID, bool allusers){ // remove XDG
 // INFO FUNCTIONS
 NGApp PBIBackend::singleAppInfo( QString app, QString injail){
   if(JAILPKGS.contains(injail)){
-    QHash<QString, NGApp> hash = JAILPKGS[injail];
-    if( hash.contains(app) ){ return hash[app]; }
-    else{ 
-	//Still load the info - but be sure to mark it as not installed within this jail
-	NGApp info = singleAppInfo(app);
-	info.isInstalled = false; 
-	return info; 
-    }
+    //Shared repo info with the installed state for this jail on top
+    NGApp info = singleAppInfo(app);
+    if(info.origin.isEmpty()){ info.origin = app; } //only installed in the jail
+    QHash<QString, NGInstallInfo>::const_iterator it = JAILPKGS[injail].constFind(app);
+    PBIDBAccess::setInstallInfo(&info, (it != JAILPKGS[injail].constEnd()) ? &it.value() : 0);
+    return info;
   }else if(APPHASH.contains(app)){
     return APPHASH[app];
   }else if(PKGHASH.contains(app)){
@@ -433,16 +458,24 @@ QString PBIBackend::getMetaPkgSize(QString appID, QString injail){
 
 QString PBIBackend::currentAppStatus( QString appID, QString injail ){
   QString output;
-  if(appID == PKGRUN){ output = PKGRUNSTAT; } //currently running
-  else{
-    for(int i=0; i<PENDING.length(); i++){
-      if(PENDING[i].startsWith(appID+"::::")){
-        //Currently pending - check which type (install/remove)
-	if(injail.isEmpty() || PENDING[i].endsWith("::::"+injail) ){
-	  if(PENDING[i].contains("pbi_add") || (PENDING[i].contains("pc-pkg ") &&PENDING[i].contains(" add ") ) ){ output = tr("Pending Installation"); }
-	  else if(PENDING[i].contains("pbi_delete") || (PENDING[i].contains("pc-pkg ") && PENDING[i].contains(" remove ") ) ){ output = tr("Pending Removal"); }
-	  break;
-	}
+  QList<PkgJob> jobs = RUNNING.values();
+  for(int i=0; i<jobs.length(); i++){
+    if(jobs[i].origin!=appID || !(injail.isEmpty() || jobs[i].jail==injail) ){ continue; }
+    //currently running - also show how long it has been going
+    output = jobs[i].status;
+    if(!output.isEmpty()){
+      int secs = jobs[i].timer.elapsed()/1000;
+      output.append( QString(" (%1:%2)").arg(QString::number(secs/60), QString::number(secs%60).rightJustified(2,'0')) );
+    }
+    return output;
+  }
+  for(int i=0; i<PENDING.length(); i++){
+    if(PENDING[i].origin==appID){
+      //Currently pending - check which type (install/remove)
+      if(injail.isEmpty() || PENDING[i].jail==injail ){
+        if(PENDING[i].type==0){ output = tr("Pending Installation"); }
+        else if(PENDING[i].type==1){ output = tr("Pending Removal"); }
+        break;
       }
     }
   }
@@ -450,11 +483,14 @@ QString PBIBackend::currentAppStatus( QString appID, QString injail ){
 }
 
 bool PBIBackend::isWorking(QString pbiID){
-  bool working = (pbiID==PKGRUN);
-  for(int i=0; i<PENDING.length() && !working; i++){
-    working = PENDING[i].startsWith(pbiID+"::::");
+  QList<PkgJob> jobs = RUNNING.values();
+  for(int i=0; i<jobs.length(); i++){
+    if(jobs[i].origin==pbiID){ return true; }
   }
-  return working;
+  for(int i=0; i<PENDING.length(); i++){
+    if(PENDING[i].origin==pbiID){ return true; }
+  }
+  return false;
 }
 
 QStringList PBIBackend::appBinList(QString appID){ //<name>::::<*.desktop file path>
@@ -640,33 +676,42 @@ void PBIBackend::startSimilarSearch(){
   QStringList stags;
   if(APPHASH.contains(sID)){ stags = APPHASH[sID].tags; }
   else if(PKGHASH.contains(sID)){ stags = PKGHASH[sID].tags; }
+  stags.removeDuplicates();
   if(stags.isEmpty()){ return; } //no tags to look for similarities
-  //Now get all the pkgs to search
-  QStringList apps;
-  if(!searchAll){ apps = APPHASH.keys(); }
-  else{ apps = PKGHASH.keys(); } //search all packages (takes longer)
-  QStringList unsorted;
-  int maxMatch=0;
-  for(int i=0; i<apps.length(); i++){
-    if(apps[i]==sID){continue;} //skip the app we were given for search parameters
-    QStringList tags;
-    if(APPHASH.contains(apps[i])){ tags = APPHASH[apps[i]].tags; }
-    else if(PKGHASH.contains(apps[i])){ tags = PKGHASH[apps[i]].tags; }
-    int match=0;
-    for(int j=0; j<stags.length(); j++){
-       if(tags.indexOf(stags[j]) != -1){ match++; }
+  //Now count the shared tags with the tag index (only pkgs with at least one shared tag are touched)
+  const QHash<QString, QStringList> &index = searchAll ? PKGTAGS : APPTAGS; //search all packages or just apps
+  double total = searchAll ? PKGHASH.size() : APPHASH.size();
+  QHash<QString, int> matches;
+  QHash<QString, double> weights; //rare tags count more (IDF) - only used to order equal matches
+  for(int j=0; j<stags.length(); j++){
+    QStringList list = index.value(stags[j]);
+    if(list.isEmpty()){ continue; }
+    double idf = log( total/list.length() );
+    for(int i=0; i<list.length(); i++){
+      if(list[i]==sID){ continue; } //skip the app we were given for search parameters
+      matches[list[i]]++;
+      weights[list[i]] += idf;
     }
-    if(match > 1){ unsorted << QString::number(match)+"::"+apps[i]; }
-    if(match > maxMatch){ maxMatch = match; }
-  }
-  unsorted.sort();
-  for(int i=unsorted.length(); i>0; i--){
-    if( unsorted[i-1].section("::",0,0).toInt() > (maxMatch-1) ){
-      output << unsorted[i-1].section("::",1,50);
-    }else if( output.length() < 5 ){ //not enough matches, grab the next set too
-      output << unsorted[i-1].section("::",1,50);
-      maxMatch--;
-    }else{ break; } //already sorted and the rest are even lower match rating
+  }
+  //Sort by number of matching tags (numerically), highest first
+  typedef QPair< QPair<int, double>, QString> RankedApp; // <<matches, weight>, origin>
+  QList<RankedApp> ranked;
+  int maxMatch=0;
+  QHashIterator<QString, int> it(matches);
+  while(it.hasNext()){
+    it.next();
+    if(it.value() < 2){ continue; } //need at least two shared tags
+    ranked << qMakePair( qMakePair(it.value(), weights[it.key()]), it.key() );
+    if(it.value() > maxMatch){ maxMatch = it.value(); }
+  }
+  std::sort(ranked.begin(), ranked.end(), std::greater<RankedApp>());
+  //Return all the best matches, and at least 5 if there are that many
+  // (a group of equal matches is never split - the IDF weight only orders them)
+  int lastTaken = maxMatch;
+  for(int i=0; i<ranked.length(); i++){
+    if( ranked[i].first.first < lastTaken && output.length() >= 5 ){ break; }
+    output << ranked[i].second;
+    lastTaken = ranked[i].first.first;
   }
   //Now emit the signal with the results
   emit SimilarFound(output);
@@ -704,7 +749,93 @@ void PBIBackend::queueProcess(QString origin, bool install, QString injail){
     }
   }else{injail.clear(); }
   cmd.append(origin);
-  PENDING << origin+"::::"+cmd+"::::"+injail;
+  PkgJob job;
+    job.origin = origin;
+    job.cmd = cmd;
+    job.jail = injail;
+    job.type = install ? 0 : 1;
+  PENDING << job;
+}
+
+bool PBIBackend::startNextJob(){
+  //Find the first pending job whose pkg database is not in use
+  // (jobs for the same target stay in the order they were queued)
+  if(RUNNING.size() >= maxPkgJobs){ return false; }
+  int index = -1;
+  for(int i=0; i<PENDING.length() && index<0; i++){
+    if( !RUNNING.contains(PENDING[i].target()) ){ index = i; }
+  }
+  if(index<0){ return false; }
+  PkgJob job = PENDING.takeAt(index);
+  bool injail = !job.jail.isEmpty();
+  bool newjail = (job.jail=="--newjail");
+  //Check that this is a valid entry/command (look at the lists in place - no copies)
+  bool valid, installed;
+  if(JAILPKGS.contains(job.jail) && !newjail){
+    valid = !JAILPKGS[job.jail].isEmpty();
+    installed = JAILPKGS[job.jail].contains(job.origin);
+  }else{
+    const NGApp *app = lookupApp(job.origin);
+    valid = (app!=0);
+    installed = (app!=0 && app->isInstalled);
+  }
+  bool skip = false; //need to skip this PENDING entry for some reason
+  if( !valid ){ skip = true; qDebug() << job.origin+":" << "pkg not on repo";} //invalid pkg on the repo
+  else if( job.type==0 && installed && !newjail){ skip = true; qDebug() << job.origin+":"  << "already installed"; } //already installed
+  else if( job.type==1 && !installed ){ skip = true; qDebug() << job.origin+":"  << "already uninstalled"; } //not installed
+  if(skip){
+    qDebug() << "Requested Process Invalid:" << job.origin << job.cmd;
+    emit PBIStatusChange(job.origin);
+    return true; //go on to the next pending job
+  }
+  //Reserve the target now - the pre-commands below process events while they run
+  QString target = job.target();
+  RUNNING.insert(target, job);
+  //Now run any pre-remove commands (if not an in-jail removal, or raw pkg mode)
+  if(job.type==1 && !injail && job.cmd.startsWith("pc-pkg ") ){
+    Extras::getCmdOutput("pbi_icon del-desktop del-menu del-mime "+job.origin); //don't care about result
+  }else if( job.type==0 && injail && RUNNINGJAILS.contains(job.jail) && !newjail){
+    //For installations, make sure the jail pkg config is synced with the current system pkg config
+    qDebug() << "Syncing pkg config in jail:" << job.jail;
+    emit devMessage( "** Syncing pkg config in jail: " +job.jail+" **" );
+    Extras::getCmdOutput("pc-updatemanager -j "+RUNNINGJAILS[job.jail]+" syncconf");
+  }
+  qDebug() << "Starting Process:" << job.origin << job.cmd;
+  PkgJob &run = RUNNING[target];
+  //Set the new status
+  if(run.type==0){ run.status=tr("Starting Installation"); }
+  else if(run.type==1){ run.status=tr("Starting Removal"); }
+  else{ run.status.clear(); }
+  //Each job gets its own process (and pkg event pipe)
+  run.proc = new DLProcess(this);
+    run.proc->setParentWidget(parentWidget);
+    run.proc->setDLType("PKG");
+    connect(run.proc, SIGNAL(UpdateMessage(QString)), this, SLOT(procMessage(QString)) );
+    connect(run.proc, SIGNAL(UpdatePercent(QString,QString,QString)), this, SLOT(procPercent(QString,QString,QString)) );
+    connect(run.proc, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(procFinished(int, QProcess::ExitStatus)) );
+  run.timer.start();
+  emit PBIStatusChange(run.origin);
+  
+  //Now start the command
+  emit devMessage( "** Starting Process: \""+run.cmd+"\" **" );
+  run.proc->start(run.cmd);
+  return true;
+}
+
+QString PBIBackend::findJob(QObject *proc){
+  QHash<QString, PkgJob>::const_iterator it;
+  for(it = RUNNING.constBegin(); it != RUNNING.constEnd(); ++it){
+    if(it.value().proc == proc){ return it.key(); }
+  }
+  return QString::null;
+}
+
+const NGApp* PBIBackend::lookupApp(QString origin){
+  QHash<QString, NGApp>::const_iterator it = APPHASH.constFind(origin);
+  if(it != APPHASH.constEnd()){ return &it.value(); }
+  it = PKGHASH.constFind(origin);
+  if(it != PKGHASH.constEnd()){ return &it.value(); }
+  return 0;
 }
 	
  void PBIBackend::checkForJails(QString jail){
@@ -722,15 +853,13 @@ void PBIBackend::queueProcess(QString origin, bool install, QString injail){
       //qDebug() << "jail:"<<jail<<"ID:" << ID;
       if( !jail.isEmpty() && !ID.isEmpty() ){
         RUNNINGJAILS.insert( jail, ID ); // <name, ID>
-	QHash<QString, NGApp> pkgs = sysDB->JailPkgList(ID);
-        JAILPKGS.insert(jail, pkgs);
+        JAILPKGS.insert(jail, sysDB->JailInstallList(ID));
 	JAILUPD.insert(jail, checkForPkgUpdates(ID) );
       }
     }
   }else{
     //Just update the installed list for the given jail
-    QHash<QString, NGApp> pkgs = sysDB->JailPkgList(RUNNINGJAILS[jail]);
-    JAILPKGS.insert(jail, pkgs);
+    JAILPKGS.insert(jail, sysDB->JailInstallList(RUNNINGJAILS[jail]));
     JAILUPD.insert(jail, checkForPkgUpdates(RUNNINGJAILS[jail]) );
   }
 }
@@ -802,64 +931,18 @@ QString PBIBackend::bytesToPkgSize(double bytes){
  // ===============================
  // Internal Process Management
  void PBIBackend::checkProcesses(){
-   //Check whether to startup the next pending process
-   if( !PKGRUN.isEmpty() || PENDING.isEmpty() ){ return; } //currently running or nothing to do
-
-   //Parse the next PENDING command
-   PKGRUN = PENDING[0].section("::::",0,0);
-   PKGCMD = PENDING[0].section("::::",1,1);
-   PKGJAIL = PENDING[0].section("::::",2,2);
-   PENDING.removeAt(0); //remove this from the pending list
-   if( PKGCMD.startsWith("pbi_add") || PKGCMD.startsWith("pc-pkg install") ){ PROCTYPE = 0; } //install
-   else if( PKGCMD.startsWith("pbi_delete") || PKGCMD.startsWith("pc-pkg remove") ){ PROCTYPE = 1; } //remove
-   else{ PROCTYPE = -1; } //other type of command (no special checks later)
-   
-   PROCCANCELLED = false;
-   PKGRUNSTAT.clear();
-   PROCLOG.clear();
-   bool injail = !PKGJAIL.isEmpty();
-   QHash<QString, NGApp> hash;
-   if(JAILPKGS.contains(PKGJAIL) && PKGJAIL!="--newjail"){ hash = JAILPKGS[PKGJAIL]; }
-   else if(APPHASH.contains(PKGRUN)){ hash = APPHASH; }
-   else if(PKGHASH.contains(PKGRUN)){ hash = PKGHASH; }
-   //Check that this is a valid entry/command
-   bool skip = false; //need to skip this PENDING entry for some reason
-   if( hash.isEmpty() ){ skip = true; qDebug() << PKGRUN+":" << "pkg not on repo";} //invalid pkg on the repo
-   else if( PROCTYPE==0 && hash.value(PKGRUN).isInstalled && PKGJAIL!="--newjail"){ skip = true; qDebug() << PKGRUN+":"  << "already installed"; } //already installed
-   else if( PROCTYPE==1 && !hash.value(PKGRUN).isInstalled ){ skip = true; qDebug() << PKGRUN+":"  << "already uninstalled"; } //not installed
-   if(skip){
-    qDebug() << "Requested Process Invalid:" << PKGRUN << PKGCMD;
-    emit PBIStatusChange(PKGRUN);
-    PKGRUN.clear();
-    PKGCMD.clear();
-    QTimer::singleShot(1,this,SLOT(checkProcesses()) ); //restart this function to check the next command
-    return;
-   }
-   //Now run any pre-remove commands (if not an in-jail removal, or raw pkg mode)
-   if(PROCTYPE==1 && !injail && PKGCMD.startsWith("pc-pkg ") ){
-     Extras::getCmdOutput("pbi_icon del-desktop del-menu del-mime "+PKGRUN); //don't care about result
-   }else if( PROCTYPE==0 && injail && RUNNINGJAILS.contains(PKGJAIL) && PKGJAIL!="--newjail"){
-     //For installations, make sure the jail pkg config is synced with the current system pkg config
-     qDebug() << "Syncing pkg config in jail:" << PKGJAIL;
-     emit devMessage( "** Syncing pkg config in jail: " +PKGJAIL+" **" );
-     Extras::getCmdOutput("pc-updatemanager -j "+RUNNINGJAILS[PKGJAIL]+" syncconf");
-   }
-   qDebug() << "Starting Process:" << PKGRUN << PKGCMD;
-   //Set the new status
-   if(PROCTYPE==0){ PKGRUNSTAT=tr("Starting Installation"); }
-   else if(PROCTYPE==1){ PKGRUNSTAT=tr("Starting Removal"); }
-   else{ PKGRUNSTAT.clear(); }
-   emit PBIStatusChange(PKGRUN);
-   
-   //Now start the command
-   emit devMessage( "** Starting Process: \""+PKGCMD+"\" **" );
-   pkgProc->start(PKGCMD);
-
+   //Wait for any catalog load to finish - the pending jobs are validated against the installed state
+   if(syncRunning){ return; } //slotCatalogReady() checks again
+   //Start as many pending processes as possible (one per jail/host pkg database)
+   while( startNextJob() ){}
 }
  
 void PBIBackend::procMessage(QString msg){
+  QString target = findJob(sender());
+  if(target.isNull()){ return; }
+  PkgJob &job = RUNNING[target];
   //qDebug() << "MSG:" << msg;
-  PROCLOG << msg;   //save full message to the log for later
+  job.log << msg;   //save full message to the log for later
   QString tmp;
   //Do some quick parsing of the message for better messages
   if(msg.startsWith("[")){
@@ -867,72 +950,76 @@ void PBIBackend::procMessage(QString msg){
     tmp = msg.section("]",0,0).remove("[").simplified();
     double percent = tmp.section("/",0,0).toDouble()/tmp.section("/",-1).toDouble();
     percent = percent*100;
-    if(PROCTYPE==0){
+    if(job.type==0){
       tmp = QString(tr("Installing: %1")).arg(QString::number( (int) percent )+"%");
-    }else if(PROCTYPE==1){
+    }else if(job.type==1){
       tmp = QString(tr("Removing: %1")).arg(QString::number( (int) percent )+"%");
     }
   }
   if(!tmp.isEmpty()){
-    PKGRUNSTAT = tmp; //set this as the current status (might want to do some parsing/translation later)
-    emit PBIStatusChange(PKGRUN);
+    job.status = tmp; //set this as the current status (might want to do some parsing/translation later)
+    emit PBIStatusChange(job.origin);
   }
   emit devMessage(msg);
 }
 
 void PBIBackend::procPercent(QString percent, QString size, QString filename){ //percent, file size, filename
-  PKGRUNSTAT = QString( tr("Downloading %1 (%2% of %3)")).arg(filename, percent, size);
-  qDebug() << "MSG:" << PKGRUNSTAT;
+  QString target = findJob(sender());
+  if(target.isNull()){ return; }
+  PkgJob &job = RUNNING[target];
+  job.status = QString( tr("Downloading %1 (%2% of %3)")).arg(filename, percent, size);
+  qDebug() << "MSG:" << job.status;
   //don't save this to the log - can get tons of these types of messages for every percent update
-  emit PBIStatusChange(PKGRUN);
+  emit PBIStatusChange(job.origin);
 }
 
 void PBIBackend::procFinished(int ret, QProcess::ExitStatus stat){
-  emit devMessage("** Process Finished **");
+  QString target = findJob(sender());
+  if(target.isNull()){ return; }
+  PkgJob job = RUNNING.take(target);
+  job.proc->deleteLater();
+  emit devMessage(QString("** Process Finished (%1 seconds) **").arg(QString::number(job.timer.elapsed()/1000.0, 'f', 1)) );
+  QString name = singleAppInfo(job.origin).name;
   if(stat != QProcess::NormalExit){
     //Process Crashed
-    emit Error(tr("Process Crashed"), QString(tr("The process for %1 has quit unexpectedly. Please restart this operation at a later time.")).arg(PKGRUN), PROCLOG);
+    emit Error(tr("Process Crashed"), QString(tr("The process for %1 has quit unexpectedly. Please restart this operation at a later time.")).arg(job.origin), job.log);
   }else if( ret != 0 ){
     //Failure
     QString title, msg;
-      if(PROCTYPE==0){ 
+      if(job.type==0){ 
 	title = tr("Installation Failure"); 
-	msg = QString(tr("The following application installation experienced an error: %1")+"\n\n"+tr("Please try again later.")).arg(APPHASH[PKGRUN].name);
-      }else if(PROCTYPE==1){ 
+	msg = QString(tr("The following application installation experienced an error: %1")+"\n\n"+tr("Please try again later.")).arg(name);
+      }else if(job.type==1){ 
 	title = tr("Removal Failure"); 
-	msg = QString(tr("The following application removal experienced an error: %1")+"\n\n"+tr("Please try again later.")).arg(APPHASH[PKGRUN].name);
+	msg = QString(tr("The following application removal experienced an error: %1")+"\n\n"+tr("Please try again later.")).arg(name);
       }
-      if(!msg.isEmpty()){ emit Error(title, msg, PROCLOG); }
+      if(!msg.isEmpty()){ emit Error(title, msg, job.log); }
   }else{
     //Success - perform any cleanup operations
-    if(PROCTYPE==0 && PKGCMD.contains("pbi_") && !PROCCANCELLED && PKGJAIL.isEmpty()){ //if new installation on main system
-      Extras::getCmdOutput("pbi_icon add-menu add-mime "+PKGRUN); //don't care about result
-      if(autoDE && APPHASH[PKGRUN].hasDE){ runCmdAsUser("pbi_icon add-desktop "+PKGRUN); }
-    }else if(PROCTYPE==0 && PKGCMD.contains("pc-pkg ") && !PROCCANCELLED && PKGJAIL.isEmpty()){
+    if(job.type==0 && job.cmd.contains("pbi_") && !job.cancelled && job.jail.isEmpty()){ //if new installation on main system
+      Extras::getCmdOutput("pbi_icon add-menu add-mime "+job.origin); //don't care about result
+      if(autoDE && singleAppInfo(job.origin).hasDE){ runCmdAsUser("pbi_icon add-desktop "+job.origin); }
+    }else if(job.type==0 && job.cmd.contains("pc-pkg ") && !job.cancelled && job.jail.isEmpty()){
       Extras::getCmdOutput("pc-extractoverlay ports"); //make sure to extract the ports overlay after a pkg operation
     }
 	  
   }
   //Now clean up the process variables and update the app status
-  if(PKGJAIL.isEmpty()){
-    //update the local system info
-    slotSyncToDatabase(true);
-  }else if(PKGJAIL=="--newjail"){
+  if(job.jail.isEmpty()){
+    //update the local system info (just the installed pkgs - the repo info is the same)
+    syncInstalledState();
+  }else if(job.jail=="--newjail"){
     //Find the new jail
     checkForJails();
     emit JailListChanged();
   }else{
     //Just update the pkg list for this particular jail
-    checkForJails(PKGJAIL);
+    checkForJails(job.jail);
   }
-  QString origin = PKGRUN; //temporary
-  PKGCMD.clear();
-  PKGRUN.clear();
-  PKGJAIL.clear();
   //Emit the proper signals
-  emit PBIStatusChange(origin);
+  emit PBIStatusChange(job.origin);
   emit LocalPBIChanges(); //so that it knows to look for a different install list
-  //Now check for the next command to run
+  //Now check for the next command to run (held until the installed state above is loaded)
   QTimer::singleShot(1, this, SLOT(checkProcesses()) );
 }
 	
@@ -940,31 +1027,48 @@ void PBIBackend::procFinished(int ret, QProcess::ExitStatus stat){
  // === Database Synchronization ===
  void PBIBackend::slotSyncToDatabase(bool localChanges, bool all){
    qDebug() << "Sync Database with local changes:" << localChanges;
+   if(syncRunning){
+     //Only one load at a time - run this one as soon as the current one is done
+     syncQueued = qMax(syncQueued, all ? 2 : 1);
+     return;
+   }
+   syncRunning = true;
    updateSplashScreen(tr("Loading Database"));
-   sysDB->syncDBInfo("", localChanges, all);
-   PKGHASH.clear();
-   APPHASH.clear();
-   CATHASH.clear();
+   emit requestCatalog(localChanges, all); //the UI keeps using the current catalog meanwhile
+}
+
+void PBIBackend::syncInstalledState(){
+  if(syncRunning){ syncQueued = qMax(syncQueued, 0); return; }
+  syncRunning = true;
+  emit requestInstalled();
+}
+
+void PBIBackend::slotCatalogReady(NGCatalog cat){
+   syncRunning = false;
    bool firstrun = false;
-   if(RECLIST.isEmpty() || all){
-     sysDB->getAppCafeHomeInfo( &NEWLIST, &HIGHLIST, &RECLIST);
-     firstrun = true;
-   }
-   //qDebug() << "Load APPHASH";
-   PKGHASH = sysDB->DetailedPkgList(); // load the pkg info
-   APPHASH = sysDB->DetailedAppList(); // load the pbi info
-   CATHASH = sysDB->Categories(); // load all the different categories info
-   if(BASELIST.isEmpty() || all){
-      //populate the list of base dependencies that cannot be removed
-      BASELIST = listDependencies("misc/pcbsd-base");
-      BASELIST.prepend("misc/pcbsd-base");
-      BASELIST.removeDuplicates();
-      firstrun = true;
-      //qDebug() << "Base:" << BASELIST;
+   if(cat.installedOnly){
+     applyInstalledChanges(cat.PKGINSTALLED);
+     sysDB->setCatalog(cat);
+   }else{
+     //Swap in the complete new catalog all at once
+     sysDB->setCatalog(cat);
+     PKGHASH = cat.PKGLIST; // the pkg info
+     APPHASH = cat.PBIAVAIL; // the pbi info
+     CATHASH = cat.CATAVAIL; // all the different categories info
+     NEWLIST = cat.NEWLIST; HIGHLIST = cat.HIGHLIST; RECLIST = cat.RECLIST;
+     buildTagIndex();
+     if(BASELIST.isEmpty() || cat.reloadAll){
+        //populate the list of base dependencies that cannot be removed
+        BASELIST = listDependencies("misc/pcbsd-base");
+        BASELIST.prepend("misc/pcbsd-base");
+        BASELIST.removeDuplicates();
+        firstrun = true;
+        //qDebug() << "Base:" << BASELIST;
+     }
+     if(RUNNINGJAILS.isEmpty() || cat.reloadAll){ checkForJails(); }
    }
-   updavail = checkForPkgUpdates("");
+   updavail = cat.updavail;
    //if(updavail){ qDebug() << "After sync: updates available"; }
-   if(RUNNINGJAILS.isEmpty() || all){ checkForJails(); }
    //qDebug() << "Update Stats";
    updateStatistics();
    //qDebug() << "Emit result";
@@ -975,8 +1079,85 @@ void PBIBackend::procFinished(int ret, QProcess::ExitStatus stat){
    }else{
      emit RepositoryInfoUpdated();
    }
+   //Now start any sync which was requested during this one
+   if(syncQueued==0){ syncQueued = -1; syncInstalledState(); }
+   else if(syncQueued>0){ bool all = (syncQueued==2); syncQueued = -1; slotSyncToDatabase(true, all); }
+   //Start any pending jobs which were held for this load
+   QTimer::singleShot(0, this, SLOT(checkProcesses()) );
+}
+
+void PBIBackend::applyInstalledChanges(const QHash<QString, NGApp> &installed){
+  //Only update the entries where the installed state is different
+  QStringList changed;
+  QHash<QString, NGApp>::const_iterator it;
+  for(it = installed.constBegin(); it != installed.constEnd(); ++it){
+    QHash<QString, NGApp>::const_iterator old = PKGHASH.constFind(it.key());
+    if( old==PKGHASH.constEnd() || !old.value().isInstalled || old.value().installedversion!=it.value().installedversion
+	|| old.value().isLocked!=it.value().isLocked || old.value().isOrphan!=it.value().isOrphan
+	|| old.value().rdependency!=it.value().rdependency ){ changed << it.key(); }
+  }
+  for(it = PKGHASH.constBegin(); it != PKGHASH.constEnd(); ++it){
+    if( it.value().isInstalled && !installed.contains(it.key()) ){ changed << it.key(); }
+  }
+  //PBIs which require one of the changed pkgs need their status re-checked too
+  QStringList apps;
+  QHash<QString, NGApp>::const_iterator ait;
+  for(ait = APPHASH.constBegin(); ait != APPHASH.constEnd(); ++ait){
+    if(changed.contains(ait.key())){ apps << ait.key(); continue; }
+    for(int i=0; i<ait.value().needsPkgs.length(); i++){
+      if(changed.contains(ait.value().needsPkgs[i])){ apps << ait.key(); break; }
+    }
+  }
+  for(int i=0; i<changed.length(); i++){
+    QString origin = changed[i];
+    NGApp inst; //empty if no longer installed
+    if(installed.contains(origin)){ inst = installed[origin]; }
+    if(inst.isInstalled){
+      PKGHASH.insert(origin, inst);
+    }else if(PKGHASH[origin].version.isEmpty()){
+      PKGHASH.remove(origin); //was only known because it was installed (not on the repo)
+    }
+    if(!inst.isInstalled && PKGHASH.contains(origin)){
+      PBIDBAccess::setInstallInfo(&PKGHASH[origin], 0);
+    }
+  }
+  for(int i=0; i<apps.length(); i++){
+    NGApp &app = APPHASH[apps[i]];
+    NGApp inst; //empty if no longer installed
+    if(installed.contains(apps[i])){ inst = installed[apps[i]]; }
+      app.isInstalled = inst.isInstalled;
+      app.isLocked = inst.isLocked;
+      app.isOrphan = inst.isOrphan;
+      app.installedversion = inst.installedversion;
+      app.installedsize = inst.installedsize;
+      app.installedwhen = inst.installedwhen;
+      app.installedarch = inst.installedarch;
+      app.rdependency = inst.rdependency;
+    //A PBI is only installed if all the additional pkgs it needs are installed as well
+    for(int p=0; p<app.needsPkgs.length() && app.isInstalled; p++){
+      if( !installed.contains(app.needsPkgs[p]) ){ app.isInstalled = false; }
+    }
+  }
 }
  
+void PBIBackend::buildTagIndex(){
+  //Invert the tag lists of the apps/pkgs: <tag, list of origins>
+  APPTAGS.clear();
+  PKGTAGS.clear();
+  QHash<QString, NGApp>::const_iterator it;
+  for(it = APPHASH.constBegin(); it != APPHASH.constEnd(); ++it){
+    QStringList tags = it.value().tags;
+    tags.removeDuplicates();
+    for(int i=0; i<tags.length(); i++){ APPTAGS[tags[i]] << it.key(); }
+  }
+  for(it = PKGHASH.constBegin(); it != PKGHASH.constEnd(); ++it){
+    //PBI tags take priority for pkgs which are also apps
+    QStringList tags = APPHASH.contains(it.key()) ? APPHASH[it.key()].tags : it.value().tags;
+    tags.removeDuplicates();
+    for(int i=0; i<tags.length(); i++){ PKGTAGS[tags[i]] << it.key(); }
+  }
+}
+
 void PBIBackend::updateStatistics(){
   QStringList avail = APPHASH.keys();
     appAvailable = avail.length();
@@ -986,10 +1167,7 @@ void PBIBackend::updateStatistics(){
 
 bool PBIBackend::checkForPkgUpdates(QString jailID){
   //Run pc-updatemanager pkgcheck to check for updates
-  QString out;
-  if(jailID.isEmpty()){ out  = sysDB->runCMD("pc-updatemanager pkgcheck"); }
-  else{ out = sysDB->runCMD("pc-updatemanager -j "+jailID+" pkgcheck"); }
-  return (!out.contains("All packages are up to date!") && out.contains("To start the upgrade run ") );
+  return sysDB->pkgUpdatesAvailable(jailID);
 }
 
 void PBIBackend::updateSplashScreen(QString msg){
@@ -11,6 +11,10 @@
 #include <QString>
 #include <QStringList>
 #include <QHash>
+#include <QPair>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <functional>
 #include <QTimer>
 #include <QFile>
 #include <QDir>
@@ -19,6 +23,8 @@
 #include <QMessageBox>
 #include <QProcess>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
 
 // libPCBSD includes
 #include <pcbsd-DLProcess.h>
@@ -27,6 +33,25 @@
 // Local includes
 #include "extras.h"
 #include "pbiDBAccess.h"
+#include "pbiDBWorker.h"
+
+// Single queued/running pkg operation
+class PkgJob{
+  public:
+	QString origin, cmd;
+	QString jail; //jail name ("" for the host, "--newjail" to create a new jail)
+	int type; //[0=install, 1=remove, -1=other]
+	QString status; //current status (for the UI)
+	QStringList log; //full process output
+	bool cancelled; //a reverse operation was already queued
+	QElapsedTimer timer; //time since the job was started
+	DLProcess *proc;
+
+	PkgJob(){ type=-1; cancelled=false; proc=0; }
+	~PkgJob(){}
+	//pkg database this job works on - only one job at a time per database
+	QString target() const{ return (jail=="--newjail") ? QString("") : jail; }
+};
 
 class PBIBackend : public QObject{
 	Q_OBJECT
@@ -116,10 +141,19 @@ private:
 	QSplashScreen *Splash; //only used during initial sync
 	//variables - database
 	PBIDBAccess *sysDB;
+	QThread *dbThread;
+	PBIDBWorker *dbWorker; //loads new catalogs within dbThread
+	bool syncRunning; //catalog load in progress
+	int syncQueued; //sync requested during a load (-1: none, 0: installed list, 1: local, 2: all)
+	void syncInstalledState(); //quick sync of just the installed pkgs
+	void applyInstalledChanges(const QHash<QString, NGApp> &installed);
 	QHash<QString, NGCat> CATHASH;
 	QHash<QString, NGApp> APPHASH;
 	QHash<QString, NGApp> PKGHASH;
 	QStringList RECLIST, HIGHLIST, NEWLIST, BASELIST;
+	//Tag index for similarity searches <tag, origins with that tag>
+	QHash<QString, QStringList> APPTAGS, PKGTAGS;
+	void buildTagIndex();
 
 	//General values
 	QString sysArch; //system architecture
@@ -128,21 +162,17 @@ private:
 	bool updavail; //updates available
 	
 	//All the Process queing/interaction
-	DLProcess *pkgProc;
-	QStringList PENDING;
-	QString PKGRUN; //origin for the currently-running process
-	QString PKGCMD; //Currently running command
-	QString PKGJAIL; //
-	QString PKGRUNSTAT; //string for the running process stat
-	QStringList PROCLOG;
-	int PROCTYPE; //The type of process that is running [0=install, 1=remove, -1=other]
-	bool PROCCANCELLED; //the process was already cancelled
+	QList<PkgJob> PENDING;
+	QHash<QString, PkgJob> RUNNING; // <target (jail name or "" for host), running job>
 	
 	void queueProcess(QString origin, bool install, QString injail="");
+	bool startNextJob(); //start the first pending job whose target is free
+	QString findJob(QObject *proc); //target of the job run by the given process
+	const NGApp* lookupApp(QString origin); //host info, no copies - NULL if not found
 	
 	//Jail interaction/translation
 	QHash<QString, QString> RUNNINGJAILS; // <name, ID>
-	QHash<QString, QHash<QString, NGApp> > JAILPKGS; // <name, hash of pkg details>
+	QHash<QString, QHash<QString, NGInstallInfo> > JAILPKGS; // <name, installed state of each pkg> (repo info comes from APPHASH/PKGHASH)
 	QHash<QString, bool> JAILUPD; // <name, updates available>
 	void checkForJails(QString jailID=""); //parses the "jls" command to get name/JID combinations
 	
@@ -159,6 +189,7 @@ private slots:
 
 	// Database sync
 	void slotSyncToDatabase(bool localChanges=false, bool all = false);
+	void slotCatalogReady(NGCatalog cat); //swap in the newly loaded catalog
 	void updateStatistics(); //number available/installed
 	bool checkForPkgUpdates(QString jailID = "");
 	void updateSplashScreen(QString);
@@ -178,6 +209,9 @@ signals:
 	void SizeFound(QString); //Size of the app for display
 	//Process Messages (developer mode)
 	void devMessage(QString);
+	//Catalog loading (handled by the worker thread)
+	void requestCatalog(bool localreload, bool allreload);
+	void requestInstalled();
 
 };
 
@@ -14,6 +14,7 @@ HEADERS	+= mainUI.h \
     	  pbiNgBackend.h \
     	  extras.h \
     	  pbiDBAccess.h \
+    	  pbiDBWorker.h \
 	  updateDialog.h \
 	  configDialog.h \
 	  ssDialog.h
@@ -23,6 +24,7 @@ SOURCES	+= main.cpp \
 	 migrateUI.cpp \
          pbiNgBackend.cpp \
          pbiDBAccess.cpp \
+         pbiDBWorker.cpp \
 	 updateDialog.cpp \
 	 configDialog.cpp \
 	 ssDialog.cpp
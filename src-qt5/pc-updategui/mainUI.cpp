@@ -27,6 +27,9 @@ MainUI::MainUI() : QMainWindow(), ui(new Ui::MainUI()){
   connect(ui->combo_autosetting, SIGNAL(currentIndexChanged(int)), this, SLOT(autoUpChange()) );
   connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(watcherChange(QString)) );
   connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(watcherChange(QString)) );
+  connect(logFollower, SIGNAL(reset(QString)), this, SLOT(updateLogReset(QString)) );
+  connect(logFollower, SIGNAL(appended(QString)), this, SLOT(updateLogAppended(QString)) );
+  logFollower->start(); //Read the current state of the log file
 }
 
 MainUI::~MainUI(){
@@ -39,10 +42,12 @@ void MainUI::slotSingleInstance(){
 }
 
 void MainUI::InitUI(){ //initialize the UI (widgets, options, menus, current values)
-  //Initialize the log file watcher
+  //Initialize the system flag watcher
   watcher = new QFileSystemWatcher(this);
-    watcher->addPath(UPDATE_LOG_FILE);
     watcher->addPath("/tmp/.pcbsdflags");
+  //The log file only has new lines appended to the view (keep a limited scrollback)
+  logFollower = new LogFollower(UPDATE_LOG_FILE, UPDATE_LOG_FILE_PREVIOUS, this);
+  ui->text_log->setMaximumBlockCount(UPDATE_LOG_MAX_LINES);
 	
   ui->label_sysinfo->setText("");
   ui->tabWidget->setCurrentIndex(0); 
@@ -68,9 +73,6 @@ void MainUI::InitUI(){ //initialize the UI (widgets, options, menus, current val
   //Make sure the details are hidden to start with
   ui->group_details->setChecked(false);
     updateDetailsChange();
-  //Read the current state of the log file
-  QString log = pcbsd::Utils::readTextFile(UPDATE_LOG_FILE);
-  ui->text_log->setPlainText(log);
   this->setEnabled(false);
   //Now update the UI based on current system status
   UpdateUI();
@@ -91,12 +93,8 @@ void MainUI::ShowUpdatingNotice(){
   QProcess::startDetached("syscache startsync"); //re-sync the database now as well	
 }
 
-void MainUI::watcherChange(QString change){
-  if(change==UPDATE_LOG_FILE){ 
-    updateLogChanged();
-    //Make sure the log file was not removed from the watcher for some reason
-    if( !watcher->files().contains(UPDATE_LOG_FILE) ){ watcher->addPath(UPDATE_LOG_FILE); }
-  }else{ UpdateUI(); }
+void MainUI::watcherChange(QString){
+  UpdateUI();
 }
 
 void MainUI::UpdateUI(){ //refresh the entire UI , and system status structure
@@ -129,11 +127,6 @@ void MainUI::UpdateUI(){ //refresh the entire UI , and system status structure
   bool haspatch = (info[4]=="true");
   bool haspkg = (info[5]=="true");
   
-  //Now make sure that the log file is being watched (in case it did not exist earlier)
-  if(watcher->files().isEmpty()){
-    watcher->addPath(UPDATE_LOG_FILE);
-  }
-  
   //Now Change the UI around based on the current status
   //int cindex = ui->tabWidget->currentIndex();
   // - First remove the special tabs from the tabWidget (add them as needed)
@@ -297,23 +290,19 @@ void MainUI::startPatches(){
 }
 
 //Log tab
-void MainUI::updateLogChanged(){ //this is connected to a file watcher for changes
-  //Check that the tab is visible(don't want to constantly be reading the file if not visible)
-  if(ui->tabWidget->currentWidget()==ui->tab_log){
-    QString log = pcbsd::Utils::readTextFile(UPDATE_LOG_FILE);
-    if(log.isEmpty()){ log = pcbsd::Utils::readTextFile(UPDATE_LOG_FILE_PREVIOUS); }
-    if(log.isEmpty()){ log = tr("No update logs available"); }
-    //QString clog = ui->text_log->toPlainText();
-    //if(clog.length() > log.length() || clog.isEmpty() ){
-      //Completely different log than before - reset the entire view
-      ui->text_log->setPlainText(log);
-    //}else{
-      //New info to the same log - just append the difference
-      //ui->text_log->appendPlainText( log.remove(clog) );
-    //}
-    //Keep it at the bottom (the latest info)
-    ui->text_log->verticalScrollBar()->setSliderPosition( ui->text_log->verticalScrollBar()->maximum() );
-  }
+void MainUI::updateLogReset(QString log){
+  if(log.isEmpty()){ log = tr("No update logs available"); }
+  ui->text_log->setPlainText(log);
+  //Keep it at the bottom (the latest info)
+  ui->text_log->verticalScrollBar()->setSliderPosition( ui->text_log->verticalScrollBar()->maximum() );
+}
+
+void MainUI::updateLogAppended(QString lines){
+  //Only follow the new text if the view was already at the bottom (the user might be reading back)
+  QScrollBar *bar = ui->text_log->verticalScrollBar();
+  bool atEnd = (bar->sliderPosition() == bar->maximum());
+  ui->text_log->appendPlainText(lines);
+  if(atEnd){ bar->setSliderPosition( bar->maximum() ); }
 }
 
 //Configure tab
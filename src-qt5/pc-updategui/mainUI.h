@@ -7,10 +7,12 @@
 #include <QFileSystemWatcher>
 
 #include <pcbsd-utils.h>
+#include <pcbsd-logfollower.h>
 
 #define UPDATE_LOG_FILE QString("/var/log/pc-updatemanager.log")
 #define UPDATE_LOG_FILE_AUTO QString("/var/log/pc-updatemanager-auto.log")
 #define UPDATE_LOG_FILE_PREVIOUS QString("/var/log/pc-updatemanager.log.prev")
+#define UPDATE_LOG_MAX_LINES 20000
 
 namespace Ui{
 	class MainUI;
@@ -28,6 +30,7 @@ public slots:
 private:
 	Ui::MainUI *ui;
 	QFileSystemWatcher *watcher;
+	LogFollower *logFollower;
 
 	void InitUI(); //initialize the UI (widgets, options, menus, current values)
 	
@@ -51,7 +54,8 @@ private slots:
 	void patchSelChange(); //patch selection changed
 	void startPatches(); //Start installing the selected patches
 	//Log tab
-	void updateLogChanged(); //this is connected to a file watcher for changes
+	void updateLogReset(QString); //the log file was (re)loaded
+	void updateLogAppended(QString); //new lines were written to the log file
 	//Configure tab
 	void autoUpChange(); //auto-update option changed
 
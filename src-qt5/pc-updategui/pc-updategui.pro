@@ -9,12 +9,14 @@ INCLUDEPATH	+= ../libpcbsd/utils ../libpcbsd/ui /usr/local/include
 
 HEADERS	+= mainUI.h \ 
     pkgVulDialog.h \
+    pkgAuditParser.h \
     updHistoryDialog.h \
     eolDialog.h \
     branchesDialog.h
 
 SOURCES	+= main.cpp mainUI.cpp \ 
     pkgVulDialog.cpp \
+    pkgAuditParser.cpp \
     updHistoryDialog.cpp \
     eolDialog.cpp \
     branchesDialog.cpp
@@ -0,0 +1,99 @@
+/**************************************************************************
+*   Copyright (C) 2015- by Yuri Momotyuk                                   *
+*   yurkis@gmail.com                                                      *
+*                                                                         *
+*   Permission is hereby granted, free of charge, to any person obtaining *
+*   a copy of this software and associated documentation files (the       *
+*   "Software"), to deal in the Software without restriction, including   *
+*   without limitation the rights to use, copy, modify, merge, publish,   *
+*   distribute, sublicense, and/or sell copies of the Software, and to    *
+*   permit persons to whom the Software is furnished to do so, subject to *
+*   the following conditions:                                             *
+*                                                                         *
+*   The above copyright notice and this permission notice shall be        *
+*   included in all copies or substantial portions of the Software.       *
+*                                                                         *
+*   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+*   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+*   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*
+*   IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR     *
+*   OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, *
+*   ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR *
+*   OTHER DEALINGS IN THE SOFTWARE.                                       *
+***************************************************************************/
+
+#include "pkgAuditParser.h"
+
+///////////////////////////////////////////////////////////////////////////////
+PkgAuditParser::PkgAuditParser()
+{
+    mIsMessage = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PkgAuditParser::reset()
+{
+    mEntry = SVulInfo();
+    mIsMessage = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Parse one line of "pkg audit" output, returns true when an entry was
+// completed and added to "out"
+bool PkgAuditParser::parseLine(QString line, QVector<SVulInfo>& out)
+{
+    //Empty line - end of package entry
+    if (!line.length())
+    {
+        bool added = false;
+        if (mEntry.mPkgGenericName.length())
+        {
+            out.push_back(mEntry);
+            added = true;
+        }
+        mEntry = SVulInfo();
+        mIsMessage = false;
+        return added;
+    }//if empty line
+
+    /*Example:
+     *  chromium-40.0.2214.93 is vulnerable:
+     */
+    if (line.indexOf("is vulnerable:") >= 0)
+    {
+        mEntry.mPkgGenericName = line.split(" ")[0];
+        int idx= mEntry.mPkgGenericName.lastIndexOf("-");
+        mEntry.mPkgName= mEntry.mPkgGenericName.left(idx);
+        mEntry.mPkgVersion = mEntry.mPkgGenericName.mid(idx + 1);
+        mIsMessage = true;
+        return false;
+    }//package name
+
+    /* Example:
+     * CVE: CVE-2015-1212
+     */
+    if (line.startsWith("CVE: "))
+    {
+        mIsMessage = false;
+        mEntry.mCVEList.append(line.replace("CVE: ",""));
+        return false;
+    }
+
+    /* Example:
+     * WWW: http://vuxml.FreeBSD.org/freebsd/a6eb239f-adbe-11e4-9fce-080027593b9a.html
+     */
+    if (line.startsWith("WWW: "))
+    {
+        mIsMessage = false;
+        mEntry.mWWW = line.replace("WWW: ","");
+        return false;
+    }
+
+    if (mIsMessage)
+    {
+        if (mEntry.mMessage.length())
+            mEntry.mMessage+="\n";
+        mEntry.mMessage+=line;
+    }
+    return false;
+}
@@ -0,0 +1,32 @@
+#ifndef PKGAUDITPARSER_H
+#define PKGAUDITPARSER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Line by line parser for the output of "pkg audit"
+class PkgAuditParser
+{
+public:
+    typedef struct _SVulInfo
+    {
+        QString mPkgGenericName;
+        QString mPkgName;
+        QString mPkgVersion;
+        QString mMessage;
+        QStringList mCVEList;
+        QString mWWW;
+    }SVulInfo;
+
+    PkgAuditParser();
+
+    void reset();   //drop the entry being parsed (start of a new output)
+    bool parseLine(QString line, QVector<SVulInfo>& out);
+
+private:
+    SVulInfo mEntry;    //entry being parsed at the moment
+    bool mIsMessage;
+};
+
+#endif // PKGAUDITPARSER_H
@@ -29,11 +29,20 @@
 
 #include <QDebug>
 #include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
 #include <QUrl>
 #include <QPoint>
 
 using namespace pcbsd;
 
+//The audit results stay valid until the vulnerability database or the installed packages change
+#define AUDIT_DB_FILE QString("/var/db/pkg/vuln.xml")
+#define PKG_DB_FILE QString("/var/db/pkg/local.sqlite")
+#define AUDIT_CACHE_FILE QString(QDir::homePath()+"/.cache/pc-updategui/pkg-audit")
+
 static bool wasFetch = false;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -46,97 +55,121 @@ PkgVulDialog::PkgVulDialog(QWidget *parent) :
     //Ensure it is centered on the parent
     QPoint ctr = parent->geometry().center();
     this->move( ctr.x()-(this->width()/2), ctr.y()-(this->height()/2) );
-    QApplication::processEvents();
+    mShowingCache = false;
+    mAuditProc = new QProcess(this);
+    connect(mAuditProc, SIGNAL(readyReadStandardOutput()), this, SLOT(auditOutput()));
+    connect(mAuditProc, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(auditFinished()));
+    connect(mAuditProc, SIGNAL(error(QProcess::ProcessError)), this, SLOT(auditError(QProcess::ProcessError)));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 PkgVulDialog::~PkgVulDialog()
 {
+    if (mAuditProc->state() != QProcess::NotRunning)
+    {
+        mAuditProc->kill();
+        mAuditProc->waitForFinished(1000);
+    }
     delete ui;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void PkgVulDialog::beginAudit()
 {
-    mVulVector.clear();
-    QApplication::processEvents();
-    QString cmd = "pkg audit";
-    if (!wasFetch)
+    mAuditVector.clear();
+    mAuditOutput.clear();
+    mAuditBuffer.clear();
+    mParser.reset();
+    //Results of an earlier audit are replaced as the new ones are parsed (cached ones stay until the end)
+    if (!mShowingCache)
     {
-        cmd+=" -F";
+        mVulVector.clear();
+        ui->vulList->clear();
     }
 
-    QStringList out = Utils::runShellCommand(cmd);
-
-    SVulInfo entry;
-    QString line;
-    bool isMessage = false;
+    QStringList args;
+    args<<"audit";
+    if (!wasFetch)
+    {
+        args<<"-F";
+    }
+    mAuditProc->start("pkg", args);
+}
 
-    for (int i=0; i<out.size(); i++)
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::auditOutput()
+{
+    mAuditBuffer += mAuditProc->readAllStandardOutput();
+    int idx;
+    while ((idx = mAuditBuffer.indexOf('\n')) >= 0)
     {
-        line = out[i];
-        //Empty line - end of package entry
-        if (!line.length())
-        {
-            if (entry.mPkgGenericName.length())
-            {
-                /*qDebug()<<"Found vulnerable package ===========";
-                qDebug()<<entry.mPkgGenericName;
-                qDebug()<<entry.mPkgName;
-                qDebug()<<entry.mPkgVersion;
-                qDebug()<<entry.mCVEList;
-                qDebug()<<entry.mWWW;
-                qDebug()<<entry.mMessage;
-                qDebug()<<".....................";*/
-
-                mVulVector.push_back(entry);
-            }
-            entry = SVulInfo();
-            continue;
-        }//if empty line
-
-        /*Example:
-         *  chromium-40.0.2214.93 is vulnerable:
-         */
-        if (line.indexOf("is vulnerable:") >= 0)
-        {
-            entry.mPkgGenericName = line.split(" ")[0];
-            int idx= entry.mPkgGenericName.lastIndexOf("-");
-            entry.mPkgName= entry.mPkgGenericName.left(idx);
-            entry.mPkgVersion = entry.mPkgGenericName.mid(idx + 1);
-            isMessage = true;
+        QString line = QString::fromUtf8(mAuditBuffer.left(idx));
+        mAuditBuffer.remove(0, idx + 1);
+        mAuditOutput.append(line);
+        if (!mParser.parseLine(line, mAuditVector) || mShowingCache)
             continue;
-        }//package name
+        //Show each vulnerable package as soon as it is parsed
+        mVulVector.push_back(mAuditVector.last());
+        addItem(mVulVector.size() - 1);
+        if (mVulVector.size() == 1)
+            showResults();
+    }
+}
 
-        /* Example:
-         * CVE: CVE-2015-1212
-         */
-        if (line.startsWith("CVE: "))
-        {
-            isMessage = false;
-            entry.mCVEList.append(line.replace("CVE: ",""));
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::auditFinished()
+{
+    //Finish the last line/entry if the output did not end with an empty line
+    auditOutput();
+    if (mAuditBuffer.length())
+    {
+        mAuditOutput.append(QString::fromUtf8(mAuditBuffer));
+        mParser.parseLine(QString::fromUtf8(mAuditBuffer), mAuditVector);
+        mAuditBuffer.clear();
+    }
+    mParser.parseLine(QString(), mAuditVector);
 
-            continue;
-        }
-
-        /* Example:
-         * WWW: http://vuxml.FreeBSD.org/freebsd/a6eb239f-adbe-11e4-9fce-080027593b9a.html
-         */
-        if (line.startsWith("WWW: "))
-        {
-            isMessage = false;
-            entry.mWWW = line.replace("WWW: ","");
-            continue;
-        }
+    //pkg audit exits with 1 if vulnerable packages were found
+    bool ok = (mAuditProc->exitStatus() == QProcess::NormalExit && mAuditProc->exitCode() <= 1);
+    if (!ok)
+    {
+        QString err = QString::fromUtf8(mAuditProc->readAllStandardError()).trimmed();
+        qDebug() << "pkg audit failed:" << err;
+        if (!mShowingCache)
+            showError(err);
+        return;
+    }
+    wasFetch = true;
+
+    if (!mShowingCache || mAuditOutput != mCacheOutput)
+    {
+        mVulVector = mAuditVector;
+        fillUI();
+    }
+    mShowingCache = false;
+    showResults();
+    saveCache();
+}
 
-        if (isMessage)
-        {
-            if (entry.mMessage.length())
-                entry.mMessage+="\n";
-            entry.mMessage+=line;
-        }
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::auditError(QProcess::ProcessError error)
+{
+    //Other errors are followed by finished() and handled there
+    if (error != QProcess::FailedToStart)
+        return;
+    qDebug() << "pkg audit could not be started:" << mAuditProc->errorString();
+    if (!mShowingCache)
+        showError(mAuditProc->errorString());
+}
 
-    }//for all lines
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::addItem(int idx)
+{
+    QStringList strs;
+    strs<<mVulVector[idx].mPkgName<<mVulVector[idx].mPkgVersion<<mVulVector[idx].mMessage;
+    QTreeWidgetItem* item = new QTreeWidgetItem(ui->vulList,strs);
+    item->setData(0, Qt::UserRole, QVariant(idx));
+    ui->vulList->addTopLevelItem(item);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -145,29 +178,97 @@ void PkgVulDialog::fillUI()
     ui->vulList->clear();
     for(int i=0; i<mVulVector.size(); i++ )
     {
-        QStringList strs;
-        strs<<mVulVector[i].mPkgName<<mVulVector[i].mPkgVersion<<mVulVector[i].mMessage;
-        QTreeWidgetItem* item = new QTreeWidgetItem(ui->vulList,strs);
-        item->setData(0, Qt::UserRole, QVariant(i));
-        ui->vulList->addTopLevelItem(item);
+        addItem(i);
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::showResults()
+{
+    int page = (mVulVector.size()) ? 1 : 2;
+    if (ui->mainStack->currentIndex() == page)
+        return;
+    ui->mainStack->setCurrentIndex(page);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::showError(QString details)
+{
+    QString msg = tr("The package audit could not be run.");
+    if (details.length())
+        msg += "\n\n" + details;
+    ui->errorLabel->setText(msg);
+    ui->mainStack->setCurrentWidget(ui->page_4);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+QString PkgVulDialog::cacheKey()
+{
+    QFileInfo vuln(AUDIT_DB_FILE);
+    QFileInfo local(PKG_DB_FILE);
+    if (!vuln.exists() || !local.exists())
+        return QString();
+    return QString::number(vuln.lastModified().toMSecsSinceEpoch()) + " " + QString::number(vuln.size())
+         + " " + QString::number(local.lastModified().toMSecsSinceEpoch()) + " " + QString::number(local.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool PkgVulDialog::loadCache()
+{
+    QString key = cacheKey();
+    QFile file(AUDIT_CACHE_FILE);
+    if (key.isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QTextStream in(&file);
+    in.setCodec("UTF-8");
+    if (in.readLine() != key)
+        return false;
+    mCacheOutput.clear();
+    mVulVector.clear();
+    mParser.reset();
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        mCacheOutput.append(line);
+        mParser.parseLine(line, mVulVector);
+    }
+    mParser.parseLine(QString(), mVulVector);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void PkgVulDialog::saveCache()
+{
+    QString key = cacheKey();
+    if (key.isEmpty())
+        return;
+    QDir().mkpath(QFileInfo(AUDIT_CACHE_FILE).absolutePath());
+    QFile file(AUDIT_CACHE_FILE);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return;
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out<<key<<"\n";
+    for (int i=0; i<mAuditOutput.size(); i++)
+        out<<mAuditOutput[i]<<"\n";
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void PkgVulDialog::setupDialog()
 {
     this->show();
-    beginAudit();
-    if (mVulVector.size())
+    //Show the last results right away if nothing changed since they were saved
+    mShowingCache = loadCache();
+    if (mShowingCache)
     {
         fillUI();
-        ui->mainStack->setCurrentIndex(1);
+        showResults();
+        //The database was already fetched during this session: the cached results are current
+        if (wasFetch)
+            return;
     }
-    else
-    {
-        ui->mainStack->setCurrentIndex(2);
-    }
-
+    //Audit in the background (results are shown as they are parsed)
+    beginAudit();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2,10 +2,13 @@
 #define PKGVULDIALOG_H
 
 #include <QDialog>
+#include <QProcess>
 #include <QStringList>
 #include <QVector>
 #include <QTreeWidgetItem>
 
+#include "pkgAuditParser.h"
+
 namespace Ui {
 class PkgVulDialog;
 }
@@ -15,15 +18,7 @@ class PkgVulDialog : public QDialog
     Q_OBJECT
 
 protected:
-    typedef struct _SVulInfo
-    {
-        QString mPkgGenericName;
-        QString mPkgName;
-        QString mPkgVersion;
-        QString mMessage;
-        QStringList mCVEList;
-        QString mWWW;
-    }SVulInfo;
+    typedef PkgAuditParser::SVulInfo SVulInfo;
 
 public:
     explicit PkgVulDialog(QWidget *parent = 0);
@@ -34,6 +29,10 @@ public slots:
 
 private slots:
 
+    void auditOutput();
+    void auditFinished();
+    void auditError(QProcess::ProcessError error);
+
     void on_vulList_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
 
     void on_moreInfoBtn_clicked();
@@ -43,8 +42,23 @@ private:
 
     QVector<SVulInfo> mVulVector;
 
+    QProcess* mAuditProc;
+    QByteArray mAuditBuffer;
+    QStringList mAuditOutput;   //raw audit output (saved to the cache file)
+    QStringList mCacheOutput;   //raw audit output loaded from the cache file
+    QVector<SVulInfo> mAuditVector;
+    PkgAuditParser mParser;
+    bool mShowingCache;         //results on screen come from the cache file
+
     void beginAudit();
+    void addItem(int idx);
     void fillUI();
+    void showResults();
+    void showError(QString details);
+
+    QString cacheKey();
+    bool loadCache();
+    void saveCache();
 };
 
 #endif // PKGVULDIALOG_H
@@ -0,0 +1,14 @@
+QT       += core testlib
+QT       -= gui
+CONFIG   += testcase console
+
+TARGET = tst_pkgaudit
+TEMPLATE = app
+
+INCLUDEPATH += ../..
+
+HEADERS += ../../pkgAuditParser.h
+SOURCES += tst_pkgaudit.cpp \
+	../../pkgAuditParser.cpp
+
+OTHER_FILES += pkg-audit.txt
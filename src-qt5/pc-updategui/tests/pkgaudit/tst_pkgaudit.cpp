@@ -0,0 +1,119 @@
+#include <QtTest>
+#include <QFile>
+
+#include "pkgAuditParser.h"
+
+// Feeds recorded "pkg audit" output to PkgAuditParser, the way PkgVulDialog does
+class tst_PkgAudit : public QObject
+{
+    Q_OBJECT
+
+private:
+    QStringList recorded;
+    QVector<PkgAuditParser::SVulInfo> parseAll(QStringList lines, bool finish);
+
+private slots:
+    void initTestCase();
+    void parseRecorded();
+    void entriesCompleteOnEmptyLine();
+    void missingTrailingNewline();
+    void resetDropsPartialEntry();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+QVector<PkgAuditParser::SVulInfo> tst_PkgAudit::parseAll(QStringList lines, bool finish)
+{
+    PkgAuditParser parser;
+    QVector<PkgAuditParser::SVulInfo> out;
+    for (int i = 0; i < lines.size(); i++)
+        parser.parseLine(lines[i], out);
+    if (finish)
+        parser.parseLine(QString(), out);
+    return out;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void tst_PkgAudit::initTestCase()
+{
+    QFile file(QFINDTESTDATA("pkg-audit.txt"));
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    recorded = QString::fromUtf8(file.readAll()).split("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void tst_PkgAudit::parseRecorded()
+{
+    QVector<PkgAuditParser::SVulInfo> out = parseAll(recorded, true);
+    QCOMPARE(out.size(), 3);
+
+    QCOMPARE(out[0].mPkgGenericName, QString("chromium-40.0.2214.93"));
+    QCOMPARE(out[0].mPkgName, QString("chromium"));
+    QCOMPARE(out[0].mPkgVersion, QString("40.0.2214.93"));
+    QCOMPARE(out[0].mMessage, QString("chromium -- multiple vulnerabilities"));
+    QCOMPARE(out[0].mCVEList, QStringList() << "CVE-2015-1212" << "CVE-2015-1211" << "CVE-2015-1210");
+    QCOMPARE(out[0].mWWW, QString("https://vuxml.FreeBSD.org/freebsd/a6eb239f-adbe-11e4-9fce-080027593b9a.html"));
+
+    //Multi-line description
+    QCOMPARE(out[1].mPkgName, QString("openssl"));
+    QCOMPARE(out[1].mPkgVersion, QString("1.0.1_17"));
+    QCOMPARE(out[1].mMessage, QString("OpenSSL -- multiple vulnerabilities\nMalformed ASN.1 signatures can crash the client"));
+    QCOMPARE(out[1].mCVEList.size(), 2);
+
+    //Dashes in the package name, no CVE entries
+    QCOMPARE(out[2].mPkgName, QString("py27-pip"));
+    QCOMPARE(out[2].mPkgVersion, QString("1.5.6"));
+    QVERIFY(out[2].mCVEList.isEmpty());
+    QCOMPARE(out[2].mWWW, QString("https://vuxml.FreeBSD.org/freebsd/9b8cb5e2-6d0e-11e4-9a3b-0022156e8794.html"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void tst_PkgAudit::entriesCompleteOnEmptyLine()
+{
+    //parseLine() reports each entry as soon as it is complete (used to fill the list while pkg runs)
+    PkgAuditParser parser;
+    QVector<PkgAuditParser::SVulInfo> out;
+    QList<int> completedAt;
+    for (int i = 0; i < recorded.size(); i++)
+    {
+        if (parser.parseLine(recorded[i], out))
+            completedAt << i;
+    }
+    QCOMPARE(completedAt, QList<int>() << 6 << 13 << 17);
+    QCOMPARE(out.size(), 3);
+    //The summary line and the final empty line do not make an entry
+    QVERIFY(!parser.parseLine(QString(), out));
+    QCOMPARE(out.size(), 3);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void tst_PkgAudit::missingTrailingNewline()
+{
+    //Output cut after the last WWW line - the empty line sent at the end completes it
+    QStringList lines = recorded.mid(0, 6);
+    QCOMPARE(parseAll(lines, false).size(), 0);
+    QVector<PkgAuditParser::SVulInfo> out = parseAll(lines, true);
+    QCOMPARE(out.size(), 1);
+    QCOMPARE(out[0].mPkgName, QString("chromium"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void tst_PkgAudit::resetDropsPartialEntry()
+{
+    PkgAuditParser parser;
+    QVector<PkgAuditParser::SVulInfo> out;
+    parser.parseLine(recorded[0], out);
+    parser.parseLine(recorded[1], out);
+    parser.reset();
+    QVERIFY(!parser.parseLine(QString(), out));
+    QVERIFY(out.isEmpty());
+    //Description lines are only collected after a package line
+    parser.parseLine("left over text", out);
+    parser.parseLine(recorded[7], out);
+    parser.parseLine(QString(), out);
+    QCOMPARE(out.size(), 1);
+    QCOMPARE(out[0].mPkgName, QString("openssl"));
+    QVERIFY(out[0].mMessage.isEmpty());
+}
+
+QTEST_MAIN(tst_PkgAudit)
+#include "tst_pkgaudit.moc"
@@ -0,0 +1,4 @@
+# Unit tests for pc-updategui (run with "qmake && make check")
+TEMPLATE = subdirs
+
+SUBDIRS += pkgaudit
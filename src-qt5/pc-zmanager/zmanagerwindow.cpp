@@ -95,15 +95,17 @@ void ZManagerWindow::GetCurrentTopology()
     QStringList m=pcbsd::Utils::runShellCommand("mount");
     QStringList ps=pcbsd::Utils::runShellCommand("sh -c \"ps -A -w -w | grep 'ntfs\\|ext4'\"");
     QStringList prop;   // GET PROPERTIES FOR ALL POOLS ONCE WE HAVE A LIST OF POOLS
-    QStringList zfsl=pcbsd::Utils::runShellCommand("zfs list -H -t all");
-    QStringList zfspr=pcbsd::Utils::runShellCommand("zfs get -H all");
+    // ALL DATASETS AND SNAPSHOTS, WITH ONLY THE PROPERTIES NEEDED FOR THE LIST
+    QStringList zfsl=pcbsd::Utils::runShellCommand("zfs list -H -t all -o name," FS_LIST_PROPERTIES);
 
 
     // CLEAR ALL EXISTING TOPOLOGY
+    QList<zfs_t> oldFileSystems=this->FileSystems;
     this->Pools.clear();
     this->Disks.clear();
     this->Errors.clear();
     this->FileSystems.clear();
+    this->FileSystemIndex.clear();
 
     QStringList::const_iterator idx;
     int state;
@@ -1401,41 +1403,75 @@ while(pit!=prop.constEnd())
 
 // BEGIN PROCESSING FILESYSTEMS
 
+QHash<QString,int> oldIndex;
 
+for(int k=0;k<oldFileSystems.count();++k) oldIndex.insert(oldFileSystems.at(k).FullPath,k);
+
+QStringList listprops=QString(FS_LIST_PROPERTIES).split(",");
 QStringList::const_iterator fsit=zfsl.constBegin();
 
 while(fsit!=zfsl.constEnd())
 {
+    QStringList line=(*fsit).split("\t");
 
-    QString tmpline=(*fsit);
-
-    QStringList line=tmpline.split("\t",QString::SkipEmptyParts);
-
-    if(line.count()>=4) {
+    if(line.count()==listprops.count()+1) {
      zfs_t tmp;
      tmp.FullPath=line[0];
-     tmp.Properties.clear();
+     tmp.ListLine=(*fsit);
+     tmp.PropsLoaded=false;
+
+     // KEEP ALL PROPERTIES ALREADY LOADED IF THE LISTED ONES DIDN'T CHANGE
+     QHash<QString,int>::const_iterator old=oldIndex.constFind(tmp.FullPath);
+     if(old!=oldIndex.constEnd() && oldFileSystems.at(old.value()).PropsLoaded && oldFileSystems.at(old.value()).ListLine==tmp.ListLine) {
+         tmp=oldFileSystems.at(old.value());
+     }
+     else {
+         for(int k=0;k<listprops.count();++k) {
+             zprop_t proptmp;
+             proptmp.Name=listprops[k];
+             proptmp.Value=line[k+1];
+             if(proptmp.Value=="-") proptmp.Value.clear();
+             proptmp.From="-";
+             proptmp.Source=ZFS_SRCNONE;
+             tmp.Properties.append(proptmp);
+         }
+     }
      FileSystems.append(tmp);
     }
 
     ++fsit;
 }
 
+for(int k=0;k<FileSystems.count();++k) FileSystemIndex.insert(FileSystems.at(k).FullPath,k);
 
-// GET ALL PROPERTIES FOR FILESYSTEMS
+// FORGET CACHED PROPERTIES OF DATASETS THAT WERE LISTED AGAIN OR ARE GONE
+for(int k=0;k<PropsCache.count();++k) {
+    zfs_t *fs=getFileSystembyPath(PropsCache.at(k));
+    if(!fs || !fs->PropsLoaded) { PropsCache.removeAt(k); --k; }
+}
 
+}
 
-QStringList::const_iterator fspr=zfspr.constBegin();
 
-while(fspr!=zfspr.constEnd())
+// READ ALL PROPERTIES OF A SINGLE DATASET (ONLY WHEN NEEDED)
+
+void ZManagerWindow::loadFileSystemProperties(zfs_t *fs)
 {
+    if(fs==NULL) return;
+
+    QStringList zfspr=pcbsd::Utils::runShellCommand("zfs get -H all \""+fs->FullPath+"\"");
+
+    fs->Properties.clear();
+
+    QStringList::const_iterator fspr=zfspr.constBegin();
 
-    QStringList line=(*fspr).split("\t",QString::SkipEmptyParts);
+    while(fspr!=zfspr.constEnd())
+    {
+
+        QStringList line=(*fspr).split("\t",QString::SkipEmptyParts);
 
-    if(line.count()>=4) {
-     zprop_t tmp;
-     zfs_t *zptr=getFileSystembyPath(line[0]);
-     if(zptr) {
+        if(line.count()>=4 && line[0]==fs->FullPath) {
+         zprop_t tmp;
 
          tmp.Name=line[1];
          tmp.Value=line[2];
@@ -1446,15 +1482,48 @@ while(fspr!=zfspr.constEnd())
          if(tmp.From=="local")  tmp.Source=ZFS_SRCLOCAL;
          if(tmp.From.startsWith("inherited")) tmp.Source=ZFS_SRCINHERIT;
 
-         zptr->Properties.append(tmp);
+         fs->Properties.append(tmp);
+        }
+
+        ++fspr;
     }
+
+    fs->PropsLoaded=true;
+
+    // KEEP ONLY THE MOST RECENTLY USED DATASETS FULLY LOADED
+    PropsCache.removeAll(fs->FullPath);
+    PropsCache.append(fs->FullPath);
+
+    while(PropsCache.count()>FS_PROPS_CACHE) {
+        zfs_t *old=getFileSystembyPath(PropsCache.takeFirst());
+        if(old && old!=fs) unloadFileSystemProperties(old);
     }
 
-    ++fspr;
 }
 
+// DROP ALL PROPERTIES EXCEPT THE ONES NEEDED FOR THE LIST
+
+void ZManagerWindow::unloadFileSystemProperties(zfs_t *fs)
+{
+    if(fs==NULL) return;
 
+    QStringList listprops=QString(FS_LIST_PROPERTIES).split(",");
 
+    for(int k=0;k<fs->Properties.count();++k) {
+        if(!listprops.contains(fs->Properties.at(k).Name)) { fs->Properties.removeAt(k); --k; }
+    }
+
+    fs->PropsLoaded=false;
+}
+
+// DROP THE FULL PROPERTIES OF ALL DATASETS IN A POOL (ALL POOLS IF EMPTY)
+
+void ZManagerWindow::forgetFileSystemProperties(QString pool)
+{
+    for(int k=0;k<FileSystems.count();++k) {
+        QString poolname=FileSystems.at(k).FullPath.section('/',0,0).section('@',0,0);
+        if(FileSystems.at(k).PropsLoaded && (pool.isEmpty() || poolname==pool)) unloadFileSystemProperties(&FileSystems[k]);
+    }
 }
 
 void ZManagerWindow::refreshState()
@@ -1851,7 +1920,11 @@ void ZManagerWindow::zpoolContextMenu(QPoint p)
     needRefresh=false;
     m.exec(ui->zpoolList->viewport()->mapToGlobal(p));
 
-    if(needRefresh) refreshState();
+    if(needRefresh) {
+        // POOL OPERATIONS CAN AFFECT ANY POOL, READ ALL PROPERTIES AGAIN
+        forgetFileSystemProperties(QString());
+        refreshState();
+    }
 }
 
 void ZManagerWindow::deviceContextMenu(QPoint p)
@@ -3133,15 +3206,9 @@ zfs_t *ZManagerWindow::getFileSystembyPath(QString path, int index)
 
     if(index>=0) return (zfs_t *)&(this->FileSystems.at(index));
 
-    QList<zfs_t>::const_iterator it=this->FileSystems.constBegin();
+    QHash<QString,int>::const_iterator it=FileSystemIndex.constFind(path);
 
-    while(it!=this->FileSystems.constEnd())
-    {
-        if((*it).FullPath==path) {
-            return (zfs_t *)&(*it);
-        }
-        ++it;
-    }
+    if(it!=FileSystemIndex.constEnd()) return &(this->FileSystems[it.value()]);
 
     return NULL;
 
@@ -3229,7 +3296,7 @@ void ZManagerWindow::on_fspoolList_currentItemChanged(QTreeWidgetItem *current,
 
         prop=getFileSystemProperty((zfs_t *)&(*it),"available");
 
-        if(prop) state+=tr(" of ")+prop->Value;
+        if(prop && !prop->Value.isEmpty()) state+=tr(" of ")+prop->Value;   // SNAPSHOTS HAVE NO AVAILABLE SPACE
 
 
         item->setText(1,state);
@@ -3283,6 +3350,12 @@ zprop_t *ZManagerWindow::getFileSystemProperty(zfs_t *fs,QString prop)
         ++it;
     }
 
+    if(!fs->PropsLoaded) {
+        // NOT ONE OF THE LIST PROPERTIES, READ THEM ALL AND TRY AGAIN
+        loadFileSystemProperties(fs);
+        return getFileSystemProperty(fs,prop);
+    }
+
     return NULL;
 }
 
@@ -3349,6 +3422,7 @@ void ZManagerWindow::filesystemContextMenu(QPoint p)
     if(needRefresh) {
         // REFRESH STATE BUT KEEP THE CURRENT POOL SELECTED
         QString currentPool=ui->fspoolList->currentItem()->text(0);
+        forgetFileSystemProperties(currentPool);
         refreshState();
 
         QTreeWidgetItemIterator it(ui->fspoolList);
@@ -3692,6 +3766,9 @@ void ZManagerWindow::fsEditProps(bool)
 {
     DialogFSProp dlg;
 
+    // ALWAYS EDIT THE CURRENT VALUES, THEY MAY HAVE BEEN CHANGED OUTSIDE OF THIS PROGRAM
+    loadFileSystemProperties(lastSelectedFileSystem);
+
     dlg.setDataset(lastSelectedFileSystem);
 
     int result=dlg.exec();
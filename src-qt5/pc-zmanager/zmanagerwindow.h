@@ -5,6 +5,7 @@
 #include <QModelIndex>
 #include <QTreeWidgetItem>
 #include <QHeaderView>
+#include <QHash>
 
 namespace Ui {
 class ZManagerWindow;
@@ -68,9 +69,16 @@ typedef struct {
 
 typedef struct {
     QString FullPath;
+    QString ListLine;           // zfs list LINE OF THE LAST REFRESH
     QList<zprop_t> Properties;
+    bool PropsLoaded;           // ALL PROPERTIES READ (OTHERWISE ONLY THE ONES NEEDED FOR THE LIST)
 } zfs_t;
 
+// PROPERTIES READ FOR EVERY DATASET ON REFRESH, ALL OTHERS ARE READ ON DEMAND
+#define FS_LIST_PROPERTIES "type,origin,mounted,mountpoint,used,available"
+// MAXIMUM NUMBER OF DATASETS THAT KEEP ALL THEIR PROPERTIES IN MEMORY
+#define FS_PROPS_CACHE 64
+
 
 #define PROP_READONLY 1
 #define PROP_ISNUMBER 2
@@ -160,6 +168,8 @@ public:
 
     bool needRefresh;
 
+    QHash<QString,int> FileSystemIndex;     // FULL PATH -> INDEX IN FileSystems
+    QStringList PropsCache;                 // DATASETS WITH ALL PROPERTIES LOADED, OLDEST FIRST
 
 
     const QString getStatusString(int status);
@@ -171,6 +181,9 @@ public:
     zfs_t *getFileSystembyPath(QString path, int index=-1);
     QTreeWidgetItem *getParentFileSystem(QString path);
     zprop_t *getFileSystemProperty(zfs_t *fs,QString prop);
+    void loadFileSystemProperties(zfs_t *fs);
+    void unloadFileSystemProperties(zfs_t *fs);
+    void forgetFileSystemProperties(QString pool);
     int  getFileSystemFlags(zfs_t *fs);
 
     vdev_t *getVDevbyName(QString name);
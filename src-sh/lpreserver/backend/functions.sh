@@ -32,9 +32,10 @@ REPCONF="${DBDIR}/replication"
 LOGDIR="/var/log/lpreserver"
 REPLOGSEND="${LOGDIR}/lastrep-send-log"
 REPLOGRECV="${LOGDIR}/lastrep-recv-log"
+REPLOGPROG="${LOGDIR}/lastrep-progress"
 MSGQUEUE="${DBDIR}/.lpreserver.msg.$$"
 SSHPROPS="-o StrictHostKeyChecking=no"
-export DBDIR LOGDIR PROGDIR CMDLOG REPCONF REPLOGSEND REPLOGRECV MSGQUEUE SSHPROPS
+export DBDIR LOGDIR PROGDIR CMDLOG REPCONF REPLOGSEND REPLOGRECV REPLOGPROG MSGQUEUE SSHPROPS
 # Create the logdir
 if [ ! -d "$LOGDIR" ] ; then 
    mkdir -p ${LOGDIR}
@@ -657,6 +658,9 @@ check_rep_task() {
   # Save this PID
   echo "$$" > ${pidFile}
 
+  # Start with an empty progress file for this task
+  : > ${REPLOGPROG}
+
   # Is this a sync-task we do at the time of a snapshot?
   if [ "$2" = "sync" -a "$REPTIME" = "sync" ] ; then
      export DIDREP=1
@@ -1400,15 +1404,45 @@ start_rep_task() {
   return $zStatus
 }
 
+# Filter for the "zfs send -v -P" output: copies it to stdout and adds
+# progress records to ${REPLOGPROG} (one per line, sizes in bytes, rates in bytes/sec):
+#   PROGRESS <unix time> <snapshot> <sent> <total> <current rate> <average rate>
+#   DONE <unix time> <snapshot> <sent> <total> 0 <average rate>
+# Can be tried out with a fake stream: printf 'size\t100\n10:00:00\t50\tp@s\n' | rep_progress_filter p@s
+rep_progress_filter() {
+  awk -v snap="$1" -v plog="${REPLOGPROG}" '
+    function now() { srand(); return srand() }
+    BEGIN { total = 0; done = 0; cur = 0; sent = 0; rate = 0; start = now(); lastt = start; lastb = 0 }
+    {
+      print ; fflush()
+      if ( $1 == "size" && $2 ~ /^[0-9]+$/ ) { total = $2 ; next }
+      if ( $1 ~ /^[0-9]+:[0-9][0-9]:[0-9][0-9]$/ && $2 ~ /^[0-9]+$/ ) {
+        # The byte count starts over for each snapshot of an incremental (-I) stream
+        if ( NF >= 3 && $3 != snap ) { done += cur ; cur = 0 ; snap = $3 }
+        cur = $2 ; sent = done + cur
+        t = now()
+        if ( t > lastt ) { rate = int((sent - lastb) / (t - lastt)) ; lastt = t ; lastb = sent }
+        avg = ( t > start ) ? int(sent / (t - start)) : 0
+        printf("PROGRESS %d %s %.0f %.0f %d %d\n", t, snap, sent, total, rate, avg) >> plog
+        fflush(plog)
+      }
+    }
+    END {
+      t = now()
+      avg = ( t > start ) ? int(sent / (t - start)) : 0
+      printf("DONE %d %s %.0f %.0f 0 %d\n", t, snap, sent, total, avg) >> plog
+    }'
+}
+
 do_zfs_send_now() {
 
     # Do the send/recv now
-    zSEND="zfs send ${1}"
+    zSEND="zfs send -P ${1}"
     zRCV="${CMDPREFIX} zfs receive $2"
     queue_msg "Using ZFS send command:\n$zSEND | $zRCV\n\n"
 
-    # Start up our process
-    $zSEND 2>${REPLOGSEND} | $zRCV >${REPLOGRECV} 2>${REPLOGRECV}
+    # Start up our process (the send log goes through the progress filter)
+    { $zSEND 2>&1 1>&3 3>&- | rep_progress_filter "${dset}@${3}" 3>&- >${REPLOGSEND} ; } 3>&1 | $zRCV >${REPLOGRECV} 2>${REPLOGRECV}
     local rtnCode=$?
 
     queue_msg "ZFS SEND LOG:\n--------------\n" "${REPLOGSEND}"
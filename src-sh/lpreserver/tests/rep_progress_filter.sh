@@ -0,0 +1,59 @@
+#!/bin/sh
+# Replays recorded "zfs send -v -P" output (zfs-send-P.txt, an incremental
+# stream of two snapshots) through rep_progress_filter from functions.sh
+# and checks the records it writes for lp-tray.
+# Usage: sh tests/rep_progress_filter.sh
+
+TESTDIR=`cd \`dirname $0\` && pwd`
+FUNCS="${TESTDIR}/../backend/functions.sh"
+SNAP="tank/home@auto-2015-03-03-00-00-00"
+
+# functions.sh can not be sourced outside of a real install, only load the filter
+eval "`sed -n '/^rep_progress_filter() {/,/^}/p' ${FUNCS}`"
+if ! type rep_progress_filter >/dev/null 2>&1 ; then
+  echo "FAIL: rep_progress_filter not found in ${FUNCS}"
+  exit 1
+fi
+
+WORKDIR=`mktemp -d /tmp/lp-reptest.XXXXXX`
+trap "rm -rf ${WORKDIR}" 0
+REPLOGPROG="${WORKDIR}/lastrep-progress"
+FAILED=0
+
+fail() {
+  echo "FAIL: $1"
+  FAILED=1
+}
+
+rep_progress_filter "${SNAP}" < ${TESTDIR}/zfs-send-P.txt > ${WORKDIR}/send-log
+
+# The send log is passed through untouched
+cmp -s ${TESTDIR}/zfs-send-P.txt ${WORKDIR}/send-log || fail "send log differs from the zfs send output"
+
+# One record per progress line plus the final one
+[ `wc -l < ${REPLOGPROG}` -eq 5 ] || fail "expected 5 records, got `wc -l < ${REPLOGPROG}`"
+
+# Type, snapshot, sent and total (time and rates depend on the clock)
+awk '{ print $1, $3, $4, $5 }' ${REPLOGPROG} > ${WORKDIR}/records
+cat > ${WORKDIR}/expected << __EOF__
+PROGRESS tank/home@auto-2015-03-02-00-00-00 524288 3145728
+PROGRESS tank/home@auto-2015-03-02-00-00-00 1048576 3145728
+PROGRESS tank/home@auto-2015-03-03-00-00-00 1310720 3145728
+PROGRESS tank/home@auto-2015-03-03-00-00-00 3145728 3145728
+DONE tank/home@auto-2015-03-03-00-00-00 3145728 3145728
+__EOF__
+cmp -s ${WORKDIR}/expected ${WORKDIR}/records || { fail "unexpected records:" ; diff ${WORKDIR}/expected ${WORKDIR}/records ; }
+
+# Every record has 7 numeric-looking fields
+awk 'NF != 7 || $2 !~ /^[0-9]+$/ || $6 !~ /^[0-9]+$/ || $7 !~ /^[0-9]+$/ { bad++ } END { exit bad }' ${REPLOGPROG} || fail "malformed record"
+
+# No progress lines at all (zfs send failed right away): only the DONE record
+REPLOGPROG="${WORKDIR}/lastrep-progress-empty"
+echo "cannot open 'tank/home@missing': dataset does not exist" | rep_progress_filter "${SNAP}" > /dev/null
+[ "`awk '{ print $1, $3, $4, $5 }' ${REPLOGPROG}`" = "DONE ${SNAP} 0 0" ] || fail "unexpected record for a failed send: `cat ${REPLOGPROG}`"
+
+if [ $FAILED -ne 0 ] ; then
+  exit 1
+fi
+echo "rep_progress_filter: OK"
+exit 0
@@ -53,6 +53,7 @@ start_extract_dist()
   for di in $INSFILE
   do
       # Check the MANIFEST see if we have an archive size / count
+      count=""
       if [ -e "${DDIR}/MANIFEST" ]; then 
          count=`grep "^${di}.txz" ${DDIR}/MANIFEST | awk '{print $3}'`
 	 if [ ! -z "$count" ] ; then
@@ -60,7 +61,7 @@ start_extract_dist()
 	 fi
       fi
       echo_log "pc-sysinstall: Starting Extraction (${di})"
-      tar -xp -C ${FSMNT} ${TAROPTS} -f ${DDIR}/${di}.txz 2>&1 | tee -a ${FSMNT}/.tar-extract.log
+      tar -xp -C ${FSMNT} ${TAROPTS} -f ${DDIR}/${di}.txz 2>&1 | tee -a ${FSMNT}/.tar-extract.log | progress_count_filter "extract" "${count}"
       if [ $? -ne 0 ]; then
         cd /
         echo "TAR failure occurred:" >>${LOGOUT}
@@ -86,8 +87,10 @@ start_extract_uzip_tar()
   fi
 
   # Check if we have a .count file, and echo it out for a front-end to use in progress bars
+  count=""
   if [ -e "${INSFILE}.count" ]; then
-    echo "INSTALLCOUNT: `cat ${INSFILE}.count`"
+    count="`cat ${INSFILE}.count`"
+    echo "INSTALLCOUNT: ${count}"
   fi
 
   # Check if we are doing an upgrade, and if so use our exclude list
@@ -121,7 +124,7 @@ start_extract_uzip_tar()
       cd ${FSMNT}.uzip
 
       # Copy over all the files now!
-      tar cvf - . 2>/dev/null | tar -xp -C ${FSMNT} ${TAROPTS} -f - 2>&1 | tee -a ${FSMNT}/.tar-extract.log
+      tar cvf - . 2>/dev/null | tar -xp -C ${FSMNT} ${TAROPTS} -f - 2>&1 | tee -a ${FSMNT}/.tar-extract.log | progress_count_filter "extract" "${count}"
       if [ $? -ne 0 ]
       then
         cd /
@@ -138,10 +141,13 @@ start_extract_uzip_tar()
       mdconfig -d -u ${MDDEVICE}
        ;;
     tar)
-      tar -xpv -C ${FSMNT} -f ${INSFILE} ${TAROPTS} >&1 2>&1
-      if [ $? -ne 0 ]; then
+      # Keep the exit status of tar, not of the progress filter
+      ( tar -xpv -C ${FSMNT} -f ${INSFILE} ${TAROPTS} 2>&1 ; echo "$?" > ${TMPDIR}/.tarExit ) | progress_count_filter "extract" "${count}"
+      if [ "`cat ${TMPDIR}/.tarExit`" != "0" ]; then
+        rm ${TMPDIR}/.tarExit
         exit_err "ERROR: Failed extracting the tar image"
       fi
+      rm ${TMPDIR}/.tarExit
       ;;
     livecd)
      # GhostBSD specific (prepare a ro layer to copy from)
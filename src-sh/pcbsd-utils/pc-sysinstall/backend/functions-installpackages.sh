@@ -71,10 +71,14 @@ install_packages()
   # Lets start by cleaning up the string and getting it ready to parse
   get_value_from_cfg_with_spaces installPackages
   PACKAGES="${VAL}"
-  echo_log "Packages to install: `echo $PACKAGES | wc -w | awk '{print $1}'`"
+  PKGTOTAL=`echo $PACKAGES | wc -w | awk '{print $1}'`
+  PKGDONE=0
+  echo_log "Packages to install: ${PKGTOTAL}"
   for i in $PACKAGES
   do
     PKGNAME="${i}"
+    echo_progress "packages" "${PKGDONE}" "${PKGTOTAL}" "items" "${PKGNAME}"
+    PKGDONE=$(expr $PKGDONE + 1)
 
     # When doing a pkg install, if on local media, use a pkg.conf from /dist/
     if [ "${INSTALLMEDIUM}" != "ftp" ] ; then
@@ -115,6 +119,7 @@ install_packages()
     fi
   done
 
+  echo_progress "packages" "${PKGTOTAL}" "${PKGTOTAL}" "items"
   echo_log "Package installation complete!"
 
   # Cleanup after ourselves
@@ -132,9 +132,10 @@ restore_zfs_from_remote()
   sleep 5
    
   # Lets start pulling our ZFS replication
-  zSEND="ssh -p $SSHPORT ${SSHKEY} ${SSHUSER}@${SSHHOST} zfs send -Rv ${ZFSDATASET}@${lastSNAP}"
+  zSEND="ssh -p $SSHPORT ${SSHKEY} ${SSHUSER}@${SSHHOST} zfs send -RvP ${ZFSDATASET}@${lastSNAP}"
   zRECV="zfs receive -evuF ${ZPOOLNAME}"
-  $zSEND | $zRECV >/dev/null 2>/dev/null
+  # The stream goes to zfs receive, the -vP status lines through the progress filter to our stdout (fd 4)
+  { { $zSEND 2>&1 1>&3 3>&- 4>&- | zfs_progress_filter "restore" 1>&4 3>&- 4>&- ; } 3>&1 | $zRECV >/dev/null 2>/dev/null 4>&- ; } 4>&1
   if [ $? -ne 0 ] ; then
      exit_err "Failed ZFS send / receive"
   fi
@@ -385,9 +386,10 @@ restore_zfs_from_local()
   sleep 5
    
   # Lets start pulling our ZFS replication
-  zSEND="zfs send -Rv ${ZFSDATASET}@${lastSNAP}"
+  zSEND="zfs send -RvP ${ZFSDATASET}@${lastSNAP}"
   zRECV="zfs receive -evuF ${ZPOOLNAME}"
-  $zSEND | $zRECV >/dev/null 2>/dev/null
+  # The stream goes to zfs receive, the -vP status lines through the progress filter to our stdout (fd 4)
+  { { $zSEND 2>&1 1>&3 3>&- 4>&- | zfs_progress_filter "restore" 1>&4 3>&- 4>&- ; } 3>&1 | $zRECV >/dev/null 2>/dev/null 4>&- ; } 4>&1
   if [ $? -ne 0 ] ; then
      exit_err "Failed ZFS send / receive"
   fi
@@ -201,6 +201,62 @@ echo_log()
   echo "${STR}" | tee -a ${LOGOUT} 
 };
 
+# Progress records for front-ends, one per line:
+#   PROGRESS: phase=<name> done=<n> total=<n> unit=<bytes|items> time=<unix time> [msg=<text>]
+# total is 0 if unknown, msg (optional) runs until the end of the line
+# Phases: fetch, extract, restore, packages
+
+# Echo a single progress record
+# Usage: echo_progress <phase> <done> <total> <unit> [msg]
+echo_progress()
+{
+  local _msg=""
+  if [ -n "$5" ] ; then _msg=" msg=$5" ; fi
+  echo "PROGRESS: phase=${1} done=${2:-0} total=${3:-0} unit=${4} time=`date +%s`${_msg}"
+};
+
+# Pass the verbose output of tar/rsync through, adding a progress record
+# (at most once a second) with the number of lines/files done so far
+# Usage: <command> | progress_count_filter <phase> [total]
+progress_count_filter()
+{
+  # srand() returns the previous seed, so srand(); srand() gives the current time without a fork
+  awk -v phase="${1}" -v total="${2:-0}" '
+    function now() { srand(); return srand() }
+    function record(t) {
+      printf "PROGRESS: phase=%s done=%d total=%d unit=items time=%d\n", phase, done, total, t
+      fflush()
+    }
+    {
+      print ; fflush()
+      done++
+      t = now()
+      if ( t != last ) { last = t ; record(t) }
+    }
+    END { record(now()) }'
+};
+
+# Turn the stderr of "zfs send -vP" into progress records (bytes, every line is passed through)
+# With -R the per-second counts start over for each snapshot, so they are added up here
+# Usage: { zfs send -RvP ... 2>&1 1>&3 3>&- | zfs_progress_filter <phase> 1>&4 3>&- ; } 3>&1 | zfs receive ...  (fd 4 = our stdout)
+zfs_progress_filter()
+{
+  awk -v phase="${1}" '
+    function now() { srand(); return srand() }
+    function record(t) {
+      printf "PROGRESS: phase=%s done=%.0f total=%.0f unit=bytes time=%d%s\n", phase, base + last, total, t, (cur != "" ? " msg=" cur : "")
+      fflush()
+    }
+    { print ; fflush() }
+    $1 == "size" { total = $2 ; record(now()) ; next }
+    $1 ~ /^[0-9]+:[0-9][0-9]:[0-9][0-9]$/ {
+      if ( $3 != cur ) { base += last ; last = 0 ; cur = $3 }
+      last = $2
+      record(now())
+    }
+    END { record(now()) }'
+};
+
 # Make sure we have a numeric
 is_num()
 {
@@ -219,7 +275,7 @@ fetch_file()
   EXITFILE="${TMPDIR}/.fetchExit"
 
   rm ${FETCHOUTFILE} 2>/dev/null >/dev/null
-  FSIZE=$(`fetch -s "${FETCHFILE}"`)
+  FSIZE=`fetch -s "${FETCHFILE}"`
   is_num "$FSIZE"
   if [ $? -eq 0 ] ; then
     SIZE=$(expr $FSIZE / 1024 )
@@ -242,6 +298,7 @@ fetch_file()
       if [ $SIZE -lt $DSIZE ] ; then DSIZE="$SIZE"; fi 
     	echo "SIZE: ${SIZE} DOWNLOADED: ${DSIZE}"
     	echo "SIZE: ${SIZE} DOWNLOADED: ${DSIZE}" >>${LOGOUT}
+    	echo_progress "fetch" "$(expr $DSIZE \* 1024)" "$FSIZE" "bytes" "`basename ${FETCHFILE}`"
       fi
     fi
 
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Dry-run of the progress helpers from backend/functions.sh (echo_progress,
+# progress_count_filter and zfs_progress_filter) against recorded tar and
+# "zfs send -RvP" output. Runs anywhere with a POSIX sh and awk.
+# Usage: sh tests/progress_filters.sh
+
+TESTDIR=`cd \`dirname $0\` && pwd`
+FUNCS="${TESTDIR}/../backend/functions.sh"
+
+# functions.sh needs a real install environment, only load the helpers
+for f in echo_progress progress_count_filter zfs_progress_filter
+do
+  eval "`sed -n \"/^${f}()/,/^};/p\" ${FUNCS}`"
+  if ! type ${f} >/dev/null 2>&1 ; then
+    echo "FAIL: ${f} not found in ${FUNCS}"
+    exit 1
+  fi
+done
+
+WORKDIR=`mktemp -d /tmp/pcsys-progtest.XXXXXX`
+trap "rm -rf ${WORKDIR}" 0
+FAILED=0
+
+fail() {
+  echo "FAIL: $1"
+  FAILED=1
+}
+
+# Strip the time= field (depends on the clock) from the records
+records() {
+  grep '^PROGRESS: ' $1 | sed 's| time=[0-9]*||'
+}
+
+# echo_progress: a single record, with and without a message
+echo_progress "fetch" "1048576" "4194304" "bytes" "base.txz" > ${WORKDIR}/echo
+echo_progress "packages" "3" "" "items" >> ${WORKDIR}/echo
+grep -q '^PROGRESS: phase=fetch done=1048576 total=4194304 unit=bytes time=[0-9][0-9]* msg=base.txz$' ${WORKDIR}/echo || fail "echo_progress with message: `sed -n 1p ${WORKDIR}/echo`"
+grep -q '^PROGRESS: phase=packages done=3 total=0 unit=items time=[0-9][0-9]*$' ${WORKDIR}/echo || fail "echo_progress without message: `sed -n 2p ${WORKDIR}/echo`"
+
+# progress_count_filter: tar output passes through, the last record has the full count
+progress_count_filter "extract" 6 < ${TESTDIR}/tar-v.txt > ${WORKDIR}/count
+grep -v '^PROGRESS: ' ${WORKDIR}/count | cmp -s - ${TESTDIR}/tar-v.txt || fail "progress_count_filter changed the tar output"
+[ "`records ${WORKDIR}/count | tail -1`" = "PROGRESS: phase=extract done=6 total=6 unit=items" ] || fail "progress_count_filter last record: `records ${WORKDIR}/count | tail -1`"
+[ "`records ${WORKDIR}/count | head -1`" = "PROGRESS: phase=extract done=1 total=6 unit=items" ] || fail "progress_count_filter first record: `records ${WORKDIR}/count | head -1`"
+# At most one record a second, plus the final one
+[ `records ${WORKDIR}/count | wc -l` -le 3 ] || fail "progress_count_filter wrote a record for every line"
+# Unknown total
+echo "x ./COPYRIGHT" | progress_count_filter "extract" > ${WORKDIR}/count
+[ "`records ${WORKDIR}/count | tail -1`" = "PROGRESS: phase=extract done=1 total=0 unit=items" ] || fail "progress_count_filter without total: `records ${WORKDIR}/count | tail -1`"
+
+# zfs_progress_filter: the per-snapshot byte counts of a -R stream add up
+zfs_progress_filter "restore" < ${TESTDIR}/zfs-send-RvP.txt > ${WORKDIR}/zfs
+grep -v '^PROGRESS: ' ${WORKDIR}/zfs | cmp -s - ${TESTDIR}/zfs-send-RvP.txt || fail "zfs_progress_filter changed the zfs send output"
+records ${WORKDIR}/zfs > ${WORKDIR}/zfs-records
+cat > ${WORKDIR}/expected << __EOF__
+PROGRESS: phase=restore done=0 total=20971520 unit=bytes
+PROGRESS: phase=restore done=4194304 total=20971520 unit=bytes msg=tank/ROOT/default@install
+PROGRESS: phase=restore done=10485760 total=20971520 unit=bytes msg=tank/ROOT/default@install
+PROGRESS: phase=restore done=12582912 total=20971520 unit=bytes msg=tank/usr@install
+PROGRESS: phase=restore done=20971520 total=20971520 unit=bytes msg=tank/usr@install
+PROGRESS: phase=restore done=20971520 total=20971520 unit=bytes msg=tank/usr@install
+__EOF__
+cmp -s ${WORKDIR}/expected ${WORKDIR}/zfs-records || { fail "zfs_progress_filter records:" ; diff ${WORKDIR}/expected ${WORKDIR}/zfs-records ; }
+
+if [ $FAILED -ne 0 ] ; then
+  exit 1
+fi
+echo "progress filters: OK"
+exit 0